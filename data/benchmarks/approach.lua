@@ -0,0 +1,41 @@
+-- Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+-- Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+-- Benchmark scenario: ships descending from orbit to the surface starports
+-- of the player's planet, exercising atmosphere, terrain collision and,
+-- through the camera, terrain detail.
+
+local Engine = import("Engine")
+local Game = import("Game")
+local Space = import("Space")
+local ShipDef = import("ShipDef")
+local SystemPath = import("SystemPath")
+local Equipment = import("Equipment")
+local utils = import("utils")
+
+return {
+	start = SystemPath.New(0,0,0,0,6),
+	time = 48600,
+	count = 20,
+
+	setup = function (count)
+		local parent = Game.player:GetDockedWith().path:GetSystemBody().parent
+		local planet = Space.GetBody(parent.index)
+		local radius = parent.radius / 1000 -- in km, like SpawnShipNear
+
+		local ports = Space.GetBodies(function (body)
+			return body.type == "STARPORT_SURFACE" and body.path:GetSystemBody().parent.index == parent.index
+		end)
+		local shipdefs = utils.build_array(utils.filter(function (k,def)
+			return def.tag == 'SHIP' and def.hyperdriveClass > 0 and def.equipSlotCapacity.atmo_shield > 0
+		end, pairs(ShipDef)))
+
+		for i = 1,count do
+			local def = shipdefs[Engine.rand:Integer(1,#shipdefs)]
+			local ship = Space.SpawnShipNear(def.id, planet, radius * 1.2, radius * 1.5)
+			ship:AddEquip(Equipment.misc.atmospheric_shielding)
+			ship:AddEquip(Equipment.misc.autopilot)
+			ship:AIDockWith(ports[Engine.rand:Integer(1,#ports)])
+		end
+	end,
+}
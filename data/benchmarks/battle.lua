@@ -0,0 +1,50 @@
+-- Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+-- Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+-- Benchmark scenario: two groups of armed ships fighting it out in open
+-- space, away from the player, exercising combat AI, projectiles and
+-- ship to ship collisions.
+
+local Engine = import("Engine")
+local Game = import("Game")
+local Space = import("Space")
+local ShipDef = import("ShipDef")
+local SystemPath = import("SystemPath")
+local Equipment = import("Equipment")
+local utils = import("utils")
+
+return {
+	start = SystemPath.New(0,0,0,0,6),
+	time = 48600,
+	count = 20,
+
+	setup = function (count)
+		local shipdefs = utils.build_array(utils.filter(function (k,def)
+			return def.tag == 'SHIP' and def.hyperdriveClass > 0 and def.roles.pirate
+		end, pairs(ShipDef)))
+		local laser = Equipment.laser.pulsecannon_1mw
+
+		local arm = function (ship)
+			ship:AddEquip(laser)
+			ship:AddEquip(Equipment.misc.autopilot)
+			return ship
+		end
+
+		local sides = { {}, {} }
+		local anchor = arm(Space.SpawnShip(shipdefs[Engine.rand:Integer(1,#shipdefs)].id, 1, 1.01))
+		table.insert(sides[1], anchor)
+		for i = 2,count do
+			local ship = arm(Space.SpawnShipNear(shipdefs[Engine.rand:Integer(1,#shipdefs)].id, anchor, 5, 20))
+			table.insert(sides[i % 2 + 1], ship)
+		end
+
+		for side = 1,2 do
+			local enemies = sides[3 - side]
+			if #enemies > 0 then
+				for i,ship in ipairs(sides[side]) do
+					ship:AIKill(enemies[(i - 1) % #enemies + 1])
+				end
+			end
+		end
+	end,
+}
@@ -0,0 +1,35 @@
+-- Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+-- Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+-- Benchmark scenario: a large number of unpowered ships falling towards the
+-- player's planet, some of them through its atmosphere, exercising the
+-- integration and external forces of moving bodies with no AI on top.
+-- Compare the dynamics phase at counts of 1000 and 10000.
+
+local Engine = import("Engine")
+local Game = import("Game")
+local Space = import("Space")
+local ShipDef = import("ShipDef")
+local SystemPath = import("SystemPath")
+local utils = import("utils")
+
+return {
+	start = SystemPath.New(0,0,0,0,6),
+	time = 48600,
+	count = 1000,
+
+	setup = function (count)
+		local parent = Game.player:GetDockedWith().path:GetSystemBody().parent
+		local planet = Space.GetBody(parent.index)
+		local radius = parent.radius / 1000 -- in km, like SpawnShipNear
+
+		local shipdefs = utils.build_array(utils.filter(function (k,def)
+			return def.tag == 'SHIP' and def.hyperdriveClass > 0
+		end, pairs(ShipDef)))
+
+		for i = 1,count do
+			local def = shipdefs[Engine.rand:Integer(1,#shipdefs)]
+			Space.SpawnShipNear(def.id, planet, radius * 1.01, radius * 2.0)
+		end
+	end,
+}
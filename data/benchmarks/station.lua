@@ -0,0 +1,45 @@
+-- Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+-- Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+-- Benchmark scenario: traffic at the player's starport. Half the ships
+-- start docked, the rest arrive from nearby space and queue to dock.
+
+local Engine = import("Engine")
+local Game = import("Game")
+local Space = import("Space")
+local ShipDef = import("ShipDef")
+local SystemPath = import("SystemPath")
+local Equipment = import("Equipment")
+local utils = import("utils")
+
+local spawnShip = function (def, spawn)
+	local ship = spawn(def.id)
+	if not ship then return nil end
+	if def.equipSlotCapacity.atmo_shield > 0 then
+		ship:AddEquip(Equipment.misc.atmospheric_shielding)
+	end
+	ship:AddEquip(Equipment.misc.autopilot)
+	return ship
+end
+
+return {
+	start = SystemPath.New(0,0,0,0,6),
+	time = 48600,
+	count = 40,
+
+	setup = function (count)
+		local station = Game.player:GetDockedWith()
+		local shipdefs = utils.build_array(utils.filter(function (k,def)
+			return def.tag == 'SHIP' and def.hyperdriveClass > 0
+		end, pairs(ShipDef)))
+
+		for i = 1,count do
+			local def = shipdefs[Engine.rand:Integer(1,#shipdefs)]
+			local ship = i % 2 == 0 and spawnShip(def, function (id) return Space.SpawnShipDocked(id, station) end)
+			if not ship then
+				ship = spawnShip(def, function (id) return Space.SpawnShipNear(id, station, 20, 100) end)
+				ship:AIDockWith(station)
+			end
+		end
+	end,
+}
@@ -30,6 +30,24 @@ local pending = {}
 local callbacks = {}
 local do_callback = {}
 
+-- event being dispatched, its handlers and the next one to call. Kept
+-- between calls to _Emit so that a budgeted emit can resume where it stopped.
+local current, current_cbs, current_index
+
+-- per-handler timing, keyed by "source:line"
+local handler_stats = {}
+local handler_names = setmetatable({}, { __mode = "k" })
+
+local function handler_name (cb)
+	local name = handler_names[cb]
+	if not name then
+		local d = debug.getinfo(cb, "S")
+		name = d.short_src .. ":" .. d.linedefined
+		handler_names[cb] = name
+	end
+	return name
+end
+
 local do_callback_normal = function (cb, p)
 	cb(table.unpack(p.event))
 end
@@ -171,20 +189,102 @@ Event = {
 		do_callback[name] = enabled and do_callback_timed or do_callback_normal
 	end,
 
+	--
+	-- Function: GetHandlerStats
+	--
+	-- Returns the time spent in each event handler since the game started
+	-- (or since <ResetHandlerStats> was last called).
+	--
+	-- > local stats = Event.GetHandlerStats()
+	--
+	-- Return:
+	--
+	--   stats - a table keyed by "source:line" of the handler function. Each
+	--           value is a table with the fields calls, total and max; the
+	--           last two are in milliseconds.
+	--
+	-- Availability:
+	--
+	--   2017 November
+	--
+	-- Status:
+	--
+	--   debug
+	--
+	GetHandlerStats = function ()
+		return handler_stats
+	end,
+
+	--
+	-- Function: ResetHandlerStats
+	--
+	-- Clears the counters returned by <GetHandlerStats>.
+	--
+	-- > Event.ResetHandlerStats()
+	--
+	-- Availability:
+	--
+	--   2017 November
+	--
+	-- Status:
+	--
+	--   debug
+	--
+	ResetHandlerStats = function ()
+		handler_stats = {}
+	end,
+
 	-- internal method, called from C++
 	_Clear = function ()
 		pending = {}
+		current = nil
 	end,
 
 	-- internal method, called from C++
-	_Emit = function ()
-		while #pending > 0 do
-			local p = table.remove(pending, 1)
-			if callbacks[p.name] then
-				for cb,_ in pairs(callbacks[p.name]) do
-					do_callback[p.name](cb, p)
+	-- clock returns real time in seconds. If budget (seconds) is given,
+	-- dispatch stops once it is used up and carries on from the same
+	-- handler on the next call, so handlers still run in queue order.
+	_Emit = function (clock, budget)
+		local deadline = budget and clock() + budget
+		while true do
+			if not current then
+				if #pending == 0 then return end
+				current = table.remove(pending, 1)
+				current_cbs = {}
+				current_index = 1
+				if callbacks[current.name] then
+					for cb,_ in pairs(callbacks[current.name]) do
+						table.insert(current_cbs, cb)
+					end
 				end
 			end
+
+			while current_index <= #current_cbs do
+				local cb = current_cbs[current_index]
+				current_index = current_index + 1
+
+				-- a handler may have been deregistered by an earlier one
+				if callbacks[current.name][cb] then
+					local tstart = clock()
+					do_callback[current.name](cb, current)
+					local tend = clock()
+
+					local name = handler_name(cb)
+					local stats = handler_stats[name]
+					if not stats then
+						stats = { calls = 0, total = 0, max = 0 }
+						handler_stats[name] = stats
+					end
+					local ms = (tend - tstart) * 1000
+					stats.calls = stats.calls + 1
+					stats.total = stats.total + ms
+					if ms > stats.max then stats.max = ms end
+
+					if deadline and tend >= deadline then return end
+				end
+			end
+
+			current = nil
 		end
 	end
 }
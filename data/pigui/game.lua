@@ -782,10 +782,10 @@ local function displayOnScreenObjects()
 	local combatTarget = player:GetCombatTarget()
 	local onscreen = {}
 	-- go through all objects, collecting those that are shown near each other into single objects
-	for k,v in pairs(bodies) do
+	for _,v in ipairs(bodies) do
 		if v.onscreen then
 			local it = v
-			it.label = k:GetLabel()
+			it.label = it.body:GetLabel()
 			local itbody = it.body
 			local itsc = it.screenCoordinates
 			local inserted = false
@@ -0,0 +1,417 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "Benchmark.h"
+#include "Pi.h"
+#include "Game.h"
+#include "Space.h"
+#include "Player.h"
+#include "Frame.h"
+#include "View.h"
+#include "BaseSphere.h"
+#include "JobQueue.h"
+#include "Lua.h"
+#include "LuaObject.h"
+#include "LuaUtils.h"
+#include "FileSystem.h"
+#include "OS.h"
+#include "Serializer.h"
+#include "galaxy/Galaxy.h"
+#include "galaxy/GalaxyGenerator.h"
+#include "galaxy/Sector.h"
+#include "galaxy/SystemPath.h"
+#include "graphics/RenderTrace.h"
+#include "json/json.h"
+#include <algorithm>
+
+namespace Benchmark {
+
+static const char SCENARIO_DIR[] = "benchmarks";
+// in the user's directory, where RendererRecorder writes them
+static const char TRACE_DIR[] = "traces";
+
+// fixed, so that runs of the same scenario spawn the same ships
+static const Uint32 BENCHMARK_SEED = 0x50A3C4;
+
+static const int LUA_CHECK_CALLS = 1000000;
+// sectors out from the origin along each axis
+static const int SECTOR_GEN_RADIUS = 12;
+
+// the big data files that get loaded, or streamed, in one go
+static const char *LOAD_DIRS[] = { "models", "music" };
+
+// time spent in one subsystem over the whole run
+struct Phase {
+	Phase(const char *name_) : name(name_), total(0.0), max(0.0) {}
+	void Add(double ms) { total += ms; max = std::max(max, ms); }
+
+	const char *name;
+	double total;
+	double max;
+};
+
+// start the game described by data/benchmarks/<name>.lua. answers false if
+// there's no such scenario. a scenario returns a table with the starting
+// location, and optionally a start time, a setup function run once the game
+// has started, and the default count to pass to it
+static bool StartScenario(const std::string &name, int count)
+{
+	RefCountedPtr<FileSystem::FileData> code =
+		FileSystem::gameDataFiles.ReadFile(FileSystem::JoinPathBelow(SCENARIO_DIR, name + ".lua"));
+	if (!code)
+		return false;
+
+	lua_State *l = Lua::manager->GetLuaState();
+	LUA_DEBUG_START(l);
+
+	if (pi_lua_loadfile(l, *code) != LUA_OK)
+		Error("%s", lua_tostring(l, -1));
+	pi_lua_protected_call(l, 0, 1);
+	if (!lua_istable(l, -1))
+		Error("Benchmark scenario '%s' did not return a table\n", name.c_str());
+	const int scenario = lua_gettop(l);
+
+	lua_getfield(l, scenario, "start");
+	const SystemPath *start = LuaObject<SystemPath>::GetFromLua(-1);
+	if (!start)
+		Error("Benchmark scenario '%s' has no start location\n", name.c_str());
+	lua_getfield(l, scenario, "time");
+	const double startTime = lua_tonumber(l, -1);
+	lua_getfield(l, scenario, "count");
+	if (count <= 0)
+		count = lua_tointeger(l, -1);
+
+	try {
+		Pi::game = new Game(*start, startTime);
+	}
+	catch (InvalidGameStartLocation &e) {
+		Error("Benchmark scenario '%s': invalid starting location: %s\n", name.c_str(), e.error.c_str());
+	}
+	lua_pop(l, 3);
+
+	Pi::InitGame();
+	Pi::StartGame();
+
+	lua_getfield(l, scenario, "setup");
+	if (lua_isfunction(l, -1)) {
+		lua_pushinteger(l, count);
+		pi_lua_protected_call(l, 1, 0);
+	} else
+		lua_pop(l, 1);
+
+	lua_pop(l, 1);
+	LUA_DEBUG_END(l, 0);
+	return true;
+}
+
+static void LoadSave(const std::string &name)
+{
+	try {
+		Pi::game = Game::LoadGame(name);
+	}
+	catch (CouldNotOpenFileException) {
+		Error("Benchmark: '%s' is neither a scenario nor a saved game\n", name.c_str());
+	}
+	catch (SavedGameCorruptException) {
+		Error("Benchmark: saved game '%s' is corrupt\n", name.c_str());
+	}
+	catch (SavedGameWrongVersionException) {
+		Error("Benchmark: saved game '%s' is from an incompatible version\n", name.c_str());
+	}
+
+	Pi::InitGame();
+	Pi::StartGame();
+
+	// games are saved paused
+	Pi::game->RequestTimeAccel(Game::TIMEACCEL_1X);
+	Pi::game->SetTimeAccel(Game::TIMEACCEL_1X);
+}
+
+// times getting the player back off the lua stack as a Body, the check that
+// every lua method on a body or ship does on its self argument
+static void LuaCheck(int calls)
+{
+	if (calls <= 0)
+		calls = LUA_CHECK_CALLS;
+	if (!StartScenario("station", 0))
+		Error("Benchmark: no 'station' scenario to check lua objects in\n");
+
+	lua_State *l = Lua::manager->GetLuaState();
+	LUA_DEBUG_START(l);
+	LuaObject<Player>::PushToLua(Pi::player);
+
+	// counted, so that the calls can't be optimised away
+	int found = 0;
+	Uint64 mark = SDL_GetPerformanceCounter();
+	for (int i = 0; i < calls; i++) {
+		if (LuaObject<Body>::CheckFromLua(-1) == Pi::player)
+			found++;
+	}
+	const double totalMs = LapMs(mark);
+	assert(found == calls);
+
+	lua_pop(l, 1);
+	LUA_DEBUG_END(l, 0);
+
+	Json::Value report(Json::objectValue);
+	report["scenario"] = "lua_check";
+	report["calls"] = calls;
+	report["found"] = found;
+	report["total_ms"] = totalMs;
+	report["ns_per_call"] = totalMs * 1e6 / calls;
+
+	Json::StyledWriter writer;
+	fputs(writer.write(report).c_str(), stdout);
+	fflush(stdout);
+
+	Pi::EndGame();
+}
+
+// reads every file in the model and music directories, holding on to them
+// all, then goes through every byte of them, reporting how long each takes
+// and how much the process had resident afterwards
+static void FileLoad()
+{
+	std::vector< RefCountedPtr<FileSystem::FileData> > loaded;
+	size_t bytes = 0;
+	const size_t startRss = OS::GetPeakResidentBytes();
+
+	Uint64 mark = SDL_GetPerformanceCounter();
+	for (const char *dir : LOAD_DIRS) {
+		for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, dir, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
+			RefCountedPtr<FileSystem::FileData> data = files.Current().Read();
+			if (!data)
+				continue;
+			bytes += data->GetSize();
+			loaded.push_back(data);
+		}
+	}
+	const double readMs = LapMs(mark);
+	const size_t readRss = OS::GetPeakResidentBytes();
+
+	Uint32 sum = 0;
+	for (const auto &data : loaded) {
+		const char *p = data->GetData();
+		for (size_t i = 0; i < data->GetSize(); i++)
+			sum += Uint8(p[i]);
+	}
+	const double touchMs = LapMs(mark);
+	const size_t touchRss = OS::GetPeakResidentBytes();
+
+	Json::Value report(Json::objectValue);
+	report["scenario"] = "file_load";
+	report["files"] = Json::UInt64(loaded.size());
+	report["bytes"] = Json::UInt64(bytes);
+	report["read_ms"] = readMs;
+	report["touch_ms"] = touchMs;
+	report["checksum"] = sum;
+	// peaks, so only meaningful when they grow
+	report["peak_rss_start"] = Json::UInt64(startRss);
+	report["peak_rss_read"] = Json::UInt64(readRss);
+	report["peak_rss_touched"] = Json::UInt64(touchRss);
+
+	Json::StyledWriter writer;
+	fputs(writer.write(report).c_str(), stdout);
+	fflush(stdout);
+}
+
+// generates the sectors around the origin, with each system's faction found
+// through the ownership grid, then times finding them all again by testing
+// every faction, counting any systems the two disagree on
+static void SectorGen(int radius)
+{
+	if (radius <= 0)
+		radius = SECTOR_GEN_RADIUS;
+	RefCountedPtr<Galaxy> galaxy = GalaxyGenerator::Create();
+
+	Uint32 numSectors = 0, numSystems = 0, mismatches = 0;
+	std::vector<RefCountedPtr<const Sector> > sectors;
+	Uint64 mark = SDL_GetPerformanceCounter();
+	for (int sx = -radius; sx < radius; sx++) {
+		for (int sy = -radius; sy < radius; sy++) {
+			for (int sz = -radius; sz < radius; sz++) {
+				RefCountedPtr<const Sector> sec = galaxy->GetSector(SystemPath(sx, sy, sz));
+				for (const Sector::System &sys : sec->m_systems)
+					sys.GetFaction();
+				numSystems += sec->m_systems.size();
+				sectors.push_back(sec);
+				numSectors++;
+			}
+		}
+	}
+	const double generateMs = LapMs(mark);
+
+	for (const RefCountedPtr<const Sector> &sec : sectors) {
+		for (const Sector::System &sys : sec->m_systems) {
+			if (galaxy->GetFactions()->GetNearestFactionExact(&sys) != sys.GetFaction())
+				mismatches++;
+		}
+	}
+	const double exactMs = LapMs(mark);
+	sectors.clear();
+	galaxy->FlushCaches();
+
+	Json::Value report(Json::objectValue);
+	report["scenario"] = "sector_gen";
+	report["sectors"] = numSectors;
+	report["systems"] = numSystems;
+	report["generate_ms"] = generateMs;
+	report["sectors_per_s"] = numSectors * 1000.0 / generateMs;
+	report["exact_factions_ms"] = exactMs;
+	report["mismatches"] = mismatches;
+
+	Json::StyledWriter writer;
+	fputs(writer.write(report).c_str(), stdout);
+	fflush(stdout);
+}
+
+void Run(const std::string &scenario, int ticks, int count)
+{
+	Pi::rng.seed(BENCHMARK_SEED);
+
+	if (scenario == "lua_check") {
+		LuaCheck(count);
+		return;
+	}
+	if (scenario == "file_load") {
+		FileLoad();
+		return;
+	}
+	if (scenario == "sector_gen") {
+		SectorGen(count);
+		return;
+	}
+
+	if (!StartScenario(scenario, count))
+		LoadSave(scenario);
+
+	Phase collision("collision"), frames("frame_updates"), ai("ai"), orbitRails("orbit_rails"),
+		dynamics("dynamics"), geoms("geom_moves"), luaEvents("lua_events"), luaTimers("lua_timers"), bookkeeping("bookkeeping"),
+		other("game_other"), render("render"), geosphereJobs("geosphere_jobs"), luaGC("lua_gc");
+	Phase *phases[] = { &collision, &frames, &ai, &orbitRails, &dynamics, &geoms, &luaEvents, &luaTimers,
+		&bookkeeping, &other, &render, &geosphereJobs, &luaGC };
+
+	const float step = Pi::game->GetTimeStep();
+	Output("Benchmark: running '%s' for %d ticks of %f seconds\n", scenario.c_str(), ticks, step);
+
+	const Uint64 start = SDL_GetPerformanceCounter();
+	int tick = 0;
+	for (; tick < ticks && Pi::game; tick++) {
+		Uint64 mark = SDL_GetPerformanceCounter();
+
+		Pi::game->TimeStep(step);
+		const double stepMs = LapMs(mark);
+
+		const Space::TimeStepStats &stats = Pi::game->GetSpace()->GetTimeStepStats();
+		collision.Add(stats.collision);
+		frames.Add(stats.frames);
+		ai.Add(stats.ai);
+		orbitRails.Add(stats.orbitRails);
+		dynamics.Add(stats.dynamics);
+		geoms.Add(stats.geoms);
+		luaEvents.Add(stats.luaEvents);
+		luaTimers.Add(stats.luaTimers);
+		bookkeeping.Add(stats.bookkeeping);
+		other.Add(std::max(0.0, stepMs - (stats.collision + stats.frames + stats.ai + stats.orbitRails +
+			stats.dynamics + stats.geoms + stats.luaEvents + stats.luaTimers + stats.bookkeeping)));
+
+		// drawing against the dummy renderer still runs the camera and the
+		// terrain level of detail updates, which is what queues geosphere jobs
+		if (!Pi::player->IsDead()) {
+			for (Body *b : Pi::game->GetSpace()->GetBodies())
+				b->UpdateInterpTransform(1.0);
+			Pi::game->GetSpace()->GetRootFrame()->UpdateInterpTransform(1.0);
+			Pi::GetView()->Update();
+			Pi::GetView()->Draw3D();
+		}
+		render.Add(LapMs(mark));
+
+		BaseSphere::UpdateAllBaseSphereDerivatives();
+		static_cast<SyncJobQueue*>(Pi::GetSyncJobQueue())->RunJobs();
+		Pi::GetAsyncJobQueue()->FinishJobs();
+		Pi::GetSyncJobQueue()->FinishJobs();
+		geosphereJobs.Add(LapMs(mark));
+
+		Lua::manager->StepGarbageCollector(0.0, false);
+		luaGC.Add(Lua::manager->GetCollectionTime());
+	}
+	Uint64 end = start;
+	const double totalMs = LapMs(end);
+
+	Json::Value report(Json::objectValue);
+	report["scenario"] = scenario;
+	report["ticks"] = tick;
+	report["step"] = step;
+	report["bodies"] = Pi::game ? Pi::game->GetSpace()->GetNumBodies() : 0;
+	report["total_ms"] = totalMs;
+	report["mean_tick_ms"] = tick ? totalMs / tick : 0.0;
+
+	Json::Value subsystems(Json::objectValue);
+	for (const Phase *phase : phases) {
+		Json::Value times(Json::objectValue);
+		times["total_ms"] = phase->total;
+		times["mean_ms"] = tick ? phase->total / tick : 0.0;
+		times["max_ms"] = phase->max;
+		subsystems[phase->name] = times;
+	}
+	report["subsystems"] = subsystems;
+
+	// the log goes to stderr, so stdout carries nothing but the report
+	Json::StyledWriter writer;
+	fputs(writer.write(report).c_str(), stdout);
+	fflush(stdout);
+
+	if (Pi::game)
+		Pi::EndGame();
+}
+
+void Replay(const std::string &name)
+{
+	const std::string path = FileSystem::JoinPathBelow(TRACE_DIR, name);
+	RefCountedPtr<FileSystem::FileData> trace = FileSystem::userFiles.ReadFile(path);
+	if (!trace) {
+		Output("Benchmark: no renderer trace '%s'\n", path.c_str());
+		return;
+	}
+
+	Output("Benchmark: replaying '%s' on %s\n", name.c_str(), Pi::renderer->GetName());
+
+	Graphics::Trace::ReplayStats stats;
+	std::string error;
+	Uint64 mark = SDL_GetPerformanceCounter();
+	const bool ok = Graphics::Trace::Replay(Pi::renderer, trace->AsByteRange(), stats, error);
+	const double totalMs = LapMs(mark);
+	if (!ok)
+		Output("Benchmark: replay stopped: %s\n", error.c_str());
+
+	Json::Value report(Json::objectValue);
+	report["trace"] = name;
+	report["renderer"] = Pi::renderer->GetName();
+	report["complete"] = ok;
+	report["frames"] = stats.frames;
+	report["total_ms"] = totalMs;
+	report["mean_frame_ms"] = stats.frames ? totalMs / stats.frames : 0.0;
+	report["objects_created"] = stats.objectsCreated;
+	report["draws"] = stats.draws;
+	report["draws_skipped"] = stats.drawsSkipped;
+	report["vertices_drawn"] = Json::UInt64(stats.verticesDrawn);
+	report["bytes_uploaded"] = Json::UInt64(stats.bytesUploaded);
+	report["material_changes"] = stats.materialChanges;
+	report["render_state_changes"] = stats.renderStateChanges;
+	report["redundant_render_states"] = stats.redundantRenderStates;
+	report["redundant_transforms"] = stats.redundantTransforms;
+	report["redundant_render_targets"] = stats.redundantRenderTargets;
+
+	Json::Value commands(Json::objectValue);
+	for (Uint32 i = 0; i < Graphics::Trace::MAX_COMMAND; i++) {
+		if (stats.commandCounts[i])
+			commands[Graphics::Trace::CommandName(Graphics::Trace::Command(i))] = stats.commandCounts[i];
+	}
+	report["commands"] = commands;
+
+	Json::StyledWriter writer;
+	fputs(writer.write(report).c_str(), stdout);
+	fflush(stdout);
+}
+
+} // namespace Benchmark
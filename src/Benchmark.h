@@ -0,0 +1,28 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include <string>
+
+// Headless simulation benchmark (pioneer -bench). Starts a scripted scenario
+// from data/benchmarks or loads a saved game, runs a fixed number of physics
+// ticks and prints the time spent in each subsystem to stdout as JSON.
+// Meant to run with the dummy renderer, so it needs no GPU or display.
+namespace Benchmark {
+	// count is handed to the scenario's setup function (eg how many ships to
+	// spawn); 0 means the scenario's own default. Ignored for saved games.
+	// The scenario "lua_check" is built in: it times count (by default a
+	// million) LuaObject<Body>::CheckFromLua calls on the player instead.
+	// So is "file_load", which times reading the model and music files, and
+	// "sector_gen", which times generating the sectors within count (by
+	// default 12) of the origin and checks their factions.
+	void Run(const std::string &scenario, int ticks, int count);
+
+	// replays a renderer trace (see graphics/RendererRecorder.h) from the
+	// user's traces directory and reports what it did and how long it took
+	void Replay(const std::string &name);
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include "json/JsonUtils.h"
 #include "Propulsion.h"
 #include "FixedGuns.h"
+#include "Game.h"
 
 static const float KINETIC_ENERGY_MULT = 0.00001f;
 const double DynamicBody::DEFAULT_DRAG_COEFF = 0.1; // 'smooth sphere'
@@ -24,6 +25,7 @@ DynamicBody::DynamicBody()
 	m_flags = Body::FLAG_CAN_MOVE_FRAME;
 	m_oldPos = GetPosition();
 	m_oldAngDisplacement = vector3d(0.0);
+	m_stepLimit = 1.0;
 	m_force = vector3d(0.0);
 	m_torque = vector3d(0.0);
 	m_vel = vector3d(0.0);
@@ -225,24 +227,106 @@ void DynamicBody::CalcExternalForce()
 	}
 }
 
-void DynamicBody::TimeStepUpdate(const float timeStep)
+// analytic orbits are used for unpowered bodies once the step is this long
+// (100x time acceleration and up)
+static const float COAST_MIN_TIMESTEP = 1.0f;
+// ...as long as they never come closer to the frame's body than this, in its radii
+static const double COAST_MIN_PERIAPSIS = 1.5;
+// ...and no other body is within this of where they might get to
+static const double COAST_CLEARANCE = 100000.0;
+
+// longer steps are integrated in parts no longer than this
+static const float MAX_SUBSTEP = 1.0f;
+static const int MAX_SUBSTEPS = 16;
+
+bool DynamicBody::TryCoast(const float timeStep)
 {
-	m_oldPos = GetPosition();
-	if (m_isMoving) {
-		m_force += m_externalForce;
+	if (timeStep < COAST_MIN_TIMESTEP)
+		return false;
+	if (m_force.LengthSqr() != 0.0 || m_torque.LengthSqr() != 0.0)
+		return false;
+
+	// only the gravity of the frame's body, seen from a frame that doesn't
+	// turn with it
+	const Frame *frame = GetFrame();
+	if (!frame || frame->IsRotFrame())
+		return false;
+	const Body *body = frame->GetBody();
+	if (!body || body->IsType(Object::SPACESTATION) || body->GetMass() <= 0.0)
+		return false;
+
+	const double centralMass = body->GetMass();
+	const Orbit orbit = Orbit::FromBodyState(GetPosition(), m_vel, centralMass);
+	if (orbit.GetSemiMajorAxis() <= 0.0)
+		return false;
+	const double periapsis = orbit.GetSemiMajorAxis() * fabs(1.0 - orbit.GetEccentricity());
+	if (periapsis < COAST_MIN_PERIAPSIS * body->GetPhysRadius())
+		return false;
+
+	// the orbit has to reproduce where the body is now and how fast it's
+	// going, which it doesn't always manage for nearly degenerate ones (and
+	// a NaN fails these too)
+	const double r = GetPosition().Length();
+	const double posErr = (orbit.OrbitalPosAtTime(0.0) - GetPosition()).Length();
+	if (!(posErr <= 1e-6 * r))
+		return false;
+	const double velErr = (orbit.OrbitalVelocityAtTime(centralMass, 0.0) - m_vel).Length();
+	if (!(velErr <= 1e-6 * m_vel.Length()))
+		return false;
+
+	// near other bodies (combat, stations) the steps have to be fine
+	const double reach = m_vel.Length() * timeStep + COAST_CLEARANCE;
+	Space::BodyNearList nearby;
+	Pi::game->GetSpace()->GetBodiesMaybeNear(this, reach, nearby);
+	for (const Body *other : nearby) {
+		if (other == this || other == body)
+			continue;
+		if (other->GetPositionRelTo(this).Length() - other->GetPhysRadius() < reach)
+			return false;
+	}
+
+	SetPosition(orbit.OrbitalPosAtTime(timeStep));
+	m_vel = orbit.OrbitalVelocityAtTime(centralMass, timeStep);
+
+	// no torque, so the body keeps turning as it was
+	const double len = m_angVel.Length();
+	if (len > 1e-16) {
+		vector3d axis = m_angVel * (1.0 / len);
+		matrix3x3d rot = matrix3x3d::Rotate(len * timeStep, axis);
+		SetOrient(rot * GetOrient());
+	}
+	m_oldAngDisplacement = m_angVel * timeStep;
+
+	m_lastForce = m_externalForce;
+	m_lastTorque = vector3d(0.0);
+	CalcExternalForce();
+	return true;
+}
+
+void DynamicBody::Integrate(const float timeStep)
+{
+	// the body's own forces act throughout; the external ones are worked out
+	// again after each part of the step
+	const int substeps = std::min(MAX_SUBSTEPS, int(ceil(timeStep / MAX_SUBSTEP)));
+	const float substep = substeps > 1 ? timeStep / substeps : timeStep;
+	const vector3d force = m_force;
+
+	m_oldAngDisplacement = vector3d(0.0);
+	for (int i = 0; i < substeps; i++) {
+		m_force = force + m_externalForce;
 
-		m_vel += double(timeStep) * m_force * (1.0 / m_mass);
-		m_angVel += double(timeStep) * m_torque * (1.0 / m_angInertia);
+		m_vel += double(substep) * m_force * (1.0 / m_mass);
+		m_angVel += double(substep) * m_torque * (1.0 / m_angInertia);
 
 		double len = m_angVel.Length();
 		if (len > 1e-16) {
 			vector3d axis = m_angVel * (1.0 / len);
-			matrix3x3d r = matrix3x3d::Rotate(len * timeStep, axis);
+			matrix3x3d r = matrix3x3d::Rotate(len * substep, axis);
 			SetOrient(r * GetOrient());
 		}
-		m_oldAngDisplacement = m_angVel * timeStep;
+		m_oldAngDisplacement += m_angVel * substep;
 
-		SetPosition(GetPosition() + m_vel * double(timeStep));
+		SetPosition(GetPosition() + m_vel * double(substep));
 
 //if (this->IsType(Object::PLAYER))
 //Output("pos = %.1f,%.1f,%.1f, vel = %.1f,%.1f,%.1f, force = %.1f,%.1f,%.1f, external = %.1f,%.1f,%.1f\n",
@@ -250,13 +334,29 @@ void DynamicBody::TimeStepUpdate(const float timeStep)
 //	m_externalForce.x, m_externalForce.y, m_externalForce.z);
 
 		m_lastForce = m_force;
-		m_lastTorque = m_torque;
-		m_force = vector3d(0.0);
-		m_torque = vector3d(0.0);
 		CalcExternalForce();			// regenerate for new pos/vel
-	} else {
+	}
+
+	m_lastTorque = m_torque;
+	m_force = vector3d(0.0);
+	m_torque = vector3d(0.0);
+}
+
+void DynamicBody::TimeStepUpdate(const float timeStep)
+{
+	m_oldPos = GetPosition();
+	if (!m_isMoving) {
 		m_oldAngDisplacement = vector3d(0.0);
+	} else if (m_stepLimit < 1.0) {
+		// stopped where it'd hit something, so that it's touching it next step
+		Integrate(timeStep);
+		SetPosition(m_oldPos + (GetPosition() - m_oldPos) * m_stepLimit);
+	} else if (TryCoast(timeStep)) {
+		// followed its orbit
+	} else {
+		Integrate(timeStep);
 	}
+	m_stepLimit = 1.0;
 
 	ModelBody::TimeStepUpdate(timeStep);
 }
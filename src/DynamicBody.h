@@ -34,6 +34,9 @@ public:
 	bool IsMoving() const { return m_isMoving; }
 	virtual double GetMass() const override { return m_mass; }	// XXX don't override this
 	virtual void TimeStepUpdate(const float timeStep) override;
+	// go only this fraction of the way the next step, as something's in the
+	// way (see Space's hitCallback). the least of the step's limits holds
+	void LimitStep(double fraction) { m_stepLimit = std::min(m_stepLimit, fraction); }
 	double CalcAtmosphericForce(double dragCoeff) const;
 	void CalcExternalForce();
 
@@ -92,8 +95,14 @@ protected:
 	bool m_decelerating;
 	AIError m_aiMessage;
 private:
+	// follows the orbit around the frame's body analytically, if the body is
+	// unpowered and far enough from everything. answers whether it did
+	bool TryCoast(const float timeStep);
+	void Integrate(const float timeStep);
+
 	vector3d m_oldPos;
 	vector3d m_oldAngDisplacement;
+	double m_stepLimit;
 
 	vector3d m_force;
 	vector3d m_torque;
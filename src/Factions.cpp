@@ -449,6 +449,7 @@ void FactionsDatabase::PostInit()
 	assert(m_initialized);
 	assert(m_galaxy->IsInitialized());
 	SetHomeSectors();
+	m_ownership_grid.Build(m_factions, &m_no_faction);
 
 #ifdef DUMP_FACTIONS // useful for dumping the factions from an autogenerated script
 	for (size_t i = 0; i<m_factions.size(); i++)
@@ -494,7 +495,6 @@ void FactionsDatabase::AddFaction(Faction* faction)
 		}
 		m_missingFactionsMap.erase(it);
 	}
-	m_spatial_index.Add(faction);
 
 	if (faction->hasHomeworld) m_homesystems.insert(faction->homeworld.SystemOnly());
 	faction->idx = m_factions.size()-1;
@@ -538,13 +538,35 @@ const Faction* FactionsDatabase::GetNearestFaction(const Sector::System* sys) co
 		return sys->GetCustomSystem()->faction;
 	}
 
-	// if it didn't, or it wasn't a custom StarStystem, then we go ahead and assign it a faction allegiance like normal below...
+	// the ownership grid only exists once the home sectors are known
+	if (!m_ownership_grid.IsBuilt())
+		return GetNearestFactionExact(sys);
+
+	// if it didn't, or it wasn't a custom StarStystem, then most sectors belong to a single faction outright...
+	const OwnershipGrid::Ownership& ownership = m_ownership_grid.Lookup(sys->sx, sys->sy, sys->sz);
+	if (ownership.owner)
+		return ownership.owner;
+
+	// ...and in border sectors we go ahead and assign it a faction allegiance like normal below
 	const Faction* result = &m_no_faction;
 	double closestFactionDist = HUGE_VAL;
-	ConstFactionList& candidates = m_spatial_index.CandidateFactions(sys);
+	for (const Faction* faction : ownership.candidates) {
+		if (faction->IsCloserAndContains(closestFactionDist, sys)) result = faction;
+	}
+	return result;
+}
+
+const Faction* FactionsDatabase::GetNearestFactionExact(const Sector::System* sys) const
+{
+	PROFILE_SCOPED()
+	if (sys->GetCustomSystem() && sys->GetCustomSystem()->faction) {
+		return sys->GetCustomSystem()->faction;
+	}
 
-	for (ConstFactionIterator it = candidates.begin(); it != candidates.end(); ++it) {
-		if ((*it)->IsCloserAndContains(closestFactionDist, sys)) result = *it;
+	const Faction* result = &m_no_faction;
+	double closestFactionDist = HUGE_VAL;
+	for (const Faction* faction : m_factions) {
+		if (faction->IsCloserAndContains(closestFactionDist, sys)) result = faction;
 	}
 	return result;
 }
@@ -715,95 +737,229 @@ Faction::Faction(Galaxy* galaxy) :
 
 // ------ Factions Spatial Indexing ------
 
-void FactionsDatabase::Octsapling::Add(const Faction* faction)
+/*	Slack added around every sector box, so neither systems sitting right on a
+	sector boundary nor float rounding in IsCloserAndContains can put a system on
+	the wrong side of a border that the grid resolved up front.
+*/
+static const double OWNERSHIP_SLACK = 0.1;
+
+void FactionsDatabase::OwnershipGrid::Build(const FactionList& factions, const Faction* noFaction)
 {
 	PROFILE_SCOPED()
-	/*  The general principle here is to put the faction in every octbox cell that a system
-	    that is a member of that faction could be in. This should let us cut the number
-		of factions that have to be checked by GetNearestFaction, by eliminating right off
-		all the those Factions that aren't in the same cell.
+	/*  This happens once, after all the factions are loaded and their home sectors
+	    generated, so it can afford to look at every faction for every block of sectors.
+	*/
+	m_noFaction = noFaction;
+	m_claims.clear();
+	m_ownership.clear();
+	m_ownershipIndex.clear();
+	m_blocks.clear();
+	m_cells.clear();
+
+	Sint32 sectorMin[3] = { INT_MAX, INT_MAX, INT_MAX };
+	Sint32 sectorMax[3] = { INT_MIN, INT_MIN, INT_MIN };
+
+	m_claims.reserve(factions.size());
+	for (const Faction* faction : factions) {
+		Claim claim;
+		claim.faction = faction;
+		claim.placed  = false;
+		claim.exact   = faction->hasHomeworld;
+		claim.radius  = 0.0;
+
+		if (faction->hasHomeworld) {
+			RefCountedPtr<const Sector> sec = faction->GetHomeSector();
+			if (faction->homeworld.systemIndex < sec->m_systems.size()) {
+				claim.placed  = true;
+				claim.exact   = false;
+				claim.home[0] = faction->homeworld.sectorX;
+				claim.home[1] = faction->homeworld.sectorY;
+				claim.home[2] = faction->homeworld.sectorZ;
+				claim.centre  = vector3d(sec->m_systems[faction->homeworld.systemIndex].GetFullPosition());
+				claim.radius  = faction->Radius();
+				for (int i = 0; i < 3; i++) {
+					sectorMin[i] = std::min(sectorMin[i], Sint32(floor((claim.centre[i] - claim.radius) / Sector::SIZE)) - 1);
+					sectorMax[i] = std::max(sectorMax[i], Sint32(floor((claim.centre[i] + claim.radius) / Sector::SIZE)) + 1);
+				}
+			}
+		}
+		m_claims.push_back(claim);
+	}
 
-		As I'm just going for the quick performance win, I'm being very sloppy and
-		treating a Faction as if it was a cube rather than a sphere. I'm also not even
-		attempting to work out real faction boundaries for this.
+	std::vector<const Claim*> claims, unplaced, blockClaims, cellClaims;
+	for (const Claim& claim : m_claims) {
+		claims.push_back(&claim);
+		if (!claim.placed) unplaced.push_back(&claim);
+	}
 
-		Obviously this all could be improved even without this Octsapling growing into
-		a full Octree.
+	// no faction with a known homeworld reaches outside the grid
+	if (!Classify(sectorMax, sectorMax, unplaced, cellClaims, m_outside))
+		m_outside = AddOwnership(nullptr, cellClaims);
 
-		This part happens at faction generation time so shouldn't be too performance
-		critical
-	*/
-	RefCountedPtr<const Sector> sec = faction->GetHomeSector();
+	if (sectorMin[0] > sectorMax[0]) {
+		for (int i = 0; i < 3; i++) {
+			m_blockMin[i] = 0;
+			m_blockCount[i] = 0;
+		}
+	} else {
+		for (int i = 0; i < 3; i++) {
+			m_blockMin[i] = BlockIndex(sectorMin[i]);
+			m_blockCount[i] = BlockIndex(sectorMax[i]) - m_blockMin[i] + 1;
+		}
+	}
+	m_blocks.resize(m_blockCount[0] * m_blockCount[1] * m_blockCount[2]);
+
+	Uint32 uniformBlocks = 0;
+	for (Sint32 bz = 0; bz < m_blockCount[2]; bz++) {
+		for (Sint32 by = 0; by < m_blockCount[1]; by++) {
+			for (Sint32 bx = 0; bx < m_blockCount[0]; bx++) {
+				const Sint32 lo[3] = { (m_blockMin[0] + bx) * BLOCK_SIZE, (m_blockMin[1] + by) * BLOCK_SIZE, (m_blockMin[2] + bz) * BLOCK_SIZE };
+				const Sint32 hi[3] = { lo[0] + BLOCK_SIZE - 1, lo[1] + BLOCK_SIZE - 1, lo[2] + BLOCK_SIZE - 1 };
+
+				Uint32 ownership;
+				Uint32& block = m_blocks[(bz * m_blockCount[1] + by) * m_blockCount[0] + bx];
+				if (Classify(lo, hi, claims, blockClaims, ownership)) {
+					block = ownership | UNIFORM_BLOCK;
+					uniformBlocks++;
+					continue;
+				}
 
-	/* only factions with homeworlds that are available at faction generation time can
-	   be added to specific cells...
-	*/
-	if (faction->hasHomeworld && (faction->homeworld.systemIndex < sec->m_systems.size())) {
-		/* calculate potential indexes for the octbox cells the faction needs to go into
-		*/
-		Sector::System sys = sec->m_systems[faction->homeworld.systemIndex];
+				// the block straddles a border, so resolve its sectors one by one against
+				// just the factions that reach into it
+				block = m_cells.size();
+				m_cells.resize(m_cells.size() + BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE);
+				for (int z = 0; z < BLOCK_SIZE; z++) {
+					for (int y = 0; y < BLOCK_SIZE; y++) {
+						for (int x = 0; x < BLOCK_SIZE; x++) {
+							const Sint32 sector[3] = { lo[0] + x, lo[1] + y, lo[2] + z };
+							if (!Classify(sector, sector, blockClaims, cellClaims, ownership))
+								ownership = AddOwnership(nullptr, cellClaims);
+							m_cells[block + (z * BLOCK_SIZE + y) * BLOCK_SIZE + x] = ownership;
+						}
+					}
+				}
+			}
+		}
+	}
 
-		int xmin = BoxIndex(Sint32(sys.GetFullPosition().x - float((faction->Radius()))));
-		int xmax = BoxIndex(Sint32(sys.GetFullPosition().x + float((faction->Radius()))));
-		int ymin = BoxIndex(Sint32(sys.GetFullPosition().y - float((faction->Radius()))));
-		int ymax = BoxIndex(Sint32(sys.GetFullPosition().y + float((faction->Radius()))));
-		int zmin = BoxIndex(Sint32(sys.GetFullPosition().z - float((faction->Radius()))));
-		int zmax = BoxIndex(Sint32(sys.GetFullPosition().z + float((faction->Radius()))));
+	Uint32 borderSectors = 0;
+	for (Uint32 ownership : m_cells)
+		if (!m_ownership[ownership].owner) borderSectors++;
 
-		/* put the faction in all the octbox cells needed in a hideously inexact way that
-		   will generate duplicates in each cell in many cases
-		*/
-		octbox[xmin][ymin][zmin].push_back(faction);  // 0,0,0
-		octbox[xmax][ymin][zmin].push_back(faction);  // 1,0,0
-		octbox[xmax][ymax][zmin].push_back(faction);  // 1,1,0
-		octbox[xmax][ymax][zmax].push_back(faction);  // 1,1,1
+	Output("Faction ownership grid: " SIZET_FMT " blocks (%u uniform), " SIZET_FMT " sectors in split blocks (%u border)\n",
+		m_blocks.size(), uniformBlocks, m_cells.size(), borderSectors);
 
-		octbox[xmin][ymax][zmin].push_back(faction);  // 0,1,0
-		octbox[xmin][ymax][zmax].push_back(faction);  // 0,1,1
-		octbox[xmin][ymin][zmax].push_back(faction);  // 0,0,1
-		octbox[xmax][ymin][zmax].push_back(faction);  // 1,0,1
+	// only needed to share ownerships while building
+	m_ownershipIndex.clear();
+	m_minDist.clear();
+	m_minDist.shrink_to_fit();
+	m_built = true;
+}
 
-		/* prune any duplicates from the octbox cells making things slightly saner
-		*/
-		PruneDuplicates(0,0,0);
-		PruneDuplicates(1,0,0);
-		PruneDuplicates(1,1,0);
-		PruneDuplicates(1,1,1);
+/*	Answer whether the sectors lo..hi (inclusive) resolve to a single owner, and if so
+	which. Either way, intersecting answers the claims that reach into the box.
+*/
+bool FactionsDatabase::OwnershipGrid::Classify(const Sint32 lo[3], const Sint32 hi[3], const std::vector<const Claim*>& claims,
+	std::vector<const Claim*>& intersecting, Uint32& ownership)
+{
+	const vector3d boxMin(lo[0] * Sector::SIZE - OWNERSHIP_SLACK, lo[1] * Sector::SIZE - OWNERSHIP_SLACK, lo[2] * Sector::SIZE - OWNERSHIP_SLACK);
+	const vector3d boxMax((hi[0] + 1) * Sector::SIZE + OWNERSHIP_SLACK, (hi[1] + 1) * Sector::SIZE + OWNERSHIP_SLACK, (hi[2] + 1) * Sector::SIZE + OWNERSHIP_SLACK);
+
+	intersecting.clear();
+	m_minDist.clear();
+	bool exact = false;
+	const Claim* fallback = nullptr;
+	const Claim* best = nullptr;
+	double bestMaxDist = HUGE_VAL;
+
+	for (const Claim* claim : claims) {
+		/* factions without homeworlds are everywhere, and when several of them
+		   are left the last one wins, just as in IsCloserAndContains */
+		if (!claim->placed) {
+			intersecting.push_back(claim);
+			m_minDist.push_back(HUGE_VAL);
+			if (claim->exact) exact = true; else fallback = claim;
+			continue;
+		}
 
-		PruneDuplicates(0,1,0);
-		PruneDuplicates(0,1,1);
-		PruneDuplicates(0,0,1);
-		PruneDuplicates(1,0,1);
+		vector3d nearest, farthest;
+		for (int i = 0; i < 3; i++) {
+			nearest[i]  = Clamp(claim->centre[i], boxMin[i], boxMax[i]);
+			farthest[i] = (claim->centre[i] - boxMin[i] > boxMax[i] - claim->centre[i]) ? boxMin[i] : boxMax[i];
+		}
+		const double minDist = (nearest - claim->centre).Length();
+		if (minDist >= claim->radius + OWNERSHIP_SLACK) continue;
+
+		intersecting.push_back(claim);
+		m_minDist.push_back(minDist);
+
+		// systems in the homeworld sector are at distance zero, whatever their position
+		if (claim->home[0] >= lo[0] && claim->home[0] <= hi[0] &&
+			claim->home[1] >= lo[1] && claim->home[1] <= hi[1] &&
+			claim->home[2] >= lo[2] && claim->home[2] <= hi[2])
+			exact = true;
+
+		const double maxDist = (farthest - claim->centre).Length();
+		if (maxDist < claim->radius - OWNERSHIP_SLACK && maxDist < bestMaxDist) {
+			best = claim;
+			bestMaxDist = maxDist;
+		}
+	}
 
-	} else {
-	/* ...other factions, such as ones with no homeworlds, and more annoyingly ones
-	   whose homeworlds don't exist yet because they're custom systems have to go in
-	   *every* octbox cell
-	*/
-		octbox[0][0][0].push_back(faction);
-		octbox[1][0][0].push_back(faction);
-		octbox[1][1][0].push_back(faction);
-		octbox[1][1][1].push_back(faction);
-
-		octbox[0][1][0].push_back(faction);
-		octbox[0][1][1].push_back(faction);
-		octbox[0][0][1].push_back(faction);
-		octbox[1][0][1].push_back(faction);
+	if (exact) return false;
+
+	if (best) {
+		/* the faction contains the whole box; it owns it if every other faction reaching
+		   into the box has its homeworld further away from all of it */
+		for (size_t i = 0; i < intersecting.size(); i++) {
+			if (intersecting[i]->placed && intersecting[i] != best && m_minDist[i] <= bestMaxDist + OWNERSHIP_SLACK)
+				return false;
+		}
+		ownership = AddOwnership(best->faction, std::vector<const Claim*>());
+		return true;
 	}
+
+	// some faction's border runs through the box
+	for (const Claim* claim : intersecting)
+		if (claim->placed) return false;
+
+	ownership = AddOwnership(fallback ? fallback->faction : m_noFaction, std::vector<const Claim*>());
+	return true;
 }
 
-void FactionsDatabase::Octsapling::PruneDuplicates(const int bx, const int by, const int bz)
+Uint32 FactionsDatabase::OwnershipGrid::AddOwnership(const Faction* owner, const std::vector<const Claim*>& candidates)
 {
-	PROFILE_SCOPED()
-	octbox[bx][by][bz].erase(std::unique( octbox[bx][by][bz].begin(), octbox[bx][by][bz].end() ), octbox[bx][by][bz].end() );
+	std::pair<const Faction*, std::vector<const Faction*> > key(owner, std::vector<const Faction*>());
+	key.second.reserve(candidates.size());
+	for (const Claim* claim : candidates)
+		key.second.push_back(claim->faction);
+
+	auto it = m_ownershipIndex.find(key);
+	if (it != m_ownershipIndex.end())
+		return it->second;
+
+	const Uint32 index = m_ownership.size();
+	m_ownership.push_back(Ownership{ owner, key.second });
+	m_ownershipIndex.insert(std::make_pair(key, index));
+	return index;
 }
 
-const std::vector<const Faction*>& FactionsDatabase::Octsapling::CandidateFactions(const Sector::System* sys) const
+const FactionsDatabase::OwnershipGrid::Ownership& FactionsDatabase::OwnershipGrid::Lookup(Sint32 sx, Sint32 sy, Sint32 sz) const
 {
 	PROFILE_SCOPED()
-	/* answer the factions that we've put in the same octobox cell as the one the
-	   system would go in. This part happens every time we do GetNearest faction
-	   so *is* performance criticale.e
-	*/
-	return octbox[BoxIndex(sys->sx)][BoxIndex(sys->sy)][BoxIndex(sys->sz)];
+	/* this part happens every time we do GetNearestFaction so *is* performance critical */
+	const Sint32 bx = BlockIndex(sx) - m_blockMin[0];
+	const Sint32 by = BlockIndex(sy) - m_blockMin[1];
+	const Sint32 bz = BlockIndex(sz) - m_blockMin[2];
+	if (bx < 0 || bx >= m_blockCount[0] || by < 0 || by >= m_blockCount[1] || bz < 0 || bz >= m_blockCount[2])
+		return m_ownership[m_outside];
+
+	const Uint32 block = m_blocks[(bz * m_blockCount[1] + by) * m_blockCount[0] + bx];
+	if (block & UNIFORM_BLOCK)
+		return m_ownership[block & ~UNIFORM_BLOCK];
+
+	const Sint32 x = sx - (m_blockMin[0] + bx) * BLOCK_SIZE;
+	const Sint32 y = sy - (m_blockMin[1] + by) * BLOCK_SIZE;
+	const Sint32 z = sz - (m_blockMin[2] + bz) * BLOCK_SIZE;
+	return m_ownership[m_cells[block + (z * BLOCK_SIZE + y) * BLOCK_SIZE + x]];
 }
@@ -73,11 +73,6 @@ private:
 	const bool IsCloserAndContains(double& closestFactionDist, const Sector::System* sys) const;
 };
 
-/* One day it might grow up to become a full tree, on the  other hand it might be
-   cut down before it's full growth to be replaced by
-   a proper spatial data structure.
-*/
-
 class FactionsDatabase {
 public:
 	FactionsDatabase(Galaxy* galaxy, const std::string& factionDir) : m_galaxy(galaxy), m_factionDirectory(factionDir), m_no_faction(galaxy), m_may_assign_factions(false), m_initialized(false) { }
@@ -94,6 +89,7 @@ public:
 	const Faction *GetFaction(const Uint32 index) const;
 	const Faction *GetFaction(const std::string& factionName) const;
 	const Faction *GetNearestFaction(const Sector::System* sys) const;
+	const Faction *GetNearestFactionExact(const Sector::System* sys) const; // ignores the ownership grid, for verification
 	bool IsHomeSystem(const SystemPath& sysPath) const;
 
 	const Uint32 GetNumFactions() const;
@@ -101,17 +97,6 @@ public:
 	bool MayAssignFactions() const;
 
 private:
-	class Octsapling {
-	public:
-		void Add(const Faction* faction);
-		const std::vector<const Faction*>& CandidateFactions(const Sector::System* sys) const;
-
-	private:
-		std::vector<const Faction*> octbox[2][2][2];
-		static const int BoxIndex(Sint32 sectorIndex) { return sectorIndex < 0 ? 0: 1; };
-		void PruneDuplicates(const int bx, const int by, const int bz);
-	};
-
 	typedef std::vector<Faction*> FactionList;
 	typedef FactionList::iterator FactionIterator;
 	typedef const std::vector<const Faction*> ConstFactionList;
@@ -120,6 +105,57 @@ private:
 	typedef std::set<SystemPath>  HomeSystemSet;
 	typedef std::map<std::string, std::list<CustomSystem*> > MissingFactionsMap;
 
+	/* Which faction owns each sector, computed once the home sectors are known.
+
+	   Sectors that lie wholly inside one faction's border, and wholly closer to its
+	   homeworld than to that of any other faction reaching them, resolve straight to
+	   that faction. Only border sectors keep a list of candidates that still have to
+	   be tested system by system. The grid is stored as blocks of sectors, and blocks
+	   that resolve as a whole are not split any further.
+	*/
+	class OwnershipGrid {
+	public:
+		struct Ownership {
+			const Faction* owner;                   // non-null if the whole sector belongs to it
+			std::vector<const Faction*> candidates; // otherwise, the factions to test exactly
+		};
+
+		OwnershipGrid() : m_built(false) { }
+		void Build(const FactionList& factions, const Faction* noFaction);
+		bool IsBuilt() const { return m_built; }
+		const Ownership& Lookup(Sint32 sx, Sint32 sy, Sint32 sz) const;
+
+	private:
+		struct Claim {
+			const Faction* faction;
+			bool placed;     // has a homeworld whose position is known
+			bool exact;      // has a homeworld, but it couldn't be placed, so always test exactly
+			Sint32 home[3];  // homeworld sector
+			vector3d centre;
+			double radius;
+		};
+
+		static const int BLOCK_SIZE = 8; // sectors along each side of a block
+		static const Uint32 UNIFORM_BLOCK = 0x80000000;
+
+		static int BlockIndex(Sint32 sectorIndex) { return sectorIndex >= 0 ? sectorIndex / BLOCK_SIZE : (sectorIndex + 1) / BLOCK_SIZE - 1; }
+		bool Classify(const Sint32 lo[3], const Sint32 hi[3], const std::vector<const Claim*>& claims,
+			std::vector<const Claim*>& intersecting, Uint32& ownership);
+		Uint32 AddOwnership(const Faction* owner, const std::vector<const Claim*>& candidates);
+
+		bool m_built;
+		const Faction* m_noFaction;
+		std::vector<Claim> m_claims;
+		std::vector<Ownership> m_ownership;
+		std::map<std::pair<const Faction*, std::vector<const Faction*> >, Uint32> m_ownershipIndex;
+		Sint32 m_blockMin[3];
+		Sint32 m_blockCount[3];
+		std::vector<Uint32> m_blocks; // ownership index | UNIFORM_BLOCK, or offset into m_cells
+		std::vector<Uint32> m_cells;  // ownership index per sector of the non-uniform blocks
+		Uint32 m_outside;             // ownership of every sector outside the grid
+		std::vector<double> m_minDist; // scratch space for Classify
+	};
+
 	void ClearHomeSectors();
 	void SetHomeSectors();
 
@@ -129,7 +165,7 @@ private:
 	FactionList       m_factions;
 	FactionMap        m_factions_byName;
 	HomeSystemSet     m_homesystems;
-	Octsapling        m_spatial_index;
+	OwnershipGrid     m_ownership_grid;
 	bool              m_may_assign_factions;
 	bool              m_initialized = false;
 	MissingFactionsMap m_missingFactionsMap;
@@ -0,0 +1,396 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "FileSourcePack.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "miniz/miniz.h"
+}
+
+// the pack is laid out as
+//   Header
+//   each file's data, aligned to DATA_ALIGN (PAGE_ALIGN for textures)
+//   Entry[numEntries], a breadth first walk of the tree from the root, so
+//     that the entries in each directory are together, sorted by name
+//   Hash[numEntries], sorted by hash
+//   the paths of the entries, one after the other, unterminated
+// all in the byte order of the machine that wrote it, as the saved games are
+
+namespace FileSystem {
+
+static const char PACK_MAGIC[8] = { 'P', 'I', 'O', 'N', 'P', 'A', 'C', 'K' };
+static const Uint32 PACK_VERSION = 2;
+
+static const Uint64 DATA_ALIGN = 16;
+// for textures that can be uploaded straight out of the mapping
+static const Uint64 PAGE_ALIGN = 4096;
+
+// a file is only kept deflated if that saves at least this much of it
+static const size_t DEFLATE_MIN_SAVING = 8;	// ie 1/8
+
+enum EntryType {
+	ENTRY_FILE = 0,
+	ENTRY_DIR = 1
+};
+
+enum EntryFlags {
+	ENTRY_DEFLATED = 1
+};
+
+struct PackHeader {
+	char magic[8];
+	Uint32 version;
+	Uint32 numEntries;
+	Uint64 entriesOffset;
+	Uint64 hashesOffset;
+	Uint64 namesOffset;
+	Uint64 namesSize;
+	// the newest modification time (a Time::DateTime timestamp) of anything
+	// in the tree the pack was made from, to tell when it's out of date
+	Sint64 newestModTime;
+};
+
+struct FileSourcePack::Entry {
+	Uint64 offset;
+	Uint64 size;		// as read
+	Uint64 storedSize;	// as it is in the pack
+	Uint32 path;		// into the names
+	Uint32 pathLength;
+	Uint32 firstChild;	// directories only
+	Uint32 numChildren;
+	Uint32 type;
+	Uint32 flags;
+};
+
+struct FileSourcePack::Hash {
+	Uint64 hash;
+	Uint32 entry;
+	Uint32 padding;
+
+	bool operator<(const Hash &b) const { return hash < b.hash || (hash == b.hash && entry < b.entry); }
+};
+
+static_assert(sizeof(PackHeader) == 56, "pack header has padding");
+
+static Uint64 hash_path(const char *path, size_t length)
+{
+	return hash_fnv1a_64(path, length);
+}
+
+// the pack's own form of a path: normalised, with no leading separator
+static std::string pack_path(const std::string &path)
+{
+	std::string normal = NormalisePath(path);
+	if (!normal.empty() && normal[0] == '/')
+		normal.erase(0, 1);
+	return normal;
+}
+
+// files that are compressed already, or that want to be used in place
+static bool is_incompressible(const std::string &path)
+{
+	static const char *extensions[] = { ".png", ".jpg", ".jpeg", ".ogg", ".sgm", ".zip", ".dds" };
+	for (const char *ext : extensions) {
+		if (ends_with_ci(path, ext))
+			return true;
+	}
+	return false;
+}
+
+static bool is_texture(const std::string &path)
+{
+	return ends_with_ci(path, ".dds");
+}
+
+FileSourcePack::FileSourcePack(const std::string &packPath, bool trusted) :
+	FileSource(packPath, trusted),
+	m_entries(0),
+	m_hashes(0),
+	m_numEntries(0),
+	m_names(0),
+	m_newestModTime(0)
+{
+	static_assert(sizeof(Entry) == 48, "pack entry has padding");
+	static_assert(sizeof(Hash) == 16, "pack hash has padding");
+
+	const size_t slash = packPath.rfind('/');
+	FileSourceFS dir(slash == std::string::npos ? std::string(".") : packPath.substr(0, slash));
+	RefCountedPtr<FileData> pack = dir.ReadFile(slash == std::string::npos ? packPath : packPath.substr(slash + 1));
+	if (!pack)
+		return;
+
+	const char *base = pack->GetData();
+	const Uint64 size = pack->GetSize();
+
+	PackHeader header;
+	if (size < sizeof(header)) {
+		Output("FileSourcePack: '%s' is too short to be a pack\n", packPath.c_str());
+		return;
+	}
+	memcpy(&header, base, sizeof(header));
+	if (memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION) {
+		Output("FileSourcePack: '%s' is not a pack, or is from another version\n", packPath.c_str());
+		return;
+	}
+	if (header.numEntries == 0 ||
+		header.entriesOffset % 8 != 0 || header.entriesOffset + Uint64(header.numEntries) * sizeof(Entry) > size ||
+		header.hashesOffset % 8 != 0 || header.hashesOffset + Uint64(header.numEntries) * sizeof(Hash) > size ||
+		header.namesOffset + header.namesSize > size) {
+		Output("FileSourcePack: '%s' is corrupt\n", packPath.c_str());
+		return;
+	}
+
+	// lookups jump all over the tables
+	pack->Advise(FileData::ACCESS_RANDOM);
+
+	m_entries = reinterpret_cast<const Entry*>(base + header.entriesOffset);
+	m_hashes = reinterpret_cast<const Hash*>(base + header.hashesOffset);
+	m_numEntries = header.numEntries;
+	m_names = base + header.namesOffset;
+	m_newestModTime = header.newestModTime;
+
+	for (Uint32 i = 0; i < m_numEntries; i++) {
+		const Entry &e = m_entries[i];
+		if (Uint64(e.path) + e.pathLength > header.namesSize ||
+			(e.type == ENTRY_FILE && e.offset + e.storedSize > size) ||
+			(e.type == ENTRY_DIR && Uint64(e.firstChild) + e.numChildren > m_numEntries) ||
+			m_hashes[i].entry >= m_numEntries) {
+			Output("FileSourcePack: '%s' has a corrupt entry\n", packPath.c_str());
+			m_entries = 0;
+			m_hashes = 0;
+			m_numEntries = 0;
+			m_names = 0;
+			return;
+		}
+	}
+
+	m_pack = pack;
+}
+
+FileSourcePack::~FileSourcePack()
+{
+}
+
+bool FileSourcePack::IsStale(FileSource &source) const
+{
+	for (FileEnumerator files(source, "", FileEnumerator::IncludeDirs | FileEnumerator::Recurse); !files.Finished(); files.Next()) {
+		if (files.Current().GetModificationTime().GetTimestamp() > m_newestModTime)
+			return true;
+	}
+	return false;
+}
+
+const FileSourcePack::Entry *FileSourcePack::Find(const std::string &path) const
+{
+	if (!m_numEntries)
+		return 0;
+
+	const std::string p = pack_path(path);
+	Hash key;
+	key.hash = hash_path(p.c_str(), p.size());
+	key.entry = 0;
+	key.padding = 0;
+
+	// paths with the same hash are next to each other
+	for (const Hash *h = std::lower_bound(m_hashes, m_hashes + m_numEntries, key); h != m_hashes + m_numEntries && h->hash == key.hash; ++h) {
+		const Entry &e = m_entries[h->entry];
+		if (e.pathLength == p.size() && memcmp(m_names + e.path, p.c_str(), p.size()) == 0)
+			return &e;
+	}
+	return 0;
+}
+
+std::string FileSourcePack::GetPath(const Entry &entry) const
+{
+	return std::string(m_names + entry.path, entry.pathLength);
+}
+
+FileInfo FileSourcePack::MakeInfo(const Entry &entry)
+{
+	return MakeFileInfo(GetPath(entry), entry.type == ENTRY_DIR ? FileInfo::FT_DIR : FileInfo::FT_FILE);
+}
+
+FileInfo FileSourcePack::Lookup(const std::string &path)
+{
+	const Entry *e = Find(path);
+	if (!e)
+		return MakeFileInfo(path, FileInfo::FT_NON_EXISTENT);
+	return MakeInfo(*e);
+}
+
+RefCountedPtr<FileData> FileSourcePack::ReadFile(const std::string &path)
+{
+	const Entry *e = Find(path);
+	if (!e || e->type != ENTRY_FILE)
+		return RefCountedPtr<FileData>();
+
+	const char *src = m_pack->GetData() + e->offset;
+	if (!(e->flags & ENTRY_DEFLATED))
+		return RefCountedPtr<FileData>(new FileDataSlice(MakeInfo(*e), m_pack, src, e->size));
+
+	char *data = static_cast<char*>(std::malloc(e->size));
+	if (tinfl_decompress_mem_to_mem(data, e->size, src, e->storedSize, 0) != e->size) {
+		Output("FileSourcePack::ReadFile: couldn't inflate '%s'\n", path.c_str());
+		std::free(data);
+		return RefCountedPtr<FileData>();
+	}
+	return RefCountedPtr<FileData>(new FileDataMalloc(MakeInfo(*e), e->size, data));
+}
+
+bool FileSourcePack::ReadDirectory(const std::string &path, std::vector<FileInfo> &output)
+{
+	const Entry *e = Find(path);
+	if (!e || e->type != ENTRY_DIR)
+		return false;
+
+	output.reserve(output.size() + e->numChildren);
+	for (Uint32 i = e->firstChild; i < e->firstChild + e->numChildren; i++)
+		output.push_back(MakeInfo(m_entries[i]));
+	return true;
+}
+
+// fwrite, keeping count of where it's got to
+static bool write_bytes(FILE *out, const void *data, size_t size, Uint64 &pos)
+{
+	if (size && fwrite(data, 1, size, out) != size)
+		return false;
+	pos += size;
+	return true;
+}
+
+static bool write_padding(FILE *out, Uint64 align, Uint64 &pos)
+{
+	static const char zeros[PAGE_ALIGN] = {};
+	const Uint64 pad = (align - pos % align) % align;
+	return write_bytes(out, zeros, size_t(pad), pos);
+}
+
+bool FileSourcePack::Write(FileSource &source, FILE *out)
+{
+	// the tree, breadth first
+	std::vector<Entry> entries;
+	std::vector<std::string> paths;
+	std::vector<FileInfo> children;
+	Time::DateTime newest;
+
+	Entry root;
+	memset(&root, 0, sizeof(root));
+	root.type = ENTRY_DIR;
+	entries.push_back(root);
+	paths.push_back("");
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].type != ENTRY_DIR)
+			continue;
+		children.clear();
+		if (!source.ReadDirectory(paths[i], children)) {
+			Output("pack: couldn't read directory '%s'\n", paths[i].c_str());
+			return false;
+		}
+		std::sort(children.begin(), children.end(),
+			[](const FileInfo &a, const FileInfo &b) { return a.GetPath() < b.GetPath(); });
+
+		entries[i].firstChild = Uint32(entries.size());
+		for (const FileInfo &child : children) {
+			if (!child.IsFile() && !child.IsDir())
+				continue;
+			newest = std::max(newest, child.GetModificationTime());
+			Entry e;
+			memset(&e, 0, sizeof(e));
+			e.type = child.IsDir() ? ENTRY_DIR : ENTRY_FILE;
+			entries.push_back(e);
+			paths.push_back(pack_path(child.GetPath()));
+		}
+		entries[i].numChildren = Uint32(entries.size()) - entries[i].firstChild;
+	}
+
+	std::string names;
+	for (size_t i = 0; i < entries.size(); i++) {
+		entries[i].path = Uint32(names.size());
+		entries[i].pathLength = Uint32(paths[i].size());
+		names += paths[i];
+	}
+
+	PackHeader header;
+	memset(&header, 0, sizeof(header));
+	Uint64 pos = 0;
+	if (!write_bytes(out, &header, sizeof(header), pos))
+		return false;
+
+	Uint64 stored = 0, total = 0;
+	for (size_t i = 0; i < entries.size(); i++) {
+		Entry &e = entries[i];
+		if (e.type != ENTRY_FILE)
+			continue;
+
+		RefCountedPtr<FileData> data = source.ReadFile(paths[i]);
+		if (!data) {
+			Output("pack: couldn't read '%s'\n", paths[i].c_str());
+			return false;
+		}
+
+		const void *bytes = data->GetData();
+		size_t size = data->GetSize();
+		void *deflated = 0;
+		if (!is_incompressible(paths[i]) && size > 0) {
+			size_t deflatedSize = 0;
+			deflated = tdefl_compress_mem_to_heap(bytes, size, &deflatedSize, TDEFL_DEFAULT_MAX_PROBES);
+			if (deflated && deflatedSize <= size - size / DEFLATE_MIN_SAVING) {
+				bytes = deflated;
+				size = deflatedSize;
+				e.flags |= ENTRY_DEFLATED;
+			}
+		}
+
+		const bool ok = write_padding(out, is_texture(paths[i]) ? PAGE_ALIGN : DATA_ALIGN, pos);
+		e.offset = pos;
+		e.size = data->GetSize();
+		e.storedSize = size;
+		const bool written = ok && write_bytes(out, bytes, size, pos);
+		mz_free(deflated);
+		if (!written)
+			return false;
+
+		stored += size;
+		total += data->GetSize();
+	}
+
+	std::vector<Hash> hashes(entries.size());
+	for (size_t i = 0; i < entries.size(); i++) {
+		hashes[i].hash = hash_path(paths[i].c_str(), paths[i].size());
+		hashes[i].entry = Uint32(i);
+		hashes[i].padding = 0;
+	}
+	std::sort(hashes.begin(), hashes.end());
+
+	memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.version = PACK_VERSION;
+	header.numEntries = Uint32(entries.size());
+	header.newestModTime = newest.GetTimestamp();
+	if (!write_padding(out, 8, pos))
+		return false;
+	header.entriesOffset = pos;
+	if (!write_bytes(out, &entries[0], entries.size() * sizeof(Entry), pos))
+		return false;
+	header.hashesOffset = pos;
+	if (!write_bytes(out, &hashes[0], hashes.size() * sizeof(Hash), pos))
+		return false;
+	header.namesOffset = pos;
+	header.namesSize = names.size();
+	if (!write_bytes(out, names.data(), names.size(), pos))
+		return false;
+
+	// and now that everything's where it is, the header
+	if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1)
+		return false;
+
+	Output("pack: %u entries, %llu bytes of files stored in %llu\n", header.numEntries,
+		static_cast<unsigned long long>(total), static_cast<unsigned long long>(stored));
+	return true;
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _FILESOURCEPACK_H
+#define _FILESOURCEPACK_H
+
+#include "FileSystem.h"
+#include <SDL_stdinc.h>
+#include <cstdio>
+#include <string>
+
+namespace FileSystem {
+
+// A whole directory tree packed into one file (see Write), which is mapped
+// and used in place: the paths are found through a table of their hashes,
+// sorted so that it can be binary searched, and stored entries are handed
+// out as slices of the pack. The pack is never written to once it's open, so
+// it can be read from any number of threads.
+class FileSourcePack : public FileSource {
+public:
+	// opens the pack at packPath (a full path). if it isn't there, or isn't a
+	// pack, the source is empty and IsOpen answers false
+	FileSourcePack(const std::string &packPath, bool trusted = false);
+	virtual ~FileSourcePack();
+
+	bool IsOpen() const { return m_pack.Valid(); }
+
+	// answers true if anything in source (the tree the pack was made from)
+	// has been changed, added or removed since the pack was written. every
+	// file in source is looked at, so this is for debug builds only
+	bool IsStale(FileSource &source) const;
+
+	virtual FileInfo Lookup(const std::string &path);
+	virtual RefCountedPtr<FileData> ReadFile(const std::string &path);
+	virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
+
+	// packs everything in source into out. answers false if anything
+	// couldn't be read or written
+	static bool Write(FileSource &source, FILE *out);
+
+private:
+	struct Entry;
+	struct Hash;
+
+	const Entry *Find(const std::string &path) const;
+	std::string GetPath(const Entry &entry) const;
+	FileInfo MakeInfo(const Entry &entry);
+
+	RefCountedPtr<FileData> m_pack;
+	const Entry *m_entries;
+	const Hash *m_hashes;
+	Uint32 m_numEntries;
+	const char *m_names;
+	Sint64 m_newestModTime;
+};
+
+}
+
+#endif
@@ -13,41 +13,70 @@ extern "C" {
 
 namespace FileSystem {
 
-FileSourceZip::FileSourceZip(FileSourceFS &fs, const std::string &zipPath) : FileSource(zipPath), m_archive(0)
+// how many inflated entries to keep, and how much of them
+static const size_t CACHE_ENTRIES = 8;
+static const size_t CACHE_BYTES = 16 * 1024 * 1024;
+
+FileSourceZip::FileSourceZip(FileSourceFS &fs, const std::string &zipPath) : FileSource(zipPath), m_cacheBytes(0)
 {
-	mz_zip_archive *zip = static_cast<mz_zip_archive*>(std::calloc(1, sizeof(mz_zip_archive)));
-	FILE *file = fs.OpenReadStream(zipPath);
-	if (!mz_zip_reader_init_file_stream(zip, file, 0)) {
+	RefCountedPtr<FileData> archive = fs.ReadFile(zipPath);
+	mz_zip_archive zip;
+	memset(&zip, 0, sizeof(zip));
+	if (!archive || !mz_zip_reader_init_mem(&zip, archive->GetData(), archive->GetSize(), 0)) {
 		Output("FileSourceZip: unable to open '%s'\n", zipPath.c_str());
-		std::free(zip);
 		return;
 	}
 
+	const mz_uint8 *base = reinterpret_cast<const mz_uint8*>(archive->GetData());
+	const Uint64 archiveSize = archive->GetSize();
 	mz_zip_archive_file_stat zipStat;
 
-	Uint32 numFiles = mz_zip_reader_get_num_files(zip);
+	Uint32 numFiles = mz_zip_reader_get_num_files(&zip);
 	for (Uint32 i = 0; i < numFiles; i++) {
-		if (mz_zip_reader_file_stat(zip, i, &zipStat)) {
-			bool is_dir = mz_zip_reader_is_file_a_directory(zip, i);
-			if (!mz_zip_reader_is_file_encrypted(zip, i)) {
+		if (mz_zip_reader_file_stat(&zip, i, &zipStat)) {
+			bool is_dir = mz_zip_reader_is_file_a_directory(&zip, i);
+			if (!mz_zip_reader_is_file_encrypted(&zip, i)) {
 				std::string fname = zipStat.m_filename;
 				if ((fname.size() > 1) && (fname[fname.size()-1] == '/')) {
 					fname.resize(fname.size() - 1);
 				}
+
+				// find the data past the entry's local header now, so that
+				// reading it needs nothing but the offset
+				Uint64 offset = 0;
+				if (!is_dir) {
+					const Uint64 header = zipStat.m_local_header_ofs;
+					if (header + MZ_ZIP_LOCAL_DIR_HEADER_SIZE > archiveSize ||
+						MZ_READ_LE32(base + header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG) {
+						Output("FileSourceZip: '%s' in '%s' has a bad header\n", zipStat.m_filename, zipPath.c_str());
+						continue;
+					}
+					offset = header + MZ_ZIP_LOCAL_DIR_HEADER_SIZE +
+						MZ_READ_LE16(base + header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(base + header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+					if (offset + zipStat.m_comp_size > archiveSize) {
+						Output("FileSourceZip: '%s' in '%s' is truncated\n", zipStat.m_filename, zipPath.c_str());
+						continue;
+					}
+					if (zipStat.m_method != 0 && zipStat.m_method != MZ_DEFLATED) {
+						Output("FileSourceZip: '%s' in '%s' uses an unsupported compression method\n", zipStat.m_filename, zipPath.c_str());
+						continue;
+					}
+				}
+
 				AddFile(zipStat.m_filename, FileStat(i, zipStat.m_uncomp_size,
-					MakeFileInfo(fname, is_dir ? FileInfo::FT_DIR : FileInfo::FT_FILE)));
+					MakeFileInfo(fname, is_dir ? FileInfo::FT_DIR : FileInfo::FT_FILE),
+					offset, zipStat.m_comp_size, zipStat.m_method, zipStat.m_crc32));
 			}
 		}
 	}
 
-	m_archive = static_cast<void*>(zip);
+	// everything needed from the central directory is in m_root now
+	mz_zip_reader_end(&zip);
+	m_archive = archive;
 }
 
 FileSourceZip::~FileSourceZip()
 {
-	if (!m_archive) return;
-	mz_zip_archive *zip = static_cast<mz_zip_archive*>(m_archive);
-	mz_zip_reader_end(zip);
 }
 
 static void SplitPath(const std::string &path, std::vector<std::string> &output)
@@ -107,10 +136,41 @@ FileInfo FileSourceZip::Lookup(const std::string &path)
 	return (*i).second.info;
 }
 
+RefCountedPtr<FileData> FileSourceZip::FindCached(Uint32 index)
+{
+	std::lock_guard<std::mutex> lock(m_cacheLock);
+	for (auto i = m_cache.begin(); i != m_cache.end(); ++i) {
+		if (i->first == index) {
+			m_cache.splice(m_cache.begin(), m_cache, i);
+			return m_cache.front().second;
+		}
+	}
+	return RefCountedPtr<FileData>();
+}
+
+void FileSourceZip::AddCached(Uint32 index, const RefCountedPtr<FileData> &data)
+{
+	if (data->GetSize() > CACHE_BYTES)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_cacheLock);
+	// another thread may have inflated it at the same time
+	for (const auto &entry : m_cache) {
+		if (entry.first == index)
+			return;
+	}
+
+	m_cache.push_front(std::make_pair(index, data));
+	m_cacheBytes += data->GetSize();
+	while (m_cache.size() > CACHE_ENTRIES || m_cacheBytes > CACHE_BYTES) {
+		m_cacheBytes -= m_cache.back().second->GetSize();
+		m_cache.pop_back();
+	}
+}
+
 RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
 {
 	if (!m_archive) return RefCountedPtr<FileData>();
-	mz_zip_archive *zip = static_cast<mz_zip_archive*>(m_archive);
 
 	const Directory *dir;
 	std::string filename;
@@ -122,14 +182,30 @@ RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
 		return RefCountedPtr<FileData>();
 
 	const FileStat &st = (*i).second;
+	if (!st.info.IsFile())
+		return RefCountedPtr<FileData>();
+
+	const char *src = m_archive->GetData() + st.offset;
+	if (st.method == 0)
+		return RefCountedPtr<FileData>(new FileDataSlice(st.info, m_archive, src, st.size));
+
+	RefCountedPtr<FileData> cached = FindCached(st.index);
+	if (cached)
+		return cached;
 
 	char *data = static_cast<char*>(std::malloc(st.size));
-	if (!mz_zip_reader_extract_to_mem(zip, st.index, data, st.size, 0)) {
-		Output("FileSourceZip::ReadFile: couldn't extract '%s'\n", path.c_str());
-		return RefCountedPtr<FileData>();
+	if (st.size) {
+		const size_t size = tinfl_decompress_mem_to_mem(data, st.size, src, st.compSize, 0);
+		if (size != st.size || mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8*>(data), st.size) != st.crc) {
+			Output("FileSourceZip::ReadFile: couldn't extract '%s'\n", path.c_str());
+			std::free(data);
+			return RefCountedPtr<FileData>();
+		}
 	}
 
-	return RefCountedPtr<FileData>(new FileDataMalloc(st.info, st.size, data));
+	RefCountedPtr<FileData> inflated(new FileDataMalloc(st.info, st.size, data));
+	AddCached(st.index, inflated);
+	return inflated;
 }
 
 bool FileSourceZip::ReadDirectory(const std::string &path, std::vector<FileInfo> &output)
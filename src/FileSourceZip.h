@@ -6,15 +6,19 @@
 
 #include "FileSystem.h"
 #include <SDL_stdinc.h>
+#include <list>
 #include <map>
+#include <mutex>
 #include <string>
 
 namespace FileSystem {
 
+// Entries are read straight out of the archive, which is held in memory
+// (mapped, if it's big enough), so it is safe to read from several threads
+// at once. Stored entries are handed out in place, without a copy, and the
+// last few inflated entries are kept in case they're asked for again.
 class FileSourceZip : public FileSource {
 public:
-	// for now this needs to be FileSourceFS rather than just FileSource,
-	// because we need a FILE* stream access to the .zip file
 	FileSourceZip(FileSourceFS &fs, const std::string &zipPath);
 	virtual ~FileSourceZip();
 
@@ -23,13 +27,19 @@ public:
 	virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
 
 private:
-	void *m_archive;
+	RefCountedPtr<FileData> m_archive;
 
 	struct FileStat {
-		FileStat(Uint32 _index, Uint64 _size, const FileInfo &_info) : index(_index), size(_size), info(_info) {}
+		FileStat(Uint32 _index, Uint64 _size, const FileInfo &_info, Uint64 _offset = 0, Uint64 _compSize = 0, Uint32 _method = 0, Uint32 _crc = 0) :
+			index(_index), size(_size), info(_info), offset(_offset), compSize(_compSize), method(_method), crc(_crc) {}
 		const Uint32 index;
 		const Uint64 size;
 		const FileInfo info;
+		// where the (compressed) data starts in the archive, and how it's stored
+		const Uint64 offset;
+		const Uint64 compSize;
+		const Uint32 method;
+		const Uint32 crc;
 	};
 
 	struct Directory {
@@ -37,8 +47,18 @@ private:
 		std::map<std::string,FileStat> files;
 	};
 
+	// the directory is only written while the archive is being opened, so
+	// it can be read without a lock
 	Directory m_root;
 
+	// recently inflated entries, most recent first
+	std::mutex m_cacheLock;
+	std::list< std::pair<Uint32, RefCountedPtr<FileData> > > m_cache;
+	size_t m_cacheBytes;
+
+	RefCountedPtr<FileData> FindCached(Uint32 index);
+	void AddCached(Uint32 index, const RefCountedPtr<FileData> &data);
+
 	bool FindDirectoryAndFile(const std::string &path, const Directory* &dir, std::string &filename);
 	void AddFile(const std::string &path, const FileStat &fileStat);
 };
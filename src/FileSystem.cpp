@@ -3,7 +3,9 @@
 
 #include "libs.h"
 #include "FileSystem.h"
+#include "FileSourcePack.h"
 #include "StringRange.h"
+#include "utils.h"
 #include <cassert>
 #include <sstream>
 #include <algorithm>
@@ -14,6 +16,7 @@ namespace FileSystem {
 
 	static FileSourceFS dataFilesApp(GetDataDir(), true);
 	static FileSourceFS dataFilesUser(JoinPath(GetUserDir(), "data"));
+	static FileSourcePack *dataFilesPack = 0;
 	FileSourceUnion gameDataFiles;
 	FileSourceFS userFiles(GetUserDir());
 
@@ -119,14 +122,49 @@ namespace FileSystem {
 			return base;
 	}
 
+	std::string GetDataPackPath()
+	{
+		std::string path = GetDataDir();
+		while (path.size() > 1 && path[path.size()-1] == '/')
+			path.resize(path.size() - 1);
+		return path + ".pak";
+	}
+
 	void Init()
 	{
 		gameDataFiles.AppendSource(&dataFilesUser);
-		gameDataFiles.AppendSource(&dataFilesApp);
+
+		// a pack of the data directory, made by pioneer -pack, stands in for
+		// it. the user's data directory and mods still come first
+		if (!dataFilesPack)
+			dataFilesPack = new FileSourcePack(GetDataPackPath(), true);
+		bool usePack = dataFilesPack->IsOpen();
+#if defined(DEBUG) || defined(_DEBUG)
+		// debug builds (--enable-debug) are run against a data directory
+		// that's being edited, so if anything in it has changed since the
+		// pack was made it's used instead, and loose files win. other builds
+		// trust the pack, as walking the data directory is the startup cost
+		// the pack is there to save
+		if (usePack && dataFilesPack->IsStale(dataFilesApp)) {
+			Output("data pack '%s' is older than '%s', not using it (run pioneer -pack to update it)\n",
+				dataFilesPack->GetRoot().c_str(), dataFilesApp.GetRoot().c_str());
+			usePack = false;
+		}
+#endif
+		if (usePack) {
+			Output("using data pack '%s'\n", dataFilesPack->GetRoot().c_str());
+			gameDataFiles.AppendSource(dataFilesPack);
+		} else
+			gameDataFiles.AppendSource(&dataFilesApp);
 	}
 
 	void Uninit()
 	{
+		if (dataFilesPack) {
+			gameDataFiles.RemoveSource(dataFilesPack);
+			delete dataFilesPack;
+			dataFilesPack = 0;
+		}
 	}
 
 	FileInfo::FileInfo(FileSource *source, const std::string &path, FileType type, Time::DateTime modTime):
@@ -38,6 +38,9 @@ namespace FileSystem {
 
 	std::string GetUserDir();
 	std::string GetDataDir();
+	// where pioneer -pack puts the pack of the data directory, and where it's
+	// looked for: beside the data directory, with .pak added to its name
+	std::string GetDataPackPath();
 
 	/// Makes a string safe for use as a file name
 	/// warning: this mapping is non-injective, that is,
@@ -128,8 +131,18 @@ namespace FileSystem {
 
 	class FileData : public RefCounted {
 	public:
+		// how the data is going to be read
+		enum Access {
+			ACCESS_SEQUENTIAL,	// front to back, once (the default)
+			ACCESS_RANDOM		// a bit here and a bit there
+		};
+
 		virtual ~FileData() {}
 
+		// tells the source how the data is going to be read, so it can page
+		// it in accordingly. only mapped files do anything with it
+		virtual void Advise(Access access) const {}
+
 		const FileInfo &GetInfo() const { return m_info; }
 		size_t GetSize() const { return m_size; }
 		const char *GetData() const { assert(m_info.IsFile()); return m_data; }
@@ -155,6 +168,17 @@ namespace FileSystem {
 		virtual ~FileDataMalloc() { std::free(m_data); }
 	};
 
+	// part of another FileData (eg an entry in an archive), which it keeps
+	// alive, in place
+	class FileDataSlice : public FileData {
+	public:
+		FileDataSlice(const FileInfo &info, const RefCountedPtr<FileData> &whole, const char *data, size_t size):
+			FileData(info, size, const_cast<char*>(data)), m_whole(whole) {}
+
+	private:
+		RefCountedPtr<FileData> m_whole;
+	};
+
 	class FileSource {
 	public:
 		explicit FileSource(const std::string &root, bool trusted = false): m_root(root), m_trusted(trusted) {}
@@ -11,6 +11,63 @@
 #include "Game.h"
 #include "json/JsonUtils.h"
 #include <algorithm>
+#include <new>
+
+Uint64 Frame::s_version = 1;
+Uint64 Frame::s_interpVersion = 1;
+thread_local Uint32 Frame::s_cacheLookups = 0;
+thread_local Uint32 Frame::s_cacheHits = 0;
+
+// a direct mapped cache of results for pairs of frames. entries are stored
+// under the version current at the time, and only answer for that version.
+// the cache is plain data, zeroed like any static, so that a thread_local
+// one needs no constructor run (and checked for) on each use: versions
+// start at 1, so a zeroed entry never answers
+template <typename T>
+class RelToCache {
+public:
+	// answers the stored result for the pair, or nullptr
+	const T *Find(const Frame *from, const Frame *to, Uint64 version) {
+		Frame::s_cacheLookups++;
+		const Entry &e = m_entries[Slot(from, to)];
+		if (e.version != version || e.from != from || e.to != to)
+			return nullptr;
+		Frame::s_cacheHits++;
+		return reinterpret_cast<const T*>(e.value);
+	}
+
+	const T &Store(const Frame *from, const Frame *to, Uint64 version, const T &value) {
+		Entry &e = m_entries[Slot(from, to)];
+		e.from = from;
+		e.to = to;
+		e.version = version;
+		return *new (e.value) T(value);
+	}
+
+private:
+	static const size_t SIZE = 256;
+	static size_t Slot(const Frame *from, const Frame *to) {
+		const size_t a = reinterpret_cast<uintptr_t>(from) >> 4;
+		const size_t b = reinterpret_cast<uintptr_t>(to) >> 4;
+		return (a ^ (b * 31)) & (SIZE - 1);
+	}
+
+	// the vector and matrix types have constructors of their own, so the
+	// value is kept as bytes
+	struct Entry {
+		const Frame *from;
+		const Frame *to;
+		Uint64 version;
+		alignas(T) unsigned char value[sizeof(T)];
+	};
+	Entry m_entries[SIZE];
+};
+
+// per thread, as the RelTo calls are made from jobs as well as the main thread
+static thread_local RelToCache<vector3d> s_positionCache;
+static thread_local RelToCache<vector3d> s_interpPositionCache;
+static thread_local RelToCache<matrix3x3d> s_orientCache;
+static thread_local RelToCache<matrix3x3d> s_interpOrientCache;
 
 Frame::Frame()
 {
@@ -125,6 +182,9 @@ void Frame::Init(Frame *parent, const char *label, unsigned int flags)
 
 Frame::~Frame()
 {
+	// another frame may turn up at the same address
+	++s_version;
+	++s_interpVersion;
 	m_sfx.reset();
 	delete m_collisionSpace;
 	for (Frame* kid : m_children)
@@ -172,9 +232,11 @@ vector3d Frame::GetPositionRelTo(const Frame *relTo) const
 		else return (m_pos - relTo->m_pos) * relTo->m_orient;
 	}
 
+	if (const vector3d *cached = s_positionCache.Find(this, relTo, s_version))
+		return *cached;
 	vector3d diff = m_rootPos - relTo->m_rootPos;
-	if (relTo->IsRotFrame()) return diff * relTo->m_rootOrient;
-	else return diff;
+	if (relTo->IsRotFrame()) diff = diff * relTo->m_rootOrient;
+	return s_positionCache.Store(this, relTo, s_version, diff);
 }
 
 vector3d Frame::GetInterpPositionRelTo(const Frame *relTo) const
@@ -191,21 +253,27 @@ vector3d Frame::GetInterpPositionRelTo(const Frame *relTo) const
 		else return (m_interpPos - relTo->m_interpPos) * relTo->m_interpOrient;
 	}
 
+	if (const vector3d *cached = s_interpPositionCache.Find(this, relTo, s_interpVersion))
+		return *cached;
 	vector3d diff = m_rootInterpPos - relTo->m_rootInterpPos;
-	if (relTo->IsRotFrame()) return diff * relTo->m_rootInterpOrient;
-	else return diff;
+	if (relTo->IsRotFrame()) diff = diff * relTo->m_rootInterpOrient;
+	return s_interpPositionCache.Store(this, relTo, s_interpVersion, diff);
 }
 
 matrix3x3d Frame::GetOrientRelTo(const Frame *relTo) const
 {
 	if (this == relTo) return matrix3x3d::Identity();
-	return relTo->m_rootOrient.Transpose() * m_rootOrient;
+	if (const matrix3x3d *cached = s_orientCache.Find(this, relTo, s_version))
+		return *cached;
+	return s_orientCache.Store(this, relTo, s_version, relTo->m_rootOrient.Transpose() * m_rootOrient);
 }
 
 matrix3x3d Frame::GetInterpOrientRelTo(const Frame *relTo) const
 {
 	if (this == relTo) return matrix3x3d::Identity();
-	return relTo->m_rootInterpOrient.Transpose() * m_rootInterpOrient;
+	if (const matrix3x3d *cached = s_interpOrientCache.Find(this, relTo, s_interpVersion))
+		return *cached;
+	return s_interpOrientCache.Store(this, relTo, s_interpVersion, relTo->m_rootInterpOrient.Transpose() * m_rootInterpOrient);
 /*	if (IsRotFrame()) {
 		if (relTo->IsRotFrame()) return m_interpOrient * relTo->m_interpOrient.Transpose();
 		else return m_interpOrient;
@@ -227,6 +295,7 @@ void Frame::UpdateInterpTransform(double alpha)
 	}
 	else m_interpOrient = m_orient;
 
+	++s_interpVersion;
 	if (!m_parent) ClearMovement();
 	else {
 		m_rootInterpPos = m_parent->m_rootInterpOrient * m_interpPos
@@ -248,6 +317,7 @@ void Frame::GetFrameTransform(const Frame *fFrom, const Frame *fTo, matrix4x4d &
 void Frame::ClearMovement()
 {
 	UpdateRootRelativeVars();
+	++s_interpVersion;
 	m_rootInterpPos = m_rootPos;
 	m_rootInterpOrient = m_rootOrient;
 	m_oldPos = m_interpPos = m_pos;
@@ -305,6 +375,7 @@ void Frame::SetOrient(const matrix3x3d &m, double time) {
 
 void Frame::UpdateRootRelativeVars()
 {
+	++s_version;
 	// update pos & vel relative to parent frame
 	if (!m_parent) {
 		m_rootPos = m_rootVel = vector3d(0,0,0);
@@ -92,6 +92,16 @@ public:
 
 	static void GetFrameTransform(const Frame *fFrom, const Frame *fTo, matrix4x4d &m);
 
+	// the RelTo results that have to go through the root frame are kept
+	// until the frames next move, as the same pairs come up again and again.
+	// each thread has its own cache, so jobs can ask too, but frames may only
+	// be moved on the main thread while no such job is running.
+	// these count the calling thread's lookups, and how many it had answered
+	// from the cache
+	static Uint32 GetCacheLookups() { return s_cacheLookups; }
+	static Uint32 GetCacheHits() { return s_cacheHits; }
+	static void ClearCacheStats() { s_cacheLookups = s_cacheHits = 0; }
+
 	std::unique_ptr<SfxManager> m_sfx;			// the last survivor. actually m_children is pretty grim too.
 
 private:
@@ -125,6 +135,15 @@ private:
 	matrix3x3d m_rootInterpOrient;	// updated by UpdateInterpTransform
 
 	int m_astroBodyIndex; // deserialisation
+
+	// bumped whenever a frame's root relative (or interpolated) transform
+	// changes, or a frame goes away, to invalidate the cached results. only
+	// ever changed on the main thread, between jobs
+	static Uint64 s_version;
+	static Uint64 s_interpVersion;
+	static thread_local Uint32 s_cacheLookups;
+	static thread_local Uint32 s_cacheHits;
+	template <typename T> friend class RelToCache;
 };
 
 #endif /* _FRAME_H */
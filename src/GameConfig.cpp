@@ -34,6 +34,8 @@ GameConfig::GameConfig(const map_string &override_)
 	map["SectorViewZRotation"] = "0";
 	map["SectorViewZoom"] = "2.0";
 	map["MaxPhysicsCyclesPerRender"] = "4";
+	map["LuaEventBudget"] = "0"; // ms of Lua event handlers per physics tick, 0 = unlimited
+	map["LuaProfiler"] = "0";
 	map["AntiAliasingMode"] = "2";
 	map["JoystickDeadzone"] = "0.2"; // 20% deadzone is common
 	map["DefaultLowThrustPower"] = "0.25";
@@ -56,6 +58,7 @@ GameConfig::GameConfig(const map_string &override_)
 	map["EnableGLDebug"] = "0";
 	map["EnableGPUJobs"] = "1";
 	map["GL3ForwardCompatible"] = "1";
+	map["RecordRenderer"] = "0";
 
 	Load();
 
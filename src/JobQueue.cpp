@@ -2,7 +2,9 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "JobQueue.h"
+#include "RefCounted.h"
 #include "StringF.h"
+#include <thread>
 
 void Job::UnlinkHandle()
 {
@@ -442,3 +444,74 @@ Uint32 SyncJobQueue::RunJobs(Uint32 count)
 	}
 	return executed;
 }
+
+namespace {
+	// shared by the jobs of a batch, which may run (and find nothing left to
+	// do) after JobBatch::Run has returned
+	class BatchState : public RefCounted {
+	public:
+		BatchState(const JobBatch::Work &work, Uint32 count, Uint32 chunkSize) :
+			m_work(work), m_count(count), m_chunkSize(chunkSize),
+			m_numChunks((count + chunkSize - 1) / chunkSize), m_next(0), m_done(0) { }
+
+		// takes chunks until there are none left
+		void Work() {
+			for (;;) {
+				const Uint32 chunk = m_next++;
+				if (chunk >= m_numChunks)
+					return;
+				const Uint32 begin = chunk * m_chunkSize;
+				m_work(begin, std::min(begin + m_chunkSize, m_count));
+				++m_done;
+			}
+		}
+
+		bool IsDone() const { return m_done == m_numChunks; }
+		Uint32 GetNumChunks() const { return m_numChunks; }
+
+	private:
+		// only called for a chunk that was taken before the batch finished,
+		// while Run is still waiting
+		const JobBatch::Work &m_work;
+		const Uint32 m_count;
+		const Uint32 m_chunkSize;
+		const Uint32 m_numChunks;
+		std::atomic<Uint32> m_next;
+		std::atomic<Uint32> m_done;
+	};
+
+	class BatchJob : public Job {
+	public:
+		BatchJob(BatchState *state) : m_state(state) { }
+		virtual void OnRun() override { m_state->Work(); }
+		virtual void OnFinish() override { }
+	private:
+		RefCountedPtr<BatchState> m_state;
+	};
+}
+
+//static
+void JobBatch::Run(AsyncJobQueue *queue, Uint32 count, Uint32 chunkSize, const Work &work)
+{
+	PROFILE_SCOPED()
+	if (!count)
+		return;
+	assert(chunkSize > 0);
+
+	RefCountedPtr<BatchState> state(new BatchState(work, count, chunkSize));
+
+	// one helper per runner at most, the calling thread makes up the rest.
+	// helpers that don't get to run before the batch is done are cancelled
+	// when their handles go
+	std::vector<Job::Handle> helpers;
+	const Uint32 numHelpers = std::min(queue->GetNumRunners(), state->GetNumChunks() - 1);
+	helpers.reserve(numHelpers);
+	for (Uint32 i = 0; i < numHelpers; i++)
+		helpers.push_back(queue->Queue(new BatchJob(state.Get())));
+
+	state->Work();
+
+	// the last chunks may still be running elsewhere
+	while (!state->IsDone())
+		std::this_thread::yield();
+}
@@ -6,6 +6,7 @@
 
 #include <cassert>
 #include <deque>
+#include <functional>
 #include <vector>
 #include <set>
 #include <string>
@@ -155,6 +156,8 @@ public:
 	// finished jobs (not cancelled)
 	virtual Uint32 FinishJobs() override;
 
+	Uint32 GetNumRunners() const { return static_cast<Uint32>(m_runners.size()); }
+
 private:
 	// a runner wraps a single thread, and calls into the queue when its ready for
 	// a new job. no user-servicable parts inside!
@@ -259,4 +262,17 @@ private:
 	std::set<Job::Handle> m_jobs;
 };
 
+// splits a batch of items into chunks, and works through them on the queue's
+// threads and the calling thread at once. Run returns once every chunk is
+// done, so the work may use the caller's data. the calling thread takes
+// chunks too, so a queue that's busy with long jobs only costs parallelism.
+//
+// each item is handed to exactly one call of work, so as long as work only
+// writes to its own items the result doesn't depend on which thread ran what
+class JobBatch {
+public:
+	typedef std::function<void(Uint32 begin, Uint32 end)> Work;
+	static void Run(AsyncJobQueue *queue, Uint32 count, Uint32 chunkSize, const Work &work);
+};
+
 #endif
@@ -30,6 +30,32 @@ static int l_dev_set_camera_offset(lua_State *l)
 	return 0;
 }
 
+/*
+ * Start the Lua sampling profiler, see LuaProfiler.h
+ *
+ * Dev.StartLuaProfiler()
+ */
+static int l_dev_start_lua_profiler(lua_State *l)
+{
+	Lua::manager->GetProfiler().Start(Lua::manager->GetLuaState());
+	return 0;
+}
+
+/*
+ * Stop the Lua profiler and write its output to the user directory.
+ * Returns the path of the flame graph input file.
+ *
+ * path = Dev.StopLuaProfiler()
+ */
+static int l_dev_stop_lua_profiler(lua_State *l)
+{
+	const std::string path = Lua::manager->GetProfiler().Stop(Lua::manager->GetLuaState());
+	if (path.empty())
+		return 0;
+	lua_pushlstring(l, path.c_str(), path.size());
+	return 1;
+}
+
 void LuaDev::Register()
 {
 	lua_State *l = Lua::manager->GetLuaState();
@@ -38,6 +64,8 @@ void LuaDev::Register()
 
 	static const luaL_Reg methods[]= {
 		{ "SetCameraOffset", l_dev_set_camera_offset },
+		{ "StartLuaProfiler", l_dev_start_lua_profiler },
+		{ "StopLuaProfiler", l_dev_stop_lua_profiler },
 		{ 0, 0 }
 	};
 
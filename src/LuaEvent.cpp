@@ -42,13 +42,26 @@ void Clear()
 	LUA_DEBUG_END(l, 0);
 }
 
-void Emit()
+// real time in seconds, for handler timing and the dispatch budget
+static int l_event_clock(lua_State *l)
+{
+	static const double period = 1.0 / double(SDL_GetPerformanceFrequency());
+	lua_pushnumber(l, double(SDL_GetPerformanceCounter()) * period);
+	return 1;
+}
+
+void Emit(double budgetMs)
 {
 	lua_State *l = Lua::manager->GetLuaState();
 
 	LUA_DEBUG_START(l);
 	if (!_get_method_onto_stack(l, "_Emit")) return;
-	pi_lua_protected_call(l, 0, 0);
+	lua_pushcfunction(l, l_event_clock);
+	if (budgetMs > 0.0)
+		lua_pushnumber(l, budgetMs * 0.001);
+	else
+		lua_pushnil(l);
+	pi_lua_protected_call(l, 2, 0);
 	LUA_DEBUG_END(l, 0);
 }
 
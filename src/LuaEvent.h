@@ -71,7 +71,11 @@ namespace LuaEvent {
 	};
 
 	void Clear();
-	void Emit();
+
+	// Dispatch queued events to their handlers. With a budget (in
+	// milliseconds) dispatch stops once that much time has been spent, and
+	// the remaining handlers run, in order, on the next call.
+	void Emit(double budgetMs = 0.0);
 
 	void Queue(const char *event, const ArgsBase &args);
 
@@ -7,13 +7,30 @@
 
 bool instantiated = false;
 
-LuaManager::LuaManager() : m_lua(0) {
+// heap growth (percent of the size after the last cycle) before the
+// scheduler starts a new cycle
+static const int GC_PAUSE = 150;
+// the automatic collector only runs as a backstop once the scheduler is in
+// use, so its pause is set well above ours
+static const int GC_BACKSTOP_PAUSE = 300;
+// KB of allocation each scheduled step accounts for
+static const int GC_STEP_KB = 32;
+static const int GC_IDLE_STEP_KB = 512;
+
+LuaManager::LuaManager() :
+	m_lua(0),
+	m_allocCount(0),
+	m_gcScheduled(false),
+	m_gcInCycle(false),
+	m_gcThreshold(0),
+	m_gcTimeMs(0.0)
+{
 	if (instantiated) {
 		Output("Can't instantiate more than one LuaManager");
 		abort();
 	}
 
-	m_lua = luaL_newstate();
+	m_lua = lua_newstate(&LuaManager::Allocator, this);
 	pi_lua_open_standard_base(m_lua);
 	lua_atpanic(m_lua, pi_lua_panic);
 
@@ -21,11 +38,27 @@ LuaManager::LuaManager() : m_lua(0) {
 }
 
 LuaManager::~LuaManager() {
+	m_profiler.Stop(m_lua);
 	lua_close(m_lua);
 
 	instantiated = false;
 }
 
+// same as the default luaL_newstate allocator, but counts allocations and
+// reports them to the profiler
+void *LuaManager::Allocator(void *ud, void *ptr, size_t osize, size_t nsize) {
+	if (nsize == 0) {
+		free(ptr);
+		return 0;
+	}
+	LuaManager *manager = static_cast<LuaManager*>(ud);
+	manager->m_allocCount++;
+	// for new blocks osize is the object type rather than a size
+	if (manager->m_profiler.IsRunning() && (!ptr || nsize > osize))
+		manager->m_profiler.AccountAllocation(ptr ? nsize - osize : nsize);
+	return realloc(ptr, nsize);
+}
+
 size_t LuaManager::GetMemoryUsage() const {
 	int kb = lua_gc(m_lua, LUA_GCCOUNT, 0);
 	int b = lua_gc(m_lua, LUA_GCCOUNTB, 0);
@@ -35,3 +68,31 @@ size_t LuaManager::GetMemoryUsage() const {
 void LuaManager::CollectGarbage() {
 	lua_gc(m_lua, LUA_GCCOLLECT, 0);
 }
+
+void LuaManager::StepGarbageCollector(double slackMs, bool idle) {
+	m_gcTimeMs = 0.0;
+
+	if (!m_gcScheduled) {
+		lua_gc(m_lua, LUA_GCSETPAUSE, GC_BACKSTOP_PAUSE);
+		m_gcThreshold = GetMemoryUsage() * GC_PAUSE / 100;
+		m_gcScheduled = true;
+	}
+
+	if (!m_gcInCycle) {
+		if (GetMemoryUsage() < m_gcThreshold)
+			return;
+		m_gcInCycle = true;
+	}
+
+	const Uint64 start = SDL_GetPerformanceCounter();
+	const double msPerCount = 1000.0 / double(SDL_GetPerformanceFrequency());
+	const int stepKB = idle ? GC_IDLE_STEP_KB : GC_STEP_KB;
+	do {
+		if (lua_gc(m_lua, LUA_GCSTEP, stepKB)) {
+			// cycle complete, wait for the heap to grow again
+			m_gcInCycle = false;
+			m_gcThreshold = GetMemoryUsage() * GC_PAUSE / 100;
+		}
+		m_gcTimeMs = double(SDL_GetPerformanceCounter() - start) * msPerCount;
+	} while (m_gcInCycle && m_gcTimeMs < slackMs);
+}
@@ -5,6 +5,7 @@
 #define _LUAMANAGER_H
 
 #include "LuaUtils.h"
+#include "LuaProfiler.h"
 
 class LuaManager {
 public:
@@ -15,11 +16,35 @@ public:
 	size_t GetMemoryUsage() const;
 	void CollectGarbage();
 
+	// Incremental collection scheduled by the main loop. Once the heap has
+	// grown past the pause threshold, each call runs collector steps until
+	// the cycle finishes or slackMs (the time left in the frame) is used up,
+	// but always at least one step so a cycle can't stall. idle selects
+	// larger steps, for when the game is paused or docked.
+	void StepGarbageCollector(double slackMs, bool idle);
+	// milliseconds spent in the last StepGarbageCollector call
+	double GetCollectionTime() const { return m_gcTimeMs; }
+
+	// total number of (re)allocations made by the Lua state so far; sample
+	// it once per frame to get the per-frame allocation rate
+	Uint64 GetAllocationCount() const { return m_allocCount; }
+
+	LuaProfiler &GetProfiler() { return m_profiler; }
+
 private:
 	LuaManager(const LuaManager &);
 	LuaManager &operator=(const LuaManager &);
 
+	static void *Allocator(void *ud, void *ptr, size_t osize, size_t nsize);
+
 	lua_State *m_lua;
+	Uint64 m_allocCount;
+	LuaProfiler m_profiler;
+
+	bool m_gcScheduled;
+	bool m_gcInCycle;
+	size_t m_gcThreshold;
+	double m_gcTimeMs;
 };
 
 #endif
@@ -7,6 +7,8 @@
 #include "PropertiedObject.h"
 #include "PropertyMap.h"
 
+#include <bitset>
+#include <deque>
 #include <map>
 #include <utility>
 
@@ -93,17 +95,33 @@
 // singleton is. This will cause LuaObject to crash during garbage collection
 static bool instantiated = false;
 
-static std::map< std::string, std::map<std::string,PromotionTest> > *promotions;
+// every lua type gets a small integer id, and the set of the ids of the types
+// it inherits from (itself included), so that Isa is a bit test rather than
+// a walk up the metatables in the registry
+static const int MAX_TYPES = 256;
+struct TypeInfo {
+	std::string name;
+	int parent; // -1 for none
+	std::bitset<MAX_TYPES> ancestry;
+	// tests to run when an object of this type is pushed, in target name order
+	std::vector< std::pair<int,PromotionTest> > promotions;
+};
+
+// a deque so that the names stay put as types are added
+static std::deque<TypeInfo> *types;
+static std::map< std::string, int > *typeIds;
 static std::map< std::string, SerializerPair > *serializers;
 
 static void _teardown() {
-	delete promotions;
+	delete types;
+	delete typeIds;
 	delete serializers;
 }
 
 static inline void _instantiate() {
 	if (!instantiated) {
-		promotions = new std::map< std::string, std::map<std::string,PromotionTest> >;
+		types = new std::deque<TypeInfo>;
+		typeIds = new std::map< std::string, int >;
 		serializers = new std::map< std::string, SerializerPair >;
 
 		// XXX atexit is not a very nice way to deal with this in C++
@@ -529,6 +547,38 @@ void LuaObjectBase::CreateObject(const luaL_Reg *methods, const luaL_Reg *attrs,
 	LUA_DEBUG_END(l, 1);
 }
 
+int LuaObjectBase::GetTypeId(const char *type)
+{
+	_instantiate();
+
+	auto i = typeIds->find(type);
+	if (i != typeIds->end())
+		return i->second;
+
+	const int id = static_cast<int>(types->size());
+	assert(id < MAX_TYPES);
+	types->push_back(TypeInfo());
+	TypeInfo &info = types->back();
+	info.name = type;
+	info.parent = -1;
+	info.ancestry.set(id);
+	typeIds->insert(std::make_pair(info.name, id));
+	return id;
+}
+
+// classes needn't be created after their parents, so the sets are worked out
+// again for all the types each time one is
+static void update_ancestry()
+{
+	for (int id = 0; id < int(types->size()); id++) {
+		TypeInfo &info = (*types)[id];
+		info.ancestry.reset();
+		info.ancestry.set(id);
+		for (int parent = info.parent; parent >= 0 && !info.ancestry.test(parent); parent = (*types)[parent].parent)
+			info.ancestry.set(parent);
+	}
+}
+
 void LuaObjectBase::CreateClass(const char *type, const char *parent, const luaL_Reg *methods, const luaL_Reg *attrs, const luaL_Reg *meta)
 {
 	assert(type);
@@ -537,6 +587,9 @@ void LuaObjectBase::CreateClass(const char *type, const char *parent, const luaL
 
 	_instantiate();
 
+	(*types)[GetTypeId(type)].parent = parent ? GetTypeId(parent) : -1;
+	update_ancestry();
+
 	LUA_DEBUG_START(l);
 
 	// create the object registry if it doesn't already exist. this is the
@@ -685,29 +738,19 @@ void LuaObjectBase::Register(LuaObjectBase *lo)
 	assert(instantiated);
 	assert(lo->GetObject());
 
-	bool have_promotions = true;
-	bool tried_promote = false;
-
-	while (have_promotions && !tried_promote) {
-		std::map< std::string, std::map<std::string,PromotionTest> >::const_iterator base_iter = promotions->find(lo->m_type);
-		if (base_iter != promotions->end()) {
-			tried_promote = true;
-
-			for (
-				std::map<std::string,PromotionTest>::const_iterator target_iter = (*base_iter).second.begin();
-				target_iter != (*base_iter).second.end();
-				++target_iter)
-			{
-				if ((*target_iter).second(lo->GetObject())) {
-					lo->m_type = (*target_iter).first.c_str();
-					tried_promote = false;
-				}
+	// keep promoting until the object's type has no test it passes
+	for (;;) {
+		const int base = lo->m_typeId;
+		const TypeInfo &info = (*types)[base];
+		for (const auto &promotion : info.promotions) {
+			if (promotion.second(lo->GetObject())) {
+				lo->m_typeId = promotion.first;
+				lo->m_type = (*types)[promotion.first].name.c_str();
 			}
-
-			assert(lo->Isa((*base_iter).first.c_str()));
 		}
-		else
-			have_promotions = false;
+		if (lo->m_typeId == base)
+			break;
+		assert(lo->Isa(base));
 	}
 
 	lua_State *l = Lua::manager->GetLuaState();
@@ -800,7 +843,7 @@ void LuaObjectBase::Deregister(LuaObjectBase *lo)
 	return;
 }
 
-LuaWrappable *LuaObjectBase::CheckFromLua(int index, const char *type)
+LuaWrappable *LuaObjectBase::CheckFromLua(int index, int typeId)
 {
 	assert(instantiated);
 
@@ -815,14 +858,14 @@ LuaWrappable *LuaObjectBase::CheckFromLua(int index, const char *type)
 		return 0;
 	}
 
-	if (!lo->Isa(type))
-		luaL_error(l, "Object on stack has type %s which can not be used as type %s\n", lo->m_type, type);
+	if (!lo->Isa(typeId))
+		luaL_error(l, "Object on stack has type %s which can not be used as type %s\n", lo->m_type, (*types)[typeId].name.c_str());
 
 	// found it
 	return o;
 }
 
-LuaWrappable *LuaObjectBase::GetFromLua(int index, const char *type)
+LuaWrappable *LuaObjectBase::GetFromLua(int index, int typeId)
 {
 	assert(instantiated);
 
@@ -837,7 +880,7 @@ LuaWrappable *LuaObjectBase::GetFromLua(int index, const char *type)
 	if (!o)
 		return 0;
 
-	if (!lo->Isa(type))
+	if (!lo->Isa(typeId))
 		return 0;
 
 	// found it
@@ -846,44 +889,30 @@ LuaWrappable *LuaObjectBase::GetFromLua(int index, const char *type)
 
 bool LuaObjectBase::Isa(const char *base) const
 {
-	// fast path
-	if (strcmp(m_type, base) == 0)
-		return true;
-
 	assert(instantiated);
 
-	lua_State *l = Lua::manager->GetLuaState();
-
-	LUA_DEBUG_START(l);
-
-	lua_pushstring(l, m_type);
-	while (strcmp(lua_tostring(l, -1), base) != 0) {
-		// get the metatable for the current type
-		lua_rawget(l, LUA_REGISTRYINDEX);
-
-		// get the name of the parent type
-		lua_pushstring(l, "parent");
-		lua_rawget(l, -2);
-
-		// if it doesn't have a parent then we can go no further
-		if (lua_isnil(l, -1)) {
-			lua_pop(l, 2);
-			LUA_DEBUG_END(l, 0);
-			return false;
-		}
-
-		lua_remove(l, -2);
-	}
-	lua_pop(l, 1);
-
-	LUA_DEBUG_END(l, 0);
+	auto i = typeIds->find(base);
+	return i != typeIds->end() && Isa(i->second);
+}
 
-	return true;
+bool LuaObjectBase::Isa(int baseId) const
+{
+	return (*types)[m_typeId].ancestry.test(baseId);
 }
 
 void LuaObjectBase::RegisterPromotion(const char *base_type, const char *target_type, PromotionTest test_fn)
 {
-	(*promotions)[base_type][target_type] = test_fn;
+	const int target = GetTypeId(target_type);
+	std::vector< std::pair<int,PromotionTest> > &promotions = (*types)[GetTypeId(base_type)].promotions;
+
+	// tested in order of the target's name, as they always have been
+	auto i = promotions.begin();
+	while (i != promotions.end() && (*types)[i->first].name < (*types)[target].name)
+		++i;
+	if (i != promotions.end() && i->first == target)
+		i->second = test_fn;
+	else
+		promotions.insert(i, std::make_pair(target, test_fn));
 }
 
 void LuaObjectBase::RegisterSerializer(const char *type, SerializerPair pair)
@@ -107,7 +107,7 @@ public:
 
 protected:
 	// base class constructor, called by the wrapper Push* methods
-	LuaObjectBase(const char *type) : m_type(type) {};
+	LuaObjectBase(const char *type, int typeId) : m_type(type), m_typeId(typeId) {};
 	virtual ~LuaObjectBase() {}
 
 	// creates a class in the lua vm with the given name and attaches the
@@ -131,13 +131,17 @@ protected:
 	// the mapping matches first, to protect against memory being reused
 	static void Deregister(LuaObjectBase *lo);
 
+	// answers the id for a lua type string, giving it one if it doesn't
+	// have one yet. ids are what the type checks below work with
+	static int GetTypeId(const char *type);
+
 	// pulls an object off the lua stack and returns its associated c++
-	// object. type is the lua type string of the object. a lua exception is
-	// triggered if the object on the stack is not of this type
-	static LuaWrappable *CheckFromLua(int index, const char *type);
+	// object. typeId is the id of the lua type of the object. a lua exception
+	// is triggered if the object on the stack is not of this type
+	static LuaWrappable *CheckFromLua(int index, int typeId);
 
 	// does exactly the same as Check without triggering exceptions
-	static LuaWrappable *GetFromLua(int index, const char *type);
+	static LuaWrappable *GetFromLua(int index, int typeId);
 
 	// register a promotion test. when an object with lua type base_type is
 	// pushed, test_fn will be called. if it returns true then the created lua
@@ -191,9 +195,11 @@ private:
 
     // determine if the object has a class in its ancestry
     bool Isa(const char *base) const;
+	bool Isa(int baseId) const;
 
 	// lua type (ie method/metatable name)
 	const char *m_type;
+	int m_typeId;
 };
 
 
@@ -228,7 +234,7 @@ public:
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wundefined-var-template"
 #endif
-		return dynamic_cast<T*>(LuaObjectBase::CheckFromLua(idx, s_type));
+		return dynamic_cast<T*>(LuaObjectBase::CheckFromLua(idx, TypeId()));
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -241,7 +247,7 @@ public:
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wundefined-var-template"
 #endif
-		return dynamic_cast<T*>(LuaObjectBase::GetFromLua(idx, s_type));
+		return dynamic_cast<T*>(LuaObjectBase::GetFromLua(idx, TypeId()));
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -258,7 +264,7 @@ protected:
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wundefined-var-template"
 #endif
-	LuaObject() : LuaObjectBase(s_type) {}
+	LuaObject() : LuaObjectBase(s_type, TypeId()) {}
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
@@ -267,6 +273,19 @@ private:
 	// initial lua type string. defined in a specialisation in the appropriate
 	// .cpp file
 	static const char *s_type;
+
+	// s_type's id, looked up once
+	static int TypeId() {
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wundefined-var-template"
+#endif
+		static const int typeId = LuaObjectBase::GetTypeId(s_type);
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+		return typeId;
+	}
 };
 
 // wrapper for a "core" object - one owned by c++ (eg Body).
@@ -18,28 +18,70 @@
 // undef it, to avoid including yet another header that undefs it
 #undef RegisterClass
 
-template<typename Type>
-static Type parse_imgui_flags(lua_State *l, int index, std::map<std::string, Type> table, std::string name) {
-	LuaTable flags(l, index);
-	Type theflags = Type(0);
-	for(LuaTable::VecIter<std::string> iter = flags.Begin<std::string>(); iter != flags.End<std::string>(); ++iter) {
-		std::string flag = *iter;
-		if(table.find(flag) != table.end())
-			theflags = static_cast<Type>(theflags | table.at(flag));
-		else
-			Error("Unknown %s %s\n", name.c_str(), flag.c_str());
+// Maps the strings Lua passes for imgui flags and enums to their values.
+// The name -> value table is built in the Lua registry the first time a
+// given state asks for it (keyed by the address of the LuaFlags object), so
+// resolving a flag is a single rawget on an already interned Lua string
+// instead of building std::strings and copying a std::map per widget call.
+template <typename Type>
+class LuaFlags {
+public:
+	LuaFlags(const char *typeName, std::initializer_list<std::pair<const char *, Type>> init) :
+		m_lut(init), m_typeName(typeName) {}
+
+	// combine an array of flag names into a bit mask
+	Type CheckFlags(lua_State *l, int index) const {
+		index = lua_absindex(l, index);
+		luaL_checktype(l, index, LUA_TTABLE);
+		PushLookupTable(l);
+		Type theflags = Type(0);
+		const int n = lua_rawlen(l, index);
+		for (int i = 1; i <= n; ++i) {
+			lua_rawgeti(l, index, i);
+			lua_rawget(l, -2);
+			if (!lua_isnumber(l, -1)) {
+				lua_rawgeti(l, index, i);
+				Error("Unknown %s %s\n", m_typeName, lua_tostring(l, -1));
+			}
+			theflags = static_cast<Type>(theflags | lua_tointeger(l, -1));
+			lua_pop(l, 1);
+		}
+		lua_pop(l, 1);
+		return theflags;
 	}
-	return theflags;
-}
 
-template <typename Type>
-static Type parse_imgui_enum(lua_State *l, int index, std::map<std::string, Type> table, std::string name) {
-	std::string stylestr = LuaPull<std::string>(l, index);
-	if(table.find(stylestr) != table.end())
-		return table.at(stylestr);
-	else
-		Error("Unknown %s %s\n", name.c_str(), stylestr.c_str());
-}
+	// look up a single enum value by name
+	Type CheckEnum(lua_State *l, int index) const {
+		index = lua_absindex(l, index);
+		luaL_checktype(l, index, LUA_TSTRING);
+		PushLookupTable(l);
+		lua_pushvalue(l, index);
+		lua_rawget(l, -2);
+		if (!lua_isnumber(l, -1))
+			Error("Unknown %s %s\n", m_typeName, lua_tostring(l, index));
+		const Type value = static_cast<Type>(lua_tointeger(l, -1));
+		lua_pop(l, 2);
+		return value;
+	}
+
+private:
+	void PushLookupTable(lua_State *l) const {
+		lua_rawgetp(l, LUA_REGISTRYINDEX, this);
+		if (lua_istable(l, -1))
+			return;
+		lua_pop(l, 1);
+		lua_createtable(l, 0, int(m_lut.size()));
+		for (const auto &entry : m_lut) {
+			lua_pushinteger(l, entry.second);
+			lua_setfield(l, -2, entry.first);
+		}
+		lua_pushvalue(l, -1);
+		lua_rawsetp(l, LUA_REGISTRYINDEX, this);
+	}
+
+	const std::vector<std::pair<const char *, Type>> m_lut;
+	const char *m_typeName;
+};
 
 void *pi_lua_checklightuserdata(lua_State *l, int index) {
 	if(lua_islightuserdata(l, index))
@@ -88,19 +130,17 @@ int pushOnScreenPositionDirection(lua_State *l, vector3d position)
 	return 3;
 }
 
-static std::map<std::string, ImGuiSelectableFlags_> imguiSelectableFlagsTable
-= {
+static const LuaFlags<ImGuiSelectableFlags_> imguiSelectableFlagsTable("ImGuiSelectableFlags", {
 	{ "DontClosePopups", ImGuiSelectableFlags_DontClosePopups },
 	{ "SpanAllColumns", ImGuiSelectableFlags_SpanAllColumns },
 	{ "AllowDoubleClick", ImGuiSelectableFlags_AllowDoubleClick }
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiSelectableFlags_ &theflags) {
-	theflags = parse_imgui_flags(l, index, imguiSelectableFlagsTable, "ImGuiSelectableFlags");
+	theflags = imguiSelectableFlagsTable.CheckFlags(l, index);
 }
 
-static std::map<std::string, ImGuiInputTextFlags_> imguiInputTextFlagsTable
-= {
+static const LuaFlags<ImGuiInputTextFlags_> imguiInputTextFlagsTable("ImGuiInputTextFlags", {
 	{ "CharsDecimal", ImGuiInputTextFlags_CharsDecimal },
 	{ "CharsHexadecimal", ImGuiInputTextFlags_CharsHexadecimal },
 	{ "CharsUppercase", ImGuiInputTextFlags_CharsUppercase },
@@ -117,26 +157,24 @@ static std::map<std::string, ImGuiInputTextFlags_> imguiInputTextFlagsTable
 	{ "AlwaysInsertMode", ImGuiInputTextFlags_AlwaysInsertMode },
 	{ "ReadOnly", ImGuiInputTextFlags_ReadOnly },
 	{ "Password", ImGuiInputTextFlags_Password }
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiInputTextFlags_ &theflags) {
-	theflags = parse_imgui_flags(l, index, imguiInputTextFlagsTable, "ImGuiInputTextFlagsTable");
+	theflags = imguiInputTextFlagsTable.CheckFlags(l, index);
 }
 
-static std::map<std::string, ImGuiSetCond_> imguiSetCondTable
-= {
+static const LuaFlags<ImGuiSetCond_> imguiSetCondTable("ImGuiSetCond", {
 	{ "Always", ImGuiSetCond_Always },
 	{ "Once", ImGuiSetCond_Once },
 	{ "FirstUseEver", ImGuiSetCond_FirstUseEver },
 	{ "Appearing", ImGuiSetCond_Appearing }
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiSetCond_ &value) {
-	value = parse_imgui_enum(l, index, imguiSetCondTable, "ImGuiSetCond");
+	value = imguiSetCondTable.CheckEnum(l, index);
 }
 
-static std::map<std::string, ImGuiCol_> imguiColTable
-= {
+static const LuaFlags<ImGuiCol_> imguiColTable("ImGuiCol", {
 	{"Text", ImGuiCol_Text},
 	{"TextDisabled", ImGuiCol_TextDisabled},
 	{"WindowBg", ImGuiCol_WindowBg},
@@ -180,14 +218,13 @@ static std::map<std::string, ImGuiCol_> imguiColTable
 	{"PlotHistogramHovered", ImGuiCol_PlotHistogramHovered},
 	{"TextSelectedBg", ImGuiCol_TextSelectedBg},
 	{"ModalWindowDarkening", ImGuiCol_ModalWindowDarkening}
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiCol_ &value) {
-	value = parse_imgui_enum(l, index, imguiColTable, "ImGuiCol");
+	value = imguiColTable.CheckEnum(l, index);
 }
 
-static std::map<std::string, ImGuiStyleVar_> imguiStyleVarTable
-= {
+static const LuaFlags<ImGuiStyleVar_> imguiStyleVarTable("ImGuiStyleVar", {
     { "Alpha", ImGuiStyleVar_Alpha},
 	{ "WindowPadding", ImGuiStyleVar_WindowPadding},
 	{ "WindowRounding", ImGuiStyleVar_WindowRounding},
@@ -200,14 +237,13 @@ static std::map<std::string, ImGuiStyleVar_> imguiStyleVarTable
 	{ "IndentSpacing", ImGuiStyleVar_IndentSpacing},
 	{ "GrabMinSize", ImGuiStyleVar_GrabMinSize},
 	{ "ButtonTextAlign", ImGuiStyleVar_ButtonTextAlign}
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiStyleVar_ &value) {
-	value = parse_imgui_enum(l, index, imguiStyleVarTable, "ImGuiStyleVar");
+	value = imguiStyleVarTable.CheckEnum(l, index);
 }
 
-static std::map<std::string, ImGuiWindowFlags_> imguiWindowFlagsTable
-= {
+static const LuaFlags<ImGuiWindowFlags_> imguiWindowFlagsTable("ImGuiWindowFlags", {
 	{ "NoTitleBar", ImGuiWindowFlags_NoTitleBar },
 	{ "NoResize", ImGuiWindowFlags_NoResize },
 	{ "NoMove", ImGuiWindowFlags_NoMove },
@@ -225,10 +261,10 @@ static std::map<std::string, ImGuiWindowFlags_> imguiWindowFlagsTable
 	{ "AlwaysVerticalScrollbar", ImGuiWindowFlags_AlwaysVerticalScrollbar },
 	{ "AlwaysHorizontalScrollbar", ImGuiWindowFlags_AlwaysHorizontalScrollbar },
 	{ "AlwaysUseWindowPadding", ImGuiWindowFlags_AlwaysUseWindowPadding }
-};
+});
 
 void pi_lua_generic_pull(lua_State *l, int index, ImGuiWindowFlags_ &theflags) {
-	theflags = parse_imgui_flags(l, index, imguiWindowFlagsTable, "ImGuiWindowFlags");
+	theflags = imguiWindowFlagsTable.CheckFlags(l, index);
 }
 
 static void pi_lua_pushVector(lua_State *l, double x, double y, double z) {
@@ -272,25 +308,25 @@ void pi_lua_generic_push(lua_State *l, const vector3d &v) {
  *   stable
  */
 static int l_pigui_begin(lua_State *l) {
-	const std::string name = LuaPull<std::string>(l, 1);
+	const char *name = LuaPull<const char *>(l, 1);
 	ImGuiWindowFlags theflags = LuaPull<ImGuiWindowFlags_>(l, 2);
-	ImGui::Begin(name.c_str(), nullptr, theflags);
+	ImGui::Begin(name, nullptr, theflags);
 	return 0;
 }
 
 static int l_pigui_columns(lua_State *l) {
 	int columns = LuaPull<int>(l, 1);
-	std::string id = LuaPull<std::string>(l, 2);
+	const char *id = LuaPull<const char *>(l, 2);
 	bool border = LuaPull<bool>(l, 3);
-	ImGui::Columns(columns, id.c_str(), border);
+	ImGui::Columns(columns, id, border);
 	return 0;
 }
 
 static int l_pigui_progress_bar(lua_State *l) {
 	float fraction = LuaPull<double>(l, 1);
 	ImVec2 size = LuaPull<ImVec2>(l, 2);
-	std::string overlay = LuaPull<std::string>(l, 3);
-	ImGui::ProgressBar(fraction, size, overlay.c_str());
+	const char *overlay = LuaPull<const char *>(l, 3);
+	ImGui::ProgressBar(fraction, size, overlay);
 	return 0;
 }
 
@@ -338,8 +374,8 @@ static int l_pigui_set_next_window_focus(lua_State *l) {
 }
 
 static int l_pigui_set_window_focus(lua_State *l) {
-	std::string name = LuaPull<std::string>(l, 1);
-	ImGui::SetWindowFocus(name.c_str());
+	const char *name = LuaPull<const char *>(l, 1);
+	ImGui::SetWindowFocus(name);
 	return 0;
 }
 
@@ -438,30 +474,30 @@ static int l_pigui_path_stroke(lua_State *l) {
 }
 
 static int l_pigui_selectable(lua_State *l) {
-	std::string label = LuaPull<std::string>(l, 1);
+	const char *label = LuaPull<const char *>(l, 1);
 	bool selected = LuaPull<bool>(l, 2);
 	ImGuiSelectableFlags flags = LuaPull<ImGuiSelectableFlags_>(l, 3);
 	// TODO: parameter size
-	bool res = ImGui::Selectable(label.c_str(), selected, flags);
+	bool res = ImGui::Selectable(label, selected, flags);
 	LuaPush<bool>(l, res);
 	return 1;
 }
 
 static int l_pigui_text(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
-	ImGui::Text("%s", text.c_str());
+	const char *text = LuaPull<const char *>(l, 1);
+	ImGui::Text("%s", text);
 	return 0;
 }
 
 static int l_pigui_button(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
-	bool ret = ImGui::Button(text.c_str());
+	const char *text = LuaPull<const char *>(l, 1);
+	bool ret = ImGui::Button(text);
 	LuaPush<bool>(l, ret);
 	return 1;
 }
 
 static int l_pigui_thrust_indicator(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
+	const char *text = LuaPull<const char *>(l, 1);
 	ImVec2 size = LuaPull<ImVec2>(l, 2);
 	vector3d thr = LuaPull<vector3d>(l, 3);
 	vector3d vel = LuaPull<vector3d>(l, 4);
@@ -473,33 +509,33 @@ static int l_pigui_thrust_indicator(lua_State *l) {
 	ImColor thrust_bg = LuaPull<ImColor>(l, 10);
 	ImVec4 thrust(thr.x, thr.y, thr.z, 0);
 	ImVec4 velocity(vel.x, vel.y, vel.z, 0);
-	PiGui::ThrustIndicator(text.c_str(), size, thrust, velocity, color, frame_padding, vel_fg, vel_bg, thrust_fg, thrust_bg);
+	PiGui::ThrustIndicator(text, size, thrust, velocity, color, frame_padding, vel_fg, vel_bg, thrust_fg, thrust_bg);
 	return 0;
 }
 
 static int l_pigui_low_thrust_button(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
+	const char *text = LuaPull<const char *>(l, 1);
 	ImVec2 size = LuaPull<ImVec2>(l, 2);
 	float level = LuaPull<int>(l, 3);
 	ImColor color = LuaPull<ImColor>(l, 4);
 	int frame_padding = LuaPull<int>(l, 5);
 	ImColor gauge_fg = LuaPull<ImColor>(l, 6);
 	ImColor gauge_bg = LuaPull<ImColor>(l, 7);
-	bool ret = PiGui::LowThrustButton(text.c_str(), size, level, color, frame_padding, gauge_fg, gauge_bg);
+	bool ret = PiGui::LowThrustButton(text, size, level, color, frame_padding, gauge_fg, gauge_bg);
 	LuaPush<bool>(l, ret);
 	return 1;
 }
 
 static int l_pigui_text_wrapped(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
-	ImGui::TextWrapped("%s", text.c_str());
+	const char *text = LuaPull<const char *>(l, 1);
+	ImGui::TextWrapped("%s", text);
 	return 0;
 }
 
 static int l_pigui_text_colored(lua_State *l) {
 	ImColor col = LuaPull<ImColor>(l, 1);
-	std::string text = LuaPull<std::string>(l, 2);
-	ImGui::TextColored(col, "%s", text.c_str());
+	const char *text = LuaPull<const char *>(l, 2);
+	ImGui::TextColored(col, "%s", text);
 	return 0;
 }
 
@@ -589,8 +625,8 @@ static int l_pigui_add_text(lua_State *l) {
 	ImDrawList* draw_list = ImGui::GetWindowDrawList();
 	ImVec2 center = LuaPull<ImVec2>(l, 1);
 	ImColor color = LuaPull<ImColor>(l, 2);
-	std::string text = LuaPull<std::string>(l, 3);
-	draw_list->AddText(center, color, text.c_str());
+	const char *text = LuaPull<const char *>(l, 3);
+	draw_list->AddText(center, color, text);
 	return 0;
 }
 
@@ -723,14 +759,14 @@ static int l_pigui_dummy(lua_State *l) {
 }
 
 static int l_pigui_begin_popup(lua_State *l) {
-	std::string id = LuaPull<std::string>(l, 1);
-	LuaPush<bool>(l, ImGui::BeginPopup(id.c_str()));
+	const char *id = LuaPull<const char *>(l, 1);
+	LuaPush<bool>(l, ImGui::BeginPopup(id));
 	return 1;
 }
 
 static int l_pigui_open_popup(lua_State *l) {
-	std::string id = LuaPull<std::string>(l, 1);
-	ImGui::OpenPopup(id.c_str());
+	const char *id = LuaPull<const char *>(l, 1);
+	ImGui::OpenPopup(id);
 	return 0;
 }
 
@@ -740,8 +776,8 @@ static int l_pigui_end_popup(lua_State *l) {
 }
 
 static int l_pigui_begin_child(lua_State *l) {
-	std::string id = LuaPull<std::string>(l, 1);
-	ImGui::BeginChild(id.c_str());
+	const char *id = LuaPull<const char *>(l, 1);
+	ImGui::BeginChild(id);
 	return 0;
 }
 
@@ -799,8 +835,8 @@ static int l_pigui_pop_font(lua_State *l) {
 }
 
 static int l_pigui_calc_text_size(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
-	ImVec2 size = ImGui::CalcTextSize(text.c_str());
+	const char *text = LuaPull<const char *>(l, 1);
+	ImVec2 size = ImGui::CalcTextSize(text);
 	pi_lua_generic_push(l, size);
 	return 1;
 }
@@ -818,15 +854,15 @@ static int l_pigui_get_mouse_wheel(lua_State *l) {
 }
 
 static int l_pigui_set_tooltip(lua_State *l) {
-	std::string text = LuaPull<std::string>(l, 1);
-	ImGui::SetTooltip("%s", text.c_str());
+	const char *text = LuaPull<const char *>(l, 1);
+	ImGui::SetTooltip("%s", text);
 	return 0;
 }
 
 static int l_pigui_checkbox(lua_State *l) {
-	std::string label = LuaPull<std::string>(l, 1);
+	const char *label = LuaPull<const char *>(l, 1);
 	bool checked = LuaPull<bool>(l, 2);
-	bool changed = ImGui::Checkbox(label.c_str(), &checked);
+	bool changed = ImGui::Checkbox(label, &checked);
 	LuaPush<bool>(l, changed);
 	LuaPush<bool>(l, checked);
 	return 2;
@@ -844,8 +880,8 @@ static int l_pigui_pop_item_width(lua_State *l) {
 }
 
 static int l_pigui_push_id(lua_State *l) {
-	std::string id = LuaPull<std::string>(l, 1);
-	ImGui::PushID(id.c_str());
+	const char *id = LuaPull<const char *>(l, 1);
+	ImGui::PushID(id);
 	return 0;
 }
 
@@ -909,26 +945,73 @@ std::tuple<bool, vector3d, vector3d> lua_world_space_to_screen_space(vector3d po
 	}
 }
 
+// Update a Vector field of the table on top of the stack in place, creating
+// it only if the table doesn't have one yet.
+static void pi_lua_set_vector_field(lua_State *l, const char *name, const vector3d &v) {
+	lua_getfield(l, -1, name);
+	if (lua_istable(l, -1)) {
+		lua_pushnumber(l, v.x);
+		lua_setfield(l, -2, "x");
+		lua_pushnumber(l, v.y);
+		lua_setfield(l, -2, "y");
+		lua_pushnumber(l, v.z);
+		lua_setfield(l, -2, "z");
+		lua_pop(l, 1);
+	} else {
+		lua_pop(l, 1);
+		pi_lua_generic_push(l, v);
+		lua_setfield(l, -2, name);
+	}
+}
+
+// registry key for the table returned by GetProjectedBodies
+static char s_projectedBodiesKey;
+
+// Returns an array of { type, onscreen, screenCoordinates, direction, body }
+// entries, one per body. The array and its entries are reused from call to
+// call, so scripts must not hold on to them past the current frame.
 static int l_pigui_get_projected_bodies(lua_State *l) {
-	LuaTable result(l);
+	lua_rawgetp(l, LUA_REGISTRYINDEX, &s_projectedBodiesKey);
+	if (!lua_istable(l, -1)) {
+		lua_pop(l, 1);
+		lua_newtable(l);
+		lua_pushvalue(l, -1);
+		lua_rawsetp(l, LUA_REGISTRYINDEX, &s_projectedBodiesKey);
+	}
+	const int result = lua_gettop(l);
+	const int previous = lua_rawlen(l, result);
+
+	int n = 0;
 	for (Body* body : Pi::game->GetSpace()->GetBodies()) {
 		if(body == Pi::game->GetPlayer()) continue;
 		if (body->GetType() == Object::PROJECTILE) continue;
 
-		LuaTable object(l);
+		lua_rawgeti(l, result, ++n);
+		if (!lua_istable(l, -1)) {
+			lua_pop(l, 1);
+			lua_createtable(l, 0, 5);
+			lua_pushvalue(l, -1);
+			lua_rawseti(l, result, n);
+		}
 
-		object.Set("type", EnumStrings::GetString("PhysicsObjectType", body->GetType()));
+		lua_pushstring(l, EnumStrings::GetString("PhysicsObjectType", body->GetType()));
+		lua_setfield(l, -2, "type");
 
 		std::tuple<bool, vector3d, vector3d> res = lua_world_space_to_screen_space(body->GetInterpPositionRelTo(Pi::game->GetPlayer())); // defined in LuaPiGui.cpp
-		object.Set("onscreen", std::get<0>(res));
-		object.Set("screenCoordinates", std::get<1>(res));
-		object.Set("direction", std::get<2>(res));
-		object.Set("body", body);
+		lua_pushboolean(l, std::get<0>(res));
+		lua_setfield(l, -2, "onscreen");
+		pi_lua_set_vector_field(l, "screenCoordinates", std::get<1>(res));
+		pi_lua_set_vector_field(l, "direction", std::get<2>(res));
+		LuaPush(l, body);
+		lua_setfield(l, -2, "body");
 
-		result.Set(body, object);
 		lua_pop(l, 1);
 	}
-	LuaPush(l, result);
+	// drop entries left over from a previous call with more bodies
+	for (int i = previous; i > n; --i) {
+		lua_pushnil(l);
+		lua_rawseti(l, result, i);
+	}
 	return 1;
 }
 
@@ -1126,25 +1209,25 @@ static int l_pigui_system_info_view_next_page(lua_State *l) {
 }
 
 static int l_pigui_input_text(lua_State *l) {
-	std::string label = LuaPull<std::string>(l, 1);
-	std::string text = LuaPull<std::string>(l, 2);
+	const char *label = LuaPull<const char *>(l, 1);
+	const char *text = LuaPull<const char *>(l, 2);
 	int flags = LuaPull<ImGuiInputTextFlags_>(l, 3);
 	// callback
 	// user_data
 	char buffer[1024];
 	memset(buffer, 0, 1024);
-	strncpy(buffer, text.c_str(), 1023);
-	bool result = ImGui::InputText(label.c_str(), buffer, 1024, flags);
+	strncpy(buffer, text, 1023);
+	bool result = ImGui::InputText(label, buffer, 1024, flags);
 	LuaPush<const char*>(l, buffer);
 	LuaPush<bool>(l, result);
 	return 2;
 }
 
 static int l_pigui_play_sfx(lua_State *l) {
-	std::string name = LuaPull<std::string>(l, 1);
+	const char *name = LuaPull<const char *>(l, 1);
 	double left = LuaPull<float>(l, 2);
 	double right = LuaPull<float>(l, 3);
-	Sound::PlaySfx(name.c_str(), left, right, false);
+	Sound::PlaySfx(name, left, right, false);
 	return 0;
 }
 
@@ -1180,7 +1263,7 @@ static int l_pigui_set_cursor_pos(lua_State *l) {
 }
 
 static int l_pigui_drag_int_4(lua_State *l) {
-	std::string label = LuaPull<std::string>(l, 1);
+	const char *label = LuaPull<const char *>(l, 1);
 	int v[4];
 	v[0] = LuaPull<int>(l, 2);
 	v[1] = LuaPull<int>(l, 3);
@@ -1189,7 +1272,7 @@ static int l_pigui_drag_int_4(lua_State *l) {
 	double v_speed = LuaPull<double>(l, 6);
 	double v_min = LuaPull<double>(l, 7);
 	double v_max = LuaPull<double>(l, 8);
-	bool res = ImGui::DragInt4(label.c_str(), v, v_speed, v_min, v_max);
+	bool res = ImGui::DragInt4(label, v, v_speed, v_min, v_max);
 	LuaPush<bool>(l, res);
 	LuaPush<int>(l, v[0]);
 	LuaPush<int>(l, v[1]);
@@ -0,0 +1,136 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "LuaProfiler.h"
+#include "Lua.h"
+#include "FileSystem.h"
+#include "StringF.h"
+
+// deeper stacks are truncated at the outermost frames
+static const int MAX_STACK_DEPTH = 64;
+
+LuaProfiler::LuaProfiler() :
+	m_running(false),
+	m_startTicks(0),
+	m_pendingAllocs(0),
+	m_pendingBytes(0)
+{
+}
+
+void LuaProfiler::Start(lua_State *l)
+{
+	if (m_running)
+		return;
+
+	m_stacks.clear();
+	m_allocs.clear();
+	m_pendingAllocs = m_pendingBytes = 0;
+	m_startTicks = SDL_GetTicks();
+	m_running = true;
+
+	lua_sethook(l, &LuaProfiler::Hook, LUA_MASKCOUNT, INSTRUCTIONS_PER_SAMPLE);
+	Output("Lua profiler started\n");
+}
+
+std::string LuaProfiler::Stop(lua_State *l)
+{
+	if (!m_running)
+		return std::string();
+
+	lua_sethook(l, 0, 0, 0);
+	m_running = false;
+
+	// whatever was allocated after the last sample has no owner
+	if (m_pendingAllocs) {
+		AllocStats &stats = m_allocs["(unsampled)"];
+		stats.count += m_pendingAllocs;
+		stats.bytes += m_pendingBytes;
+		m_pendingAllocs = m_pendingBytes = 0;
+	}
+
+	const std::string path = Write();
+	Output("Lua profiler stopped after %.1fs, wrote %s\n", (SDL_GetTicks() - m_startTicks) * 0.001, path.c_str());
+	return path;
+}
+
+void LuaProfiler::Hook(lua_State *l, lua_Debug *ar)
+{
+	if (ar->event == LUA_HOOKCOUNT)
+		Lua::manager->GetProfiler().Sample(l);
+}
+
+void LuaProfiler::Sample(lua_State *l)
+{
+	lua_Debug frames[MAX_STACK_DEPTH];
+	int depth = 0;
+	while (depth < MAX_STACK_DEPTH && lua_getstack(l, depth, &frames[depth])) {
+		lua_getinfo(l, "Sn", &frames[depth]);
+		++depth;
+	}
+
+	// folded stacks go from the outermost frame to the innermost
+	m_scratch.clear();
+	const char *module = 0;
+	for (int i = depth - 1; i >= 0; --i) {
+		const lua_Debug &f = frames[i];
+		if (f.what[0] == 'C')
+			m_scratch += stringf("[C]:%0", f.name ? f.name : "?");
+		else
+			m_scratch += stringf("%0:%1:%2{d}", f.short_src, f.name ? f.name : (f.what[0] == 'm' ? "main" : "?"), f.linedefined);
+		if (i)
+			m_scratch += ';';
+	}
+	// the innermost Lua (not C) frame owns the allocations since the last sample
+	for (int i = 0; i < depth && !module; ++i)
+		if (frames[i].what[0] != 'C')
+			module = frames[i].short_src;
+
+	m_stacks[m_scratch]++;
+
+	if (m_pendingAllocs) {
+		AllocStats &stats = m_allocs[module ? module : "[C]"];
+		stats.count += m_pendingAllocs;
+		stats.bytes += m_pendingBytes;
+		m_pendingAllocs = m_pendingBytes = 0;
+	}
+}
+
+std::string LuaProfiler::Write() const
+{
+	FileSystem::userFiles.MakeDirectory("profiler");
+
+	// don't overwrite earlier runs
+	std::string name;
+	for (int n = 0; ; ++n) {
+		name = stringf("lua-%0{d}", n);
+		const FileSystem::FileInfo info = FileSystem::userFiles.Lookup(FileSystem::JoinPath("profiler", name + ".folded"));
+		if (!info.Exists())
+			break;
+	}
+
+	const std::string foldedPath = FileSystem::JoinPath("profiler", name + ".folded");
+	FILE *f = FileSystem::userFiles.OpenWriteStream(foldedPath, FileSystem::FileSourceFS::WRITE_TEXT);
+	if (!f) {
+		Output("Lua profiler: couldn't open %s for writing\n", foldedPath.c_str());
+		return std::string();
+	}
+	for (const auto &stack : m_stacks)
+		fprintf(f, "%s %" PRIu64 "\n", stack.first.c_str(), stack.second * INSTRUCTIONS_PER_SAMPLE);
+	fclose(f);
+
+	const std::string allocPath = FileSystem::JoinPath("profiler", name + ".alloc");
+	f = FileSystem::userFiles.OpenWriteStream(allocPath, FileSystem::FileSourceFS::WRITE_TEXT);
+	if (f) {
+		// biggest first
+		std::vector<std::pair<std::string, AllocStats>> allocs(m_allocs.begin(), m_allocs.end());
+		std::sort(allocs.begin(), allocs.end(), [](const std::pair<std::string, AllocStats> &a, const std::pair<std::string, AllocStats> &b) {
+			return a.second.bytes > b.second.bytes;
+		});
+		fprintf(f, "%14s %14s  source\n", "bytes", "allocations");
+		for (const auto &alloc : allocs)
+			fprintf(f, "%14" PRIu64 " %14" PRIu64 "  %s\n", alloc.second.bytes, alloc.second.count, alloc.first.c_str());
+		fclose(f);
+	}
+
+	return FileSystem::JoinPathBelow(FileSystem::userFiles.GetRoot(), foldedPath);
+}
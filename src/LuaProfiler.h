@@ -0,0 +1,61 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _LUAPROFILER_H
+#define _LUAPROFILER_H
+
+#include "LuaUtils.h"
+
+// Sampling profiler for Lua scripts.
+//
+// While running, a count hook fires every INSTRUCTIONS_PER_SAMPLE VM
+// instructions and records the current Lua call stack, so each sample stands
+// for the same amount of interpreter work. Memory allocated by the Lua state
+// between two samples is charged to the source file running at the second.
+//
+// Stop() writes two files to the "profiler" directory in the user folder:
+//   lua-<n>.folded  one "outer;...;inner count" line per stack, the input
+//                   format of flamegraph.pl and most flame graph viewers
+//   lua-<n>.alloc   allocation counts and bytes per source file
+class LuaProfiler {
+public:
+	enum { INSTRUCTIONS_PER_SAMPLE = 1000 };
+
+	LuaProfiler();
+
+	void Start(lua_State *l);
+	// returns the path of the folded stacks file, or an empty string if the
+	// profiler wasn't running
+	std::string Stop(lua_State *l);
+	bool IsRunning() const { return m_running; }
+
+	// called from the Lua allocator; must not touch the Lua state
+	void AccountAllocation(size_t bytes) {
+		m_pendingAllocs++;
+		m_pendingBytes += bytes;
+	}
+
+private:
+	LuaProfiler(const LuaProfiler &);
+	LuaProfiler &operator=(const LuaProfiler &);
+
+	static void Hook(lua_State *l, lua_Debug *ar);
+	void Sample(lua_State *l);
+	std::string Write() const;
+
+	struct AllocStats {
+		AllocStats() : count(0), bytes(0) {}
+		Uint64 count;
+		Uint64 bytes;
+	};
+
+	bool m_running;
+	Uint32 m_startTicks;
+	std::map<std::string, Uint64> m_stacks;
+	std::map<std::string, AllocStats> m_allocs;
+	Uint64 m_pendingAllocs;
+	Uint64 m_pendingBytes;
+	std::string m_scratch;
+};
+
+#endif
@@ -5,6 +5,11 @@
 #include "LuaUtils.h"
 #include "Game.h"
 #include "Pi.h"
+#include "StringF.h"
+
+LuaTimer::LuaTimer() : m_nextId(1)
+{
+}
 
 void LuaTimer::RemoveAll()
 {
@@ -12,56 +17,94 @@ void LuaTimer::RemoveAll()
 
     lua_pushnil(l);
     lua_setfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
+
+	m_timers.clear();
+	m_nextId = 1;
 }
 
-void LuaTimer::Tick()
+void LuaTimer::ResetCallbackStats()
 {
-	assert(Pi::game);
-	lua_State *l = Lua::manager->GetLuaState();
+	// timers hold pointers into the map, so keep the entries
+	for (auto &entry : m_stats)
+		entry.second = CallbackStats();
+}
 
+void LuaTimer::Insert(lua_State *l, int funcIndex, double at, double every)
+{
 	LUA_DEBUG_START(l);
 
+	funcIndex = lua_absindex(l, funcIndex);
+
+	Timer timer;
+	timer.at = at;
+	timer.every = every;
+	timer.id = m_nextId++;
+
+	lua_Debug ar;
+	lua_pushvalue(l, funcIndex);
+	lua_getinfo(l, ">S", &ar);
+	timer.stats = &m_stats[stringf("%0:%1{d}", ar.short_src, ar.linedefined)];
+
 	lua_getfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
 	if (lua_isnil(l, -1)) {
 		lua_pop(l, 1);
-		LUA_DEBUG_END(l, 0);
-		return;
+		lua_newtable(l);
+		lua_pushvalue(l, -1);
+		lua_setfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
 	}
-	assert(lua_istable(l, -1));
+	lua_pushvalue(l, funcIndex);
+	lua_rawseti(l, -2, timer.id);
+	lua_pop(l, 1);
+
+	m_timers.push_back(timer);
+	std::push_heap(m_timers.begin(), m_timers.end());
 
-	double now = Pi::game->GetTime();
+	LUA_DEBUG_END(l, 0);
+}
 
-	lua_pushnil(l);
-	while (lua_next(l, -2)) {
-		assert(lua_istable(l, -1));
+void LuaTimer::Tick()
+{
+	assert(Pi::game);
 
-		lua_getfield(l, -1, "at");
-		double at = lua_tonumber(l, -1);
-		lua_pop(l, 1);
+	const double now = Pi::game->GetTime();
+	if (m_timers.empty() || m_timers.front().at > now)
+		return;
 
-		if (at <= now) {
-			lua_getfield(l, -1, "callback");
-			pi_lua_protected_call(l, 0, 1);
-			bool cancel = lua_toboolean(l, -1);
-			lua_pop(l, 1);
-
-			lua_getfield(l, -1, "every");
-			if (lua_isnil(l, -1) || cancel) {
-				lua_pop(l, 1);
-
-				lua_pushvalue(l, -2);
-				lua_pushnil(l);
-				lua_settable(l, -5);
-			}
-			else {
-				double every = lua_tonumber(l, -1);
-				lua_pop(l, 1);
-
-				pi_lua_settable(l, "at", Pi::game->GetTime() + every);
-			}
-		}
+	lua_State *l = Lua::manager->GetLuaState();
 
+	LUA_DEBUG_START(l);
+
+	lua_getfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
+	assert(lua_istable(l, -1));
+
+	static const double msPerCount = 1000.0 / double(SDL_GetPerformanceFrequency());
+
+	// callbacks can only add timers that are due later than now, so this
+	// always terminates
+	while (!m_timers.empty() && m_timers.front().at <= now) {
+		std::pop_heap(m_timers.begin(), m_timers.end());
+		Timer timer = m_timers.back();
+		m_timers.pop_back();
+
+		const Uint64 start = SDL_GetPerformanceCounter();
+		lua_rawgeti(l, -1, timer.id);
+		pi_lua_protected_call(l, 0, 1);
+		bool cancel = lua_toboolean(l, -1);
 		lua_pop(l, 1);
+		const double ms = double(SDL_GetPerformanceCounter() - start) * msPerCount;
+
+		timer.stats->calls++;
+		timer.stats->totalMs += ms;
+		timer.stats->maxMs = std::max(timer.stats->maxMs, ms);
+
+		if (timer.every > 0.0 && !cancel) {
+			timer.at = Pi::game->GetTime() + timer.every;
+			m_timers.push_back(timer);
+			std::push_heap(m_timers.begin(), m_timers.end());
+		} else {
+			lua_pushnil(l);
+			lua_rawseti(l, -2, timer.id);
+		}
 	}
 	lua_pop(l, 1);
 
@@ -104,28 +147,6 @@ void LuaTimer::Tick()
  * underlying object exists before trying to use it.
  */
 
-static void _finish_timer_create(lua_State *l)
-{
-	lua_pushstring(l, "callback");
-	lua_pushvalue(l, 3);
-	lua_settable(l, -3);
-
-	lua_getfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
-	if (lua_isnil(l, -1)) {
-		lua_pop(l, 1);
-		lua_newtable(l);
-		lua_pushvalue(l, -1);
-		lua_setfield(l, LUA_REGISTRYINDEX, "PiTimerCallbacks");
-	}
-
-	lua_insert(l, -2);
-	lua_pushinteger(l, lua_rawlen(l, -2) + 1);
-	lua_insert(l, -2);
-	lua_settable(l, -3);
-
-	lua_pop(l, 1);
-}
-
 /*
  * Method: CallAt
  *
@@ -170,14 +191,7 @@ static int l_timer_call_at(lua_State *l)
 	if (at <= Pi::game->GetTime())
 		luaL_error(l, "Specified time is in the past");
 
-	LUA_DEBUG_START(l);
-
-	lua_newtable(l);
-	pi_lua_settable(l, "at", at);
-
-	_finish_timer_create(l);
-
-	LUA_DEBUG_END(l, 0);
+	Pi::luaTimer->Insert(l, 3, at, 0.0);
 
 	return 0;
 }
@@ -235,17 +249,49 @@ static int l_timer_call_every(lua_State *l)
 	if (every <= 0)
 		luaL_error(l, "Specified interval must be greater than zero");
 
-	LUA_DEBUG_START(l);
+	Pi::luaTimer->Insert(l, 3, Pi::game->GetTime() + every, every);
+
+	return 0;
+}
 
-	lua_newtable(l);
-	pi_lua_settable(l, "every", every);
-	pi_lua_settable(l, "at", Pi::game->GetTime() + every);
+/*
+ * Method: GetCallbackStats
+ *
+ * Returns the time spent in each timer callback since the game started.
+ *
+ * > local stats = Timer:GetCallbackStats()
+ *
+ * Return:
+ *
+ *   stats - a table keyed by "source:line" of the callback function. Each
+ *           value is a table with the fields calls, total and max; the last
+ *           two are in milliseconds.
+ *
+ * Availability:
+ *
+ *   2017 November
+ *
+ * Status:
+ *
+ *   debug
+ */
+static int l_timer_get_callback_stats(lua_State *l)
+{
+	LUA_DEBUG_START(l);
 
-	_finish_timer_create(l);
+	const std::map<std::string, LuaTimer::CallbackStats> &stats = Pi::luaTimer->GetCallbackStats();
+	lua_createtable(l, 0, stats.size());
+	for (const auto &entry : stats) {
+		lua_createtable(l, 0, 3);
+		pi_lua_settable(l, "calls", int(entry.second.calls));
+		pi_lua_settable(l, "total", entry.second.totalMs);
+		pi_lua_settable(l, "max", entry.second.maxMs);
+		lua_setfield(l, -2, entry.first.c_str());
+	}
 
-	LUA_DEBUG_END(l, 0);
+	LUA_DEBUG_END(l, 1);
 
-	return 0;
+	return 1;
 }
 
 template <> const char *LuaObject<LuaTimer>::s_type = "Timer";
@@ -259,6 +305,7 @@ template <> void LuaObject<LuaTimer>::RegisterClass()
 	static const luaL_Reg l_methods[] = {
 		{ "CallAt",    l_timer_call_at    },
 		{ "CallEvery", l_timer_call_every },
+		{ "GetCallbackStats", l_timer_get_callback_stats },
 		{ 0, 0 }
 	};
 
@@ -7,10 +7,47 @@
 #include "LuaManager.h"
 #include "DeleteEmitter.h"
 
+// Timers are kept in a min-heap ordered by due time (ties broken by creation
+// order), so Tick only touches the callbacks that are actually due. The
+// callback functions themselves live in the PiTimerCallbacks registry table,
+// indexed by timer id.
 class LuaTimer : public DeleteEmitter {
 public:
+	LuaTimer();
+
 	void Tick();
 	void RemoveAll();
+
+	// schedule the function at stack index funcIndex to be called at game
+	// time 'at', and then every 'every' seconds if 'every' is positive
+	void Insert(lua_State *l, int funcIndex, double at, double every);
+
+	struct CallbackStats {
+		CallbackStats() : calls(0), totalMs(0.0), maxMs(0.0) {}
+		Uint32 calls;
+		double totalMs;
+		double maxMs;
+	};
+	// timing of timer callbacks, keyed by "source:line" of the function
+	const std::map<std::string, CallbackStats> &GetCallbackStats() const { return m_stats; }
+	void ResetCallbackStats();
+
+private:
+	struct Timer {
+		double at;
+		double every;
+		Uint32 id;
+		CallbackStats *stats;
+
+		// std::*_heap build a max-heap, so order by "later first"
+		bool operator<(const Timer &other) const {
+			return at > other.at || (at == other.at && id > other.id);
+		}
+	};
+
+	std::vector<Timer> m_timers;
+	std::map<std::string, CallbackStats> m_stats;
+	Uint32 m_nextId;
 };
 
 #endif
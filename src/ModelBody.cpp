@@ -61,11 +61,15 @@ public:
 	}
 };
 
+bool ModelBody::s_deferGeomMoves = false;
+
 ModelBody::ModelBody()
 : m_isStatic(false)
 , m_colliding(true)
 , m_geom(0)
 , m_model(0)
+, m_dynGeomsDirty(true)
+, m_geomMoveDeferred(false)
 {
 }
 
@@ -124,6 +128,7 @@ void ModelBody::LoadFromJson(const Json::Value &jsonObj, Space *space)
 	m_colliding = modelBodyObj["is_colliding"].asBool();
 	SetModel(modelBodyObj["model_name"].asString().c_str());
 	m_model->LoadFromJson(modelBodyObj);
+	m_dynGeomsDirty = true;
 	m_shields->LoadFromJson(modelBodyObj);
 }
 
@@ -134,6 +139,11 @@ void ModelBody::SetColliding(bool colliding)
 	else m_geom->Disable();
 }
 
+void ModelBody::SetGeomSweep(const vector3d &sweep)
+{
+	if (m_geom) m_geom->SetSweep(sweep);
+}
+
 void ModelBody::RebuildCollisionMesh()
 {
 	if (m_geom) {
@@ -166,6 +176,7 @@ void ModelBody::RebuildCollisionMesh()
 			cg->SetGeom(dynG);
 		m_dynGeoms.push_back(dynG);
 	}
+	m_dynGeomsDirty = true;
 
 	if (GetFrame()) AddGeomsToFrame(GetFrame());
 }
@@ -259,12 +270,18 @@ void ModelBody::RemoveGeomsFromFrame(Frame *f)
 
 void ModelBody::MoveGeoms(const matrix4x4d &m, const vector3d &p)
 {
+	if (s_deferGeomMoves) {
+		m_geomMoveDeferred = true;
+		return;
+	}
+
 	m_geom->MoveTo(m, p);
 
-	//accumulate transforms to animated positions
-	if (!m_dynGeoms.empty()) {
+	//accumulate transforms to animated positions, if they have moved
+	if (m_dynGeomsDirty && !m_dynGeoms.empty()) {
 		DynCollUpdateVisitor dcv;
 		m_model->GetRoot()->Accept(dcv);
+		m_dynGeomsDirty = false;
 	}
 
 	for (auto it = m_dynGeoms.begin(); it != m_dynGeoms.end(); ++it) {
@@ -281,6 +298,41 @@ void ModelBody::MoveGeoms(const matrix4x4d &m, const vector3d &p)
 	}
 }
 
+void ModelBody::GetDeferredGeomMoves(std::vector<GeomMove> &moves)
+{
+	if (!m_geomMoveDeferred)
+		return;
+	m_geomMoveDeferred = false;
+
+	matrix4x4d m = GetOrient();
+	const vector3d p = GetPosition();
+	m[12] = p.x;
+	m[13] = p.y;
+	m[14] = p.z;
+
+	GeomMove move;
+	move.geom = m_geom;
+	move.transform = m;
+	move.animated = false;
+	moves.push_back(move);
+
+	if (m_dynGeoms.empty())
+		return;
+
+	//the animation transforms come from the model, so are worked out here
+	if (m_dynGeomsDirty) {
+		DynCollUpdateVisitor dcv;
+		m_model->GetRoot()->Accept(dcv);
+		m_dynGeomsDirty = false;
+	}
+
+	move.animated = true;
+	for (Geom *g : m_dynGeoms) {
+		move.geom = g;
+		moves.push_back(move);
+	}
+}
+
 // Calculates the ambiently and directly lit portions of the lighting model taking into account the atmosphere and sun positions at a given location
 // 1. Calculates the amount of direct illumination available taking into account
 //    * multiple suns
@@ -448,6 +500,9 @@ void ModelBody::RenderModel(Graphics::Renderer *r, const Camera *camera, const v
 	trans[14] = viewCoords.z;
 	trans[15] = 1.0f;
 
+	// TimeStepUpdate leaves animations alone unless collisions need them
+	if (m_model->UpdateAnimations())
+		m_dynGeomsDirty = true;
 	m_model->Render(trans);
 
 	if (setLighting)
@@ -460,5 +515,9 @@ void ModelBody::TimeStepUpdate(const float timestep)
 		// step animation by timestep/total length, loop to 0.0 if it goes >= 1.0
 		m_idleAnimation->SetProgress(fmod(m_idleAnimation->GetProgress() + timestep / m_idleAnimation->GetDuration(), 1.0));
 
-	m_model->UpdateAnimations();
+	// animations are brought up to date when the model is drawn. only
+	// animated collision geometry needs them every tick, and even then the
+	// geoms are only moved to match when they are next moved
+	if (!m_dynGeoms.empty() && m_model->UpdateAnimations())
+		m_dynGeomsDirty = true;
 }
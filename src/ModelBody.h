@@ -25,6 +25,9 @@ public:
 	// Colliding: geoms are checked against collision space
 	void SetColliding(bool colliding);
 	bool IsColliding() const { return m_colliding; }
+	// how far the body will move before its geom is next collided, so that
+	// a fast body's geom is swept along the way (see Geom::SetSweep)
+	void SetGeomSweep(const vector3d &sweep);
 	// Static: geoms are static relative to frame
 	void SetStatic(bool isStatic);
 	bool IsStatic() const { return m_isStatic; }
@@ -38,6 +41,17 @@ public:
 
 	virtual void TimeStepUpdate(const float timeStep) override;
 
+	// while geom moves are deferred, SetPosition and SetOrient leave the geoms
+	// where they are, and Space moves all the bodies' geoms together afterwards
+	struct GeomMove {
+		Geom *geom;
+		matrix4x4d transform;
+		bool animated; // transform is the body's, to combine with the geom's animation
+	};
+	static void SetDeferGeomMoves(bool defer) { s_deferGeomMoves = defer; }
+	// adds the moves the body's geoms are waiting for, if any
+	void GetDeferredGeomMoves(std::vector<GeomMove> &moves);
+
 protected:
 	virtual void SaveToJson(Json::Value &jsonObj, Space *space) override;
 	virtual void LoadFromJson(const Json::Value &jsonObj, Space *space) override;
@@ -63,6 +77,11 @@ private:
 	std::string m_modelName;
 	SceneGraph::Model *m_model;
 	std::vector<Geom*> m_dynGeoms;
+	// animated collision geometry has moved since the dynamic geoms' animation
+	// transforms were last worked out
+	bool m_dynGeomsDirty;
+	bool m_geomMoveDeferred;
+	static bool s_deferGeomMoves;
 	SceneGraph::Animation *m_idleAnimation;
 	std::unique_ptr<Shields> m_shields;
 };
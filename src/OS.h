@@ -31,6 +31,10 @@ namespace OS {
 	// http://stackoverflow.com/questions/150355/programmatically-find-the-number-of-cores-on-a-machine
 	int GetNumCores();
 
+	// the most memory the process has had resident at once, in bytes, or 0
+	// if that can't be found out here
+	size_t GetPeakResidentBytes();
+
 	// return a string describing the operating system that the game is running on, useful!
 	const std::string GetOSInfoString();
 
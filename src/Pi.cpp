@@ -65,6 +65,7 @@
 #include "KeyBindings.h"
 #include "EnumStrings.h"
 #include "ServerAgent.h"
+#include "collider/BVHTree.h"
 #include "galaxy/CustomSystem.h"
 #include "galaxy/GalaxyGenerator.h"
 #include "galaxy/StarSystem.h"
@@ -72,10 +73,12 @@
 // ------------------------------------------------------------
 #include "graphics/gl2/GL2Renderer.h"
 #include "graphics/opengl/RendererGL.h"
+#include "graphics/dummy/RendererDummy.h"
 // ------------------------------------------------------------
 #include "graphics/Graphics.h"
 #include "graphics/Light.h"
 #include "graphics/Renderer.h"
+#include "graphics/RendererRecorder.h"
 #include "graphics/Stats.h"
 #include "gui/Gui.h"
 #include "scenegraph/Model.h"
@@ -258,6 +261,9 @@ void Pi::EndRenderTarget() {
 
 static void draw_progress(float progress)
 {
+	// headless (see -bench and -replay), there's nobody to show it to
+	if (Pi::renderer->GetRendererType() == Graphics::RENDERER_DUMMY)
+		return;
 
 	Pi::renderer->ClearScreen();
 	PiGui::NewFrame(Pi::renderer->GetSDLWindow());
@@ -317,6 +323,8 @@ static void LuaInit()
 
 	// XXX load everything. for now, just modules
 	lua_State *l = Lua::manager->GetLuaState();
+	if (Pi::config->Int("LuaProfiler"))
+		Lua::manager->GetProfiler().Start(l);
 	pi_lua_import(l, "libs/autoload.lua", true);
 	pi_lua_import_recursive(l, "ui");
 	pi_lua_import(l, "pigui/pigui.lua", true);
@@ -460,6 +468,11 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	Pi::detail.fracmult = config->Int("FractalMultiple");
 	Pi::detail.cities = config->Int("DetailCities");
 
+	// a headless run (see -bench) might not have a display to open at all
+	const bool headless = config->String("RendererName") == Graphics::RendererNameFromType(Graphics::RENDERER_DUMMY);
+	if (headless)
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
 	// Initialize SDL
 	Uint32 sdlInitFlags = SDL_INIT_VIDEO | SDL_INIT_JOYSTICK;
 #if defined(DEBUG) || defined(_DEBUG)
@@ -474,6 +487,7 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 
 	Graphics::RendererGL2::RegisterRenderer();
 	Graphics::RendererOGL::RegisterRenderer();
+	Graphics::RendererDummy::RegisterRenderer();
 
 	// determine what renderer we should use, default to Opengl 3.x
 	const std::string rendererName = config->String("RendererName", Graphics::RendererNameFromType(Graphics::RENDERER_OPENGL_3x));
@@ -486,6 +500,10 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	{
 		rType = Graphics::RENDERER_OPENGL_3x;
 	}
+	else if(headless)
+	{
+		rType = Graphics::RENDERER_DUMMY;
+	}
 
 	// Do rest of SDL video initialization and create Renderer
 	Graphics::Settings videoSettings = {};
@@ -500,6 +518,7 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	videoSettings.useAnisotropicFiltering = (config->Int("UseAnisotropicFiltering") != 0);
 	videoSettings.enableDebugMessages = (config->Int("EnableGLDebug") != 0);
 	videoSettings.gl3ForwardCompatible = (config->Int("GL3ForwardCompatible") != 0);
+	videoSettings.recordCommands = (config->Int("RecordRenderer") != 0);
 	videoSettings.iconFile = OS::GetIconFilename();
 	videoSettings.title = "Pioneer";
 
@@ -534,6 +553,9 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	asyncJobQueue.reset(new AsyncJobQueue(numThreads));
 	Output("started %d worker threads\n", numThreads);
 	syncJobQueue.reset(new SyncJobQueue);
+	// big collision meshes from models without an .sgm are built on several
+	// threads as they load
+	BVHTree::SetBuildThreads(numThreads);
 
 	Output("ShipType::Init()\n");
 	// XXX early, Lua init needs it
@@ -958,6 +980,21 @@ void Pi::HandleEvents()
 							Pi::showDebugInfo = !Pi::showDebugInfo;
 							break;
 
+						case SDLK_t: // capture a renderer trace of the next frame
+						{
+							Graphics::RendererRecorder *recorder = dynamic_cast<Graphics::RendererRecorder*>(Pi::renderer);
+							if (!recorder) {
+								Output("renderer traces need RecordRenderer=1 in the config\n");
+							} else if (!recorder->IsCapturing()) {
+								char buf[256];
+								const time_t t = time(0);
+								struct tm *_tm = localtime(&t);
+								strftime(buf, sizeof(buf), "trace-%Y%m%d-%H%M%S.trace", _tm);
+								recorder->Capture(buf, 1);
+							}
+							break;
+						}
+
 #ifdef PIONEER_PROFILER
 						case SDLK_p: // alert it that we want to profile
 							if (KeyState(SDLK_LSHIFT) || KeyState(SDLK_RSHIFT))
@@ -1362,6 +1399,11 @@ void Pi::EndGame()
 	player = 0;
 }
 
+// frame length the Lua collector fits its incremental steps into. When
+// paused or docked a dropped frame doesn't matter, so it may take longer.
+static const double GC_TARGET_FRAME_MS = 1000.0 / 60.0;
+static const double GC_IDLE_FRAME_MS = 1000.0 / 30.0;
+
 void Pi::MainLoop()
 {
 	double time_player_died = 0;
@@ -1374,6 +1416,8 @@ void Pi::MainLoop()
 	Uint32 last_stats = SDL_GetTicks();
 	int frame_stat = 0;
 	int phys_stat = 0;
+	Uint64 lua_alloc_stat = Lua::manager->GetAllocationCount();
+	double lua_gc_stat = 0.0;
 	char fps_readout[2048];
 	memset(fps_readout, 0, sizeof(fps_readout));
 #endif
@@ -1542,6 +1586,16 @@ void Pi::MainLoop()
 			}
 		}
 
+		// let the Lua collector have whatever is left of the frame
+		if (Pi::game) {
+			const bool idle = Pi::game->IsPaused() || Pi::player->GetFlightState() == Ship::DOCKED;
+			const double slackMs = (idle ? GC_IDLE_FRAME_MS : GC_TARGET_FRAME_MS) - double(SDL_GetTicks() - newTicks);
+			Lua::manager->StepGarbageCollector(slackMs, idle);
+#if WITH_DEVKEYS
+			lua_gc_stat += Lua::manager->GetCollectionTime();
+#endif
+		}
+
 		Pi::renderer->SwapBuffers();
 
 		// game exit will have cleared Pi::game. we can't continue.
@@ -1569,9 +1623,23 @@ void Pi::MainLoop()
 			int lua_memB = int(lua_mem & ((1u << 10) - 1));
 			int lua_memKB = int(lua_mem >> 10) % 1024;
 			int lua_memMB = int(lua_mem >> 20);
+			const Uint64 lua_allocs = Lua::manager->GetAllocationCount();
+			const Uint32 lua_allocsPerFrame = frame_stat ? Uint32((lua_allocs - lua_alloc_stat) / frame_stat) : 0;
+			lua_alloc_stat = lua_allocs;
 			const Graphics::Stats::TFrameData &stats = Pi::renderer->GetStats().FrameStatsPrevious();
 			const Uint32 numDrawCalls			= stats.m_stats[Graphics::Stats::STAT_DRAWCALL];
 			const Uint32 numBuffersCreated		= stats.m_stats[Graphics::Stats::STAT_CREATE_BUFFER];
+			const Uint32 numStreamBuffers		= stats.m_stats[Graphics::Stats::STAT_STREAM_BUFFERS];
+			const Uint32 numStreamKB			= stats.m_stats[Graphics::Stats::STAT_STREAM_BYTES] >> 10;
+			const Uint32 numStreamOverflows		= stats.m_stats[Graphics::Stats::STAT_STREAM_OVERFLOWS];
+			const Uint32 numStateChanges		= stats.m_stats[Graphics::Stats::STAT_RENDERSTATE_CHANGES];
+			const Uint32 numStatesSkipped		= stats.m_stats[Graphics::Stats::STAT_RENDERSTATE_CHANGES_SKIPPED];
+			const Uint32 numProgramChanges		= stats.m_stats[Graphics::Stats::STAT_PROGRAM_CHANGES];
+			const Uint32 numProgramsSkipped		= stats.m_stats[Graphics::Stats::STAT_PROGRAM_CHANGES_SKIPPED];
+			const Uint32 numTextureBinds		= stats.m_stats[Graphics::Stats::STAT_TEXTURE_BINDS];
+			const Uint32 numTexturesSkipped		= stats.m_stats[Graphics::Stats::STAT_TEXTURE_BINDS_SKIPPED];
+			const Uint32 numUniformsSet			= stats.m_stats[Graphics::Stats::STAT_UNIFORMS_SET];
+			const Uint32 numUniformsSkipped		= stats.m_stats[Graphics::Stats::STAT_UNIFORMS_SKIPPED];
 			const Uint32 numDrawTris			= stats.m_stats[Graphics::Stats::STAT_DRAWTRIS];
 			const Uint32 numDrawPointSprites	= stats.m_stats[Graphics::Stats::STAT_DRAWPOINTSPRITES];
 			const Uint32 numDrawBuildings		= stats.m_stats[Graphics::Stats::STAT_BUILDINGS];
@@ -1588,21 +1656,30 @@ void Pi::MainLoop()
 			snprintf(
 				fps_readout, sizeof(fps_readout),
 				"%d fps (%.1f ms/f), %d phys updates, %d triangles, %.3f M tris/sec, %d glyphs/sec, %d patches/frame\n"
-				"Lua mem usage: %d MB + %d KB + %d bytes (stack top: %d)\n\n"
+				"Lua mem usage: %d MB + %d KB + %d bytes (stack top: %d), %u allocations/frame, GC %.2f ms/frame\n\n"
 				"Draw Calls (%u), of which were:\n Tris (%u)\n Point Sprites (%u)\n Billboards (%u)\n"
 				"Buildings (%u), Cities (%u), GroundStations (%u), SpaceStations (%u), Atmospheres (%u)\n"
 				"Patches (%u), Planets (%u), GasGiants (%u), Stars (%u), Ships (%u)\n"
-				"Buffers Created(%u)\n",
+				"Buffers Created(%u), Stream Buffers (%u), Streamed (%u KB/frame, %u overflows)\n"
+				"Render States (%u, %u skipped), Programs (%u, %u skipped)\n"
+				"Texture Binds (%u, %u skipped), Uniforms (%u, %u skipped)\n"
+				"Frame transforms (%u lookups/sec, %u cached)\n",
 				frame_stat, (1000.0/frame_stat), phys_stat, Pi::statSceneTris, Pi::statSceneTris*frame_stat*1e-6,
 				Text::TextureFont::GetGlyphCount(), Pi::statNumPatches,
-				lua_memMB, lua_memKB, lua_memB, lua_gettop(Lua::manager->GetLuaState()),
+				lua_memMB, lua_memKB, lua_memB, lua_gettop(Lua::manager->GetLuaState()), lua_allocsPerFrame, frame_stat ? lua_gc_stat / frame_stat : 0.0,
 				numDrawCalls, numDrawTris, numDrawPointSprites, numDrawBillBoards,
 				numDrawBuildings, numDrawCities, numDrawGroundStations, numDrawSpaceStations, numDrawAtmospheres,
-				numDrawPatches, numDrawPlanets, numDrawGasGiants, numDrawStars, numDrawShips, numBuffersCreated
+				numDrawPatches, numDrawPlanets, numDrawGasGiants, numDrawStars, numDrawShips, numBuffersCreated,
+				numStreamBuffers, numStreamKB, numStreamOverflows,
+				numStateChanges, numStatesSkipped, numProgramChanges, numProgramsSkipped,
+				numTextureBinds, numTexturesSkipped, numUniformsSet, numUniformsSkipped,
+				Frame::GetCacheLookups(), Frame::GetCacheHits()
 			);
 			frame_stat = 0;
 			phys_stat = 0;
+			lua_gc_stat = 0.0;
 			Text::TextureFont::ClearGlyphCount();
+			Frame::ClearCacheStats();
 			if (SDL_GetTicks() - last_stats > 1200) last_stats = SDL_GetTicks();
 			else last_stats += 1000;
 		}
@@ -1754,6 +1831,9 @@ float Pi::GetMoveSpeedShiftModifier() {
 }
 
 void Pi::DrawPiGui(double delta, std::string handler) {
+	// PiGui::NewFrame doesn't start an imgui frame on the dummy renderer
+	if (Pi::renderer->GetRendererType() == Graphics::RENDERER_DUMMY)
+		return;
 	//  #define PROFILE_LUA_TIME 1
 	#ifdef PROFILE_LUA_TIME
 	auto before = clock();
@@ -1765,4 +1845,6 @@ void Pi::DrawPiGui(double delta, std::string handler) {
   Output("Lua PiGUI took %f\n", double(after - before) / CLOCKS_PER_SEC);
 	#endif
 	PiGui::RenderImGui();
+	// imgui binds textures of its own
+	Pi::renderer->InvalidateStateCache();
 }
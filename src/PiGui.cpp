@@ -177,9 +177,11 @@ void PiGui::Init(SDL_Window *window) {
 	switch(Pi::renderer->GetRendererType())
 		{
 		default:
-		case Graphics::RENDERER_DUMMY:
-			Error("RENDERER_DUMMY is not a valid renderer, aborting.");
+			Error("Unknown renderer type, aborting.");
 			return;
+		case Graphics::RENDERER_DUMMY:
+			// headless (see -bench), nothing is ever drawn or fed input
+			break;
 		case Graphics::RENDERER_OPENGL_21:
 			ImGui_ImplSdl_Init(window);
 			break;
@@ -299,8 +301,10 @@ bool PiGui::ProcessEvent(SDL_Event *event)
 	switch(Pi::renderer->GetRendererType())
 		{
 		default:
+			Error("Unknown renderer type, aborting.");
+			break;
 		case Graphics::RENDERER_DUMMY:
-			Error("RENDERER_DUMMY is not a valid renderer, aborting.");
+			// headless, there's no gui to feed
 			break;
 		case Graphics::RENDERER_OPENGL_21:
 			ImGui_ImplSdl_ProcessEvent(event);
@@ -349,8 +353,10 @@ void PiGui::NewFrame(SDL_Window *window) {
 	switch(Pi::renderer->GetRendererType())
 		{
 		default:
+			Error("Unknown renderer type, aborting.");
+			return;
 		case Graphics::RENDERER_DUMMY:
-			Error("RENDERER_DUMMY is not a valid renderer, aborting.");
+			// headless, no frame is started so nothing may be drawn (see Pi::DrawPiGui)
 			return;
 		case Graphics::RENDERER_OPENGL_21:
 			ImGui_ImplSdl_NewFrame(window);
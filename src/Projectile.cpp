@@ -29,6 +29,14 @@ std::unique_ptr<Graphics::VertexArray> Projectile::s_glowVerts;
 std::unique_ptr<Graphics::Material> Projectile::s_sideMat;
 std::unique_ptr<Graphics::Material> Projectile::s_glowMat;
 Graphics::RenderState *Projectile::s_renderState = nullptr;
+bool Projectile::s_queueUpdates = false;
+
+static std::vector<Projectile*> s_queuedUpdates;
+static float s_queuedTimeStep;
+
+// how closely the rays of projectiles fired together must line up to be
+// traced as a packet (about a tenth of a degree)
+static const double BURST_MIN_DOT = 0.999998;
 
 void Projectile::BuildModel()
 {
@@ -244,10 +252,79 @@ static void MiningLaserSpawnTastyStuff(Frame *f, const SystemBody *asteroid, con
 void Projectile::StaticUpdate(const float timeStep)
 {
 	PROFILE_SCOPED()
+	if (s_queueUpdates) {
+		s_queuedUpdates.push_back(this);
+		return;
+	}
+
 	CollisionContact c;
 	vector3d vel = (m_baseVel+m_dirVel) * timeStep;
 	GetFrame()->GetCollisionSpace()->TraceRay(GetPosition(), vel.Normalized(), vel.Length(), &c);
+	OnTrace(c);
+}
+
+void Projectile::BeginStaticUpdates(float timeStep)
+{
+	assert(!s_queueUpdates);
+	s_queueUpdates = true;
+	s_queuedTimeStep = timeStep;
+	s_queuedUpdates.clear();
+}
 
+void Projectile::EndStaticUpdates()
+{
+	PROFILE_SCOPED()
+	assert(s_queueUpdates);
+	s_queueUpdates = false;
+
+	std::vector<Projectile*> group;
+	std::vector<vector3d> starts, dirs;
+	std::vector<double> lens;
+	std::vector<CollisionContact> contacts;
+
+	// packets only pay off for rays that go the same way from much the same
+	// place, so only the projectiles of one burst (fired together by the
+	// same ship, from its barrels side by side) are traced together. the
+	// rest are traced on their own, as StaticUpdate would
+	for (size_t i = 0; i < s_queuedUpdates.size(); i++) {
+		Projectile *first = s_queuedUpdates[i];
+		if (!first) continue;
+		const vector3d firstVel = (first->m_baseVel+first->m_dirVel) * s_queuedTimeStep;
+		const vector3d firstDir = firstVel.Normalized();
+
+		group.assign(1, first);
+		starts.assign(1, first->GetPosition());
+		dirs.assign(1, firstDir);
+		lens.assign(1, firstVel.Length());
+		for (size_t j = i+1; j < s_queuedUpdates.size(); j++) {
+			Projectile *p = s_queuedUpdates[j];
+			if (!p || p->GetFrame() != first->GetFrame() || p->m_parent != first->m_parent || p->m_age != first->m_age)
+				continue;
+			const vector3d vel = (p->m_baseVel+p->m_dirVel) * s_queuedTimeStep;
+			const vector3d dir = vel.Normalized();
+			if (dir.Dot(firstDir) < BURST_MIN_DOT)
+				continue;
+			group.push_back(p);
+			starts.push_back(p->GetPosition());
+			dirs.push_back(dir);
+			lens.push_back(vel.Length());
+			s_queuedUpdates[j] = nullptr;
+		}
+
+		contacts.assign(group.size(), CollisionContact());
+		CollisionSpace *space = first->GetFrame()->GetCollisionSpace();
+		if (group.size() == 1)
+			space->TraceRay(starts[0], dirs[0], lens[0], &contacts[0]);
+		else
+			space->TraceRays(int(group.size()), starts.data(), dirs.data(), lens.data(), contacts.data());
+		for (size_t k = 0; k < group.size(); k++)
+			group[k]->OnTrace(contacts[k]);
+	}
+	s_queuedUpdates.clear();
+}
+
+void Projectile::OnTrace(const CollisionContact &c)
+{
 	if (c.userData1) {
 		Object *o = static_cast<Object*>(c.userData1);
 
@@ -46,11 +46,20 @@ public:
 
 	static void FreeModel();
 
+	// while the projectiles' StaticUpdates are between these, each only
+	// queues its ray, and EndStaticUpdates traces the rays of each burst
+	// (projectiles fired side by side at the same time) together before
+	// dealing with whatever they hit
+	static void BeginStaticUpdates(float timeStep);
+	static void EndStaticUpdates();
+
 protected:
 	virtual void SaveToJson(Json::Value &jsonObj, Space *space) override;
 	virtual void LoadFromJson(const Json::Value &jsonObj, Space *space) override;
 
 private:
+	// what StaticUpdate does with the contact its ray traced
+	void OnTrace(const CollisionContact &c);
 	float GetDamage() const;
 	double GetRadius() const;
 	Body *m_parent;
@@ -73,6 +82,8 @@ private:
 	static std::unique_ptr<Graphics::Material> s_sideMat;
 	static std::unique_ptr<Graphics::Material> s_glowMat;
 	static Graphics::RenderState *s_renderState;
+
+	static bool s_queueUpdates;
 };
 
 #endif /* _PROJECTILE_H */
@@ -92,6 +92,14 @@ void Writer::String(const std::string &s)
 	Byte(0);
 }
 
+void Writer::Blob(const void *data, size_t size)
+{
+	// the same as a string, so that Reader::Blob can skip the terminator
+	Int32(size+1);
+	m_str.append(static_cast<const char*>(data), size);
+	Byte(0);
+}
+
 void Writer::Vector3f(vector3f vec)
 {
 	Float(vec.x);
@@ -34,6 +34,8 @@ namespace Serializer {
 		void Double(double f);
 		void String(const char* s);
 		void String(const std::string &s);
+		// size bytes as they are in memory, read back with Reader::Blob
+		void Blob(const void *data, size_t size);
 		void Vector3f(vector3f vec);
 		void Vector3d(vector3d vec);
 		void WrQuaternionf(const Quaternionf &q);
@@ -18,13 +18,16 @@
 #include "Serializer.h"
 #include "collider/collider.h"
 #include "Missile.h"
+#include "Projectile.h"
 #include "HyperspaceCloud.h"
 #include "graphics/Graphics.h"
 #include "WorldView.h"
 #include "SectorView.h"
 #include "Lang.h"
 #include "Game.h"
+#include "JobQueue.h"
 #include "MathUtil.h"
+#include "ModelBody.h"
 #include "LuaEvent.h"
 
 //#define DEBUG_CACHE
@@ -66,6 +69,7 @@ Space::Space(Game *game, RefCountedPtr<Galaxy> galaxy, Space* oldSpace)
 	, m_bodyIndexValid(false)
 	, m_sbodyIndexValid(false)
 	, m_bodyNearFinder(this)
+	, m_luaEventBudget(Pi::config->Float("LuaEventBudget"))
 #ifndef NDEBUG
 	, m_processingFinalizationQueue(false)
 #endif
@@ -86,6 +90,7 @@ Space::Space(Game *game, RefCountedPtr<Galaxy> galaxy, const SystemPath &path, S
 	, m_bodyIndexValid(false)
 	, m_sbodyIndexValid(false)
 	, m_bodyNearFinder(this)
+	, m_luaEventBudget(Pi::config->Float("LuaEventBudget"))
 #ifndef NDEBUG
 	, m_processingFinalizationQueue(false)
 #endif
@@ -116,6 +121,7 @@ Space::Space(Game *game, RefCountedPtr<Galaxy> galaxy, const Json::Value &jsonOb
 	, m_bodyIndexValid(false)
 	, m_sbodyIndexValid(false)
 	, m_bodyNearFinder(this)
+	, m_luaEventBudget(Pi::config->Float("LuaEventBudget"))
 #ifndef NDEBUG
 	, m_processingFinalizationQueue(false)
 #endif
@@ -820,6 +826,16 @@ static void hitCallback(CollisionContact *c)
 	// collision response
 	assert(po1_isDynBody || po2_isDynBody);
 
+	if (c->swept) {
+		// they'd meet this step, but haven't yet: nothing happens to either
+		// until they do, so they only go as far as that and it's a real
+		// contact next step
+		const double fraction = c->dist / (c->dist + c->depth);
+		if (po1_isDynBody) static_cast<DynamicBody*>(po1)->LimitStep(fraction);
+		if (po2_isDynBody) static_cast<DynamicBody*>(po2)->LimitStep(fraction);
+		return;
+	}
+
 	if (po1_isDynBody && po2_isDynBody) {
 		DynamicBody *b1 = static_cast<DynamicBody*>(po1);
 		DynamicBody *b2 = static_cast<DynamicBody*>(po2);
@@ -932,6 +948,33 @@ void Space::CollideFrame(Frame *f)
 		CollideFrame(kid);
 }
 
+// enough geoms for a chunk to outweigh handing it to another thread
+static const Uint32 GEOM_MOVE_CHUNK = 64;
+static std::vector<ModelBody::GeomMove> s_geomMoves;
+
+void Space::MoveDeferredGeoms()
+{
+	PROFILE_SCOPED()
+	// gathered in body order, and each move is independent of the others, so
+	// the result is the same however the chunks are shared out
+	s_geomMoves.clear();
+	for (Body* b : m_bodies) {
+		if (b->IsType(Object::MODELBODY))
+			static_cast<ModelBody*>(b)->GetDeferredGeomMoves(s_geomMoves);
+	}
+
+	JobBatch::Run(static_cast<AsyncJobQueue*>(Pi::GetAsyncJobQueue()), s_geomMoves.size(), GEOM_MOVE_CHUNK,
+		[](Uint32 begin, Uint32 end) {
+			for (Uint32 i = begin; i < end; i++) {
+				const ModelBody::GeomMove &move = s_geomMoves[i];
+				if (move.animated)
+					move.geom->MoveTo(move.transform * move.geom->m_animTransform);
+				else
+					move.geom->MoveTo(move.transform);
+			}
+		});
+}
+
 void Space::TimeStep(float step)
 {
 	PROFILE_SCOPED()
@@ -941,30 +984,57 @@ void Space::TimeStep(float step)
 
 	m_frameIndexValid = m_bodyIndexValid = m_sbodyIndexValid = false;
 
+	Uint64 mark = SDL_GetPerformanceCounter();
+
+	// each moving body's geom is swept along the way it'll go this step
+	for (Body* b : m_bodies) {
+		if (!b->IsType(Object::DYNAMICBODY)) continue;
+		DynamicBody *dynBody = static_cast<DynamicBody*>(b);
+		dynBody->SetGeomSweep(dynBody->IsMoving() ? dynBody->GetVelocity() * double(step) : vector3d(0.0));
+	}
+
 	// XXX does not need to be done this often
 	CollideFrame(m_rootFrame.get());
 	for (Body* b : m_bodies)
 		CollideWithTerrain(b);
+	m_timeStepStats.collision = LapMs(mark);
 
 	// update frames of reference
 	for (Body* b : m_bodies)
 		b->UpdateFrame();
+	m_timeStepStats.frames = LapMs(mark);
 
-	// AI acts here, then move all bodies and frames
+	// AI acts here, then move all bodies and frames. projectiles trace their
+	// rays all together at the end
+	Projectile::BeginStaticUpdates(step);
 	for (Body* b : m_bodies)
 		b->StaticUpdate(step);
+	Projectile::EndStaticUpdates();
+	m_timeStepStats.ai = LapMs(mark);
 
 	m_rootFrame->UpdateOrbitRails(m_game->GetTime(), m_game->GetTimeStep());
+	m_timeStepStats.orbitRails = LapMs(mark);
 
+	// geoms are moved all at once afterwards, rather than by each
+	// SetPosition and SetOrient
+	ModelBody::SetDeferGeomMoves(true);
 	for (Body* b : m_bodies)
 		b->TimeStepUpdate(step);
+	ModelBody::SetDeferGeomMoves(false);
+	m_timeStepStats.dynamics = LapMs(mark);
+
+	MoveDeferredGeoms();
+	m_timeStepStats.geoms = LapMs(mark);
 
-	LuaEvent::Emit();
+	LuaEvent::Emit(m_luaEventBudget);
+	m_timeStepStats.luaEvents = LapMs(mark);
 	Pi::luaTimer->Tick();
+	m_timeStepStats.luaTimers = LapMs(mark);
 
 	UpdateBodies();
 
 	m_bodyNearFinder.Prepare();
+	m_timeStepStats.bookkeeping = LapMs(mark);
 }
 
 void Space::UpdateBodies()
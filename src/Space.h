@@ -55,6 +55,20 @@ public:
 
 	void TimeStep(float step);
 
+	// wall clock time spent in each part of the last TimeStep, in milliseconds
+	struct TimeStepStats {
+		double collision;   // frame and terrain collisions
+		double frames;      // bodies changing frame of reference
+		double ai;          // StaticUpdate, where the AI acts
+		double orbitRails;  // moving frames along their orbits
+		double dynamics;    // TimeStepUpdate, integrating the bodies
+		double geoms;       // moving the bodies' collision geoms to match
+		double luaEvents;
+		double luaTimers;
+		double bookkeeping; // pruning removed bodies, preparing the near finder
+	};
+	const TimeStepStats &GetTimeStepStats() const { return m_timeStepStats; }
+
 	vector3d GetHyperspaceExitPoint(const SystemPath &source, const SystemPath &dest) const;
 	vector3d GetHyperspaceExitPoint(const SystemPath &source) const {
 		return GetHyperspaceExitPoint(source, m_starSystem->GetPath());
@@ -91,6 +105,7 @@ private:
 	void UpdateBodies();
 
 	void CollideFrame(Frame *f);
+	void MoveDeferredGeoms();
 
 	std::unique_ptr<Frame> m_rootFrame;
 
@@ -150,6 +165,12 @@ private:
 
 	BodyNearFinder m_bodyNearFinder;
 
+	TimeStepStats m_timeStepStats = {};
+
+	// ms of Lua event handlers per tick (the LuaEventBudget config option),
+	// read once when the space is made rather than every tick
+	float m_luaEventBudget;
+
 #ifndef NDEBUG
 	//to check RemoveBody and KillBody are not called from within
 	//the NotifyRemoved callback (#735)
@@ -3,148 +3,340 @@
 
 #include "BVHTree.h"
 #include "../buildopts.h"
+#include "../Serializer.h"
 #include <stdio.h>
 #include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <SDL_thread.h>
 
-const int MAX_SPLITPOS_RETRIES = 15;
+// split candidates per node: the objects are sorted into this many slices
+// along the node's longest axis and the split with the lowest surface area
+// heuristic cost between two of them is taken
+static const int NUM_BINS = 16;
+// cost of visiting a node, relative to testing one object
+static const double TRAVERSAL_COST = 1.0;
+// nodes with no more objects than this become leaves if no split pays
+static const size_t MAX_LEAF_OBJS = 4;
+// traversal keeps fixed size stacks, so past this every node is a leaf
+static const int MAX_DEPTH = 28;
+// nodes smaller than this aren't worth a thread
+static const size_t PARALLEL_MIN_OBJS = 4096;
 
-BVHTree::BVHTree(int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs)
+int BVHTree::s_buildThreads = 1;
+
+void BVHTree::SetBuildThreads(int numThreads)
 {
-	PROFILE_SCOPED()
-	Profiler::Timer timer;
-	timer.Start();
+	s_buildThreads = std::max(numThreads, 1);
+}
 
-	std::vector<int> activeObjIdxs(numObjs);
-	for (int i=0; i<numObjs; i++) activeObjIdxs[i] = i;
+// a box as the build sees it. everything the trees are built on comes from
+// float vertices, so floats lose nothing and halve the memory walked
+struct BVHTree::BuildBox {
+	float min[3], max[3];
 
-	m_objPtrAlloc = new objPtr_t[numObjs];
-	m_objPtrAllocPos = 0;
-	m_objPtrAllocMax = numObjs;
+	void Reset() {
+		min[0] = min[1] = min[2] = FLT_MAX;
+		max[0] = max[1] = max[2] = -FLT_MAX;
+	}
+	void Grow(const float *pmin, const float *pmax) {
+		// read everything first: pmin might be min, and written this way
+		// they compile to min and max instructions rather than branches
+		const float n0 = pmin[0], n1 = pmin[1], n2 = pmin[2];
+		const float x0 = pmax[0], x1 = pmax[1], x2 = pmax[2];
+		min[0] = n0 < min[0] ? n0 : min[0];
+		min[1] = n1 < min[1] ? n1 : min[1];
+		min[2] = n2 < min[2] ? n2 : min[2];
+		max[0] = x0 > max[0] ? x0 : max[0];
+		max[1] = x1 > max[1] ? x1 : max[1];
+		max[2] = x2 > max[2] ? x2 : max[2];
+	}
+	void Grow(const BuildBox &b) { Grow(b.min, b.max); }
+	float HalfArea() const {
+		const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+		return dx*dy + dy*dz + dz*dx;
+	}
+};
+
+// what the build knows of each object, kept together so that splitting a
+// node walks memory in order
+struct BVHTree::BuildObj {
+	BuildBox box;
+	objPtr_t objPtr;
+
+	// twice the centre, which sorts the same
+	float Centroid(int axis) const { return box.min[axis] + box.max[axis]; }
+};
 
-	m_bvhNodes = new BVHNode[numObjs*2 + 1];
-	m_nodeAllocPos = 0;
-	m_nodeAllocMax = numObjs*2 + 1;
+// everything the build works on, allocated once for the whole tree. nodes
+// work on disjoint ranges of it, so subtrees can be built on other threads
+struct BVHTree::Build {
+	std::vector<BuildObj> objs; // partitioned in place as nodes are split
+};
 
-	m_root = AllocNode();
-	BuildNode(m_root, objPtrs, objAabbs, activeObjIdxs);
+// a subtree for another thread
+struct BVHTree::Subtree {
+	BVHTree *tree;
+	Build *build;
+	size_t nodeIdx, begin, end;
+	BuildBox box, centroids;
+	int depth, threads;
+	size_t numLeaves;
+};
 
-	timer.Stop();
-	//Output(" - - - BVHTree::BVHTree took: %lf milliseconds\n", timer.millicycles());
+int BVHTree::BuildSubtree(void *data)
+{
+	Subtree &sub = *static_cast<Subtree*>(data);
+	sub.numLeaves = sub.tree->BuildNode(*sub.build, sub.nodeIdx, sub.begin, sub.end, sub.box, sub.centroids, sub.depth, sub.threads);
+	return 0;
 }
 
-void BVHTree::MakeLeaf(BVHNode *node, const objPtr_t *objPtrs, std::vector<objPtr_t> &objs)
+// the nearest float that's no more than d (or, with up, no less), so that
+// boxes only ever get bigger
+static inline float ToFloat(double d, bool up)
 {
-	const size_t numTris = objs.size();
-	if (numTris <= 0) Error("MakeLeaf called with no elements in objs.");
+	float f = float(d);
+	if (up ? double(f) < d : double(f) > d)
+		f = std::nextafter(f, up ? FLT_MAX : -FLT_MAX);
+	return f;
+}
 
-	if (numTris > m_objPtrAllocMax - m_objPtrAllocPos) {
-		Error("Out of space in m_objPtrAlloc. Left: " SIZET_FMT "; required: " SIZET_FMT ".", m_objPtrAllocMax - m_objPtrAllocPos, numTris);
+BVHTree::BVHTree(int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs)
+{
+	PROFILE_SCOPED()
+	if (numObjs <= 0) Error("BVHTree built with no objects.");
+
+	Build build;
+	build.objs.resize(numObjs);
+	BuildBox box, centroids;
+	box.Reset();
+	centroids.Reset();
+	for (int i=0; i<numObjs; i++) {
+		BuildObj &obj = build.objs[i];
+		for (int j=0; j<3; j++) {
+			obj.box.min[j] = ToFloat(objAabbs[i].min[j], false);
+			obj.box.max[j] = ToFloat(objAabbs[i].max[j], true);
+		}
+		obj.objPtr = objPtrs[i];
+		box.Grow(obj.box);
+		const float c[3] = { obj.Centroid(0), obj.Centroid(1), obj.Centroid(2) };
+		centroids.Grow(c, c);
 	}
 
-	node->numTris = numTris;
-	node->triIndicesStart = &m_objPtrAlloc[m_objPtrAllocPos];
-	//if (objs.size()>3) Output("fat node %d\n", objs.size());
+	m_objPtrAlloc = new objPtr_t[numObjs];
+	m_numObjs = numObjs;
 
-	// copy tri indices to the stinking flat array
-	for (int i=numTris-1; i>=0; i--) {
-		m_objPtrAlloc[m_objPtrAllocPos++] = objPtrs[objs[i]];
-	}
+	// a subtree over n objects has at most 2n-1 nodes, so each node's kids
+	// know where their nodes go before anything is built below them. the
+	// gaps left by leaves with several objects are squeezed out afterwards,
+	// and are never constructed (or even touched) before then
+	const size_t maxNodes = 2*size_t(numObjs) - 1;
+	BVHNode *nodes = static_cast<BVHNode*>(::operator new(maxNodes * sizeof(BVHNode)));
+	m_bvhNodes = nodes;
+	const size_t numLeaves = BuildNode(build, 0, 0, numObjs, box, centroids, 0, s_buildThreads);
+	Compact(nodes, numLeaves);
+	::operator delete(nodes);
 }
 
-void BVHTree::BuildNode(BVHNode *node,
-			const objPtr_t *objPtrs,
-			const Aabb *objAabbs,
-			std::vector<objPtr_t> &activeObjIdx)
+void BVHTree::MakeLeaf(Build &build, BVHNode *node, size_t begin, size_t end)
 {
-	const int numTris = activeObjIdx.size();
-	if (numTris <= 0) Error("BuildNode called with no elements in activeObjIndex.");
+	node->offset = begin;
+	node->numObjs = end - begin;
+	for (size_t i=begin; i<end; i++)
+		m_objPtrAlloc[i] = build.objs[i].objPtr;
+}
 
-	if (numTris == 1) {
-		MakeLeaf(node, objPtrs, activeObjIdx);
-		return;
-	}
+size_t BVHTree::BuildNode(Build &build, size_t nodeIdx, size_t begin, size_t end, const BuildBox &box, const BuildBox &centroids, int depth, int threads)
+{
+	BVHNode *node = new (&m_bvhNodes[nodeIdx]) BVHNode;
+	const size_t numObjs = end - begin;
+	node->min = vector3f(box.min[0], box.min[1], box.min[2]);
+	node->max = vector3f(box.max[0], box.max[1], box.max[2]);
 
-	std::vector<int> splitSides(numTris);
+	if (numObjs == 1 || depth >= MAX_DEPTH) {
+		MakeLeaf(build, node, begin, end);
+		return 1;
+	}
 
-	Aabb aabb;
-	aabb.min = vector3d(FLT_MAX, FLT_MAX, FLT_MAX);
-	aabb.max = vector3d(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	int axis = 0;
+	for (int i=1; i<3; i++) {
+		if (centroids.max[i] - centroids.min[i] > centroids.max[axis] - centroids.min[axis])
+			axis = i;
+	}
+	const float extent = centroids.max[axis] - centroids.min[axis];
 
-	for (int i=0; i<numTris; i++) {
-		const int idx = activeObjIdx[i];
-		aabb.Update(objAabbs[idx].min);
-		aabb.Update(objAabbs[idx].max);
+	BuildObj *const first = &build.objs[begin];
+	BuildObj *const last = first + numObjs;
+	size_t mid = begin + numObjs / 2;
+	BuildBox kidBoxes[2], kidCentroids[2];
+	for (int k=0; k<2; k++) {
+		kidBoxes[k].Reset();
+		kidCentroids[k].Reset();
 	}
-	node->numTris = numTris;
-	node->aabb = aabb;
-
-	Aabb splitBox = aabb;
-	double splitPos;
-	int splitAxis;
-	int s1count, s2count;
-	int attempt = 0;
-
-	for (;;) {
-		splitAxis = 0;
-
-		const vector3d boxSize = splitBox.max - splitBox.min;
-
-		if (boxSize[1] > boxSize[0]) splitAxis = 1;
-		if ((boxSize[2] > boxSize[1]) && (boxSize[2] > boxSize[0])) splitAxis = 2;
-
-		// split pos in middle of splitBox
-		splitPos = 0.5f * (splitBox.min[splitAxis] + splitBox.max[splitAxis]);
-		s1count = 0, s2count = 0;
-
-		for (int i=0; i<numTris; i++) {
-			const int idx = activeObjIdx[i];
-			const double mid = 0.5 * (objAabbs[idx].min[splitAxis] + objAabbs[idx].max[splitAxis]);
-			if (mid < splitPos) {
-				splitSides[i] = 0;
-				s1count++;
-			} else {
-				splitSides[i] = 1;
-				s2count++;
-			}
+	const float parentArea = box.HalfArea();
+	if (extent > 0.0f && parentArea > 0.0f) {
+		// small nodes don't need as many
+		const int numBins = int(std::min(numObjs, size_t(NUM_BINS)));
+		struct Bin {
+			BuildBox box, centroids;
+			size_t count;
+		} bins[NUM_BINS];
+		for (int b=0; b<numBins; b++) {
+			bins[b].box.Reset();
+			bins[b].centroids.Reset();
+			bins[b].count = 0;
 		}
 
-		if (s1count == numTris) {
-			if (attempt < MAX_SPLITPOS_RETRIES) {
-				// try splitting at average point
-				splitBox.max[splitAxis] = splitPos;
-				attempt++;
-				continue;
-			} else {
-				MakeLeaf(node, objPtrs, activeObjIdx);
-				return;
-			}
-		} else if (s2count == numTris) {
-			if (attempt < MAX_SPLITPOS_RETRIES) {
-				// try splitting at average point
-				splitBox.min[splitAxis] = splitPos;
-				attempt++;
-				continue;
-			} else {
-				MakeLeaf(node, objPtrs, activeObjIdx);
-				return;
+		const float lo = centroids.min[axis];
+		const float scale = numBins / extent;
+		auto binOf = [&](const BuildObj &obj) {
+			return std::min(int((obj.Centroid(axis) - lo) * scale), numBins - 1);
+		};
+		for (const BuildObj *obj = first; obj != last; ++obj) {
+			Bin &bin = bins[binOf(*obj)];
+			bin.box.Grow(obj->box);
+			const float c[3] = { obj->Centroid(0), obj->Centroid(1), obj->Centroid(2) };
+			bin.centroids.Grow(c, c);
+			bin.count++;
+		}
+
+		// cost of splitting after bin b: everything right of it, swept from
+		// the right, then everything left of it, swept from the left
+		double rightCost[NUM_BINS];
+		BuildBox sweep;
+		sweep.Reset();
+		size_t count = 0;
+		for (int b=numBins-1; b>0; b--) {
+			sweep.Grow(bins[b].box);
+			count += bins[b].count;
+			rightCost[b-1] = count ? double(sweep.HalfArea()) * count : -1.0;
+		}
+		sweep.Reset();
+		count = 0;
+		int bestSplit = -1;
+		double bestCost = DBL_MAX;
+		for (int b=0; b<numBins-1; b++) {
+			sweep.Grow(bins[b].box);
+			count += bins[b].count;
+			if (!count || rightCost[b] < 0.0) continue;
+			const double cost = TRAVERSAL_COST + (double(sweep.HalfArea()) * count + rightCost[b]) / parentArea;
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestSplit = b;
 			}
 		}
-		break;
+
+		if (bestSplit < 0 || (bestCost >= double(numObjs) && numObjs <= MAX_LEAF_OBJS)) {
+			MakeLeaf(build, node, begin, end);
+			return 1;
+		}
+		for (int b=0; b<numBins; b++) {
+			kidBoxes[b > bestSplit].Grow(bins[b].box);
+			kidCentroids[b > bestSplit].Grow(bins[b].centroids);
+		}
+		mid = begin + (std::partition(first, last,
+			[&](const BuildObj &obj) { return binOf(obj) <= bestSplit; }) - first);
+	} else if (numObjs <= MAX_LEAF_OBJS) {
+		// everything in one place. nothing will split these usefully
+		MakeLeaf(build, node, begin, end);
+		return 1;
+	} else {
+		// flat or all in one place: halve them along the axis
+		std::nth_element(first, first + (mid - begin), last,
+			[&](const BuildObj &a, const BuildObj &b) { return a.Centroid(axis) < b.Centroid(axis); });
+		for (size_t i=begin; i<end; i++) {
+			const BuildObj &obj = build.objs[i];
+			kidBoxes[i >= mid].Grow(obj.box);
+			const float c[3] = { obj.Centroid(0), obj.Centroid(1), obj.Centroid(2) };
+			kidCentroids[i >= mid].Grow(c, c);
+		}
 	}
+	assert(mid > begin && mid < end);
 
-	std::vector<int> side[2];
-	side[0].reserve(numTris);
-	side[1].reserve(numTris);
+	const size_t left = nodeIdx + 1;
+	const size_t right = nodeIdx + 2*(mid - begin);
+	node->offset = right - nodeIdx;
+	node->numObjs = 0;
 
-	for (int i=0; i<numTris; i++) {
-		side[splitSides[i]].push_back(activeObjIdx[i]);
+	SDL_Thread *thread = nullptr;
+	Subtree sub = { this, &build, left, begin, mid, kidBoxes[0], kidCentroids[0], depth + 1, threads / 2, 0 };
+	if (threads > 1 && numObjs >= PARALLEL_MIN_OBJS)
+		thread = SDL_CreateThread(&BuildSubtree, "BVHTree", &sub);
+	if (thread) {
+		const size_t rightLeaves = BuildNode(build, right, mid, end, kidBoxes[1], kidCentroids[1], depth + 1, threads - threads / 2);
+		SDL_WaitThread(thread, nullptr);
+		return sub.numLeaves + rightLeaves;
 	}
+	return BuildNode(build, left, begin, mid, kidBoxes[0], kidCentroids[0], depth + 1, 1)
+		+ BuildNode(build, right, mid, end, kidBoxes[1], kidCentroids[1], depth + 1, 1);
+}
+
+void BVHTree::Compact(const BVHNode *nodes, size_t numLeaves)
+{
+	// every node has no kids or two, so there's one fewer inner node than leaves
+	m_numNodes = 2*numLeaves - 1;
+	m_bvhNodes = new BVHNode[m_numNodes];
 
-	// recurse!
-	node->triIndicesStart = 0;
-	node->kids[0] = AllocNode();
-	node->kids[1] = AllocNode();
+	// depth first, so that each first kid follows its parent and each second
+	// kid follows its sibling's subtree. the stack holds the scratch node to
+	// copy next, and the node it's the second kid of (or m_numNodes)
+	std::vector< std::pair<size_t, size_t> > stack;
+	stack.push_back(std::make_pair(size_t(0), m_numNodes));
+	size_t pos = 0;
+	while (!stack.empty()) {
+		const size_t src = stack.back().first;
+		const size_t parent = stack.back().second;
+		stack.pop_back();
 
-	BuildNode(node->kids[0], objPtrs, objAabbs, side[0]);
-	BuildNode(node->kids[1], objPtrs, objAabbs, side[1]);
-}
\ No newline at end of file
+		if (parent != m_numNodes)
+			m_bvhNodes[parent].offset = pos - parent;
+		const BVHNode &node = nodes[src];
+		m_bvhNodes[pos] = node;
+		if (!node.IsLeaf()) {
+			stack.push_back(std::make_pair(src + node.offset, pos));
+			stack.push_back(std::make_pair(src + 1, m_numNodes));
+		}
+		pos++;
+	}
+	assert(pos == m_numNodes);
+}
+
+// the nodes are written as they are in memory. like Float and Double this
+// isn't portable across architectures
+void BVHTree::Save(Serializer::Writer &wr) const
+{
+	PROFILE_SCOPED()
+	wr.Int32(m_numObjs);
+	wr.Int32(m_numNodes);
+	wr.Blob(m_objPtrAlloc, m_numObjs * sizeof(objPtr_t));
+	wr.Blob(m_bvhNodes, m_numNodes * sizeof(BVHNode));
+}
+
+BVHTree::BVHTree(Serializer::Reader &rd)
+{
+	PROFILE_SCOPED()
+	m_numObjs = rd.Int32();
+	m_numNodes = rd.Int32();
+	const ByteRange objs = rd.Blob();
+	const ByteRange nodes = rd.Blob();
+	if (!m_numNodes || objs.Size() != m_numObjs * sizeof(objPtr_t) || nodes.Size() != m_numNodes * sizeof(BVHNode))
+		Error("BVHTree: saved tree is truncated.");
+
+	m_objPtrAlloc = new objPtr_t[m_numObjs];
+	memcpy(m_objPtrAlloc, objs.begin, objs.Size());
+	m_bvhNodes = new BVHNode[m_numNodes];
+	// copied as bytes, as the blob needn't be aligned for BVHNode
+	memcpy(m_bvhNodes, nodes.begin, nodes.Size());
+
+#ifndef NDEBUG
+	for (size_t i=0; i<m_numNodes; i++) {
+		const BVHNode &node = m_bvhNodes[i];
+		if (node.IsLeaf())
+			assert(size_t(node.offset) + node.numObjs <= m_numObjs);
+		else
+			assert(i + 1 < m_numNodes && node.offset > 1 && i + node.offset < m_numNodes);
+	}
+#endif
+}
@@ -5,57 +5,72 @@
 #define _BVHTREE_H
 
 #include <assert.h>
+#include <type_traits>
 #include <vector>
 #include "../vector3.h"
 #include "../Aabb.h"
 #include "../utils.h"
 
-struct BVHNode {
-	Aabb aabb;
-
-	/* if triIndicesStart == 0 then not leaf,
-	 * kids[] valid */
-	int numTris;
-	int *triIndicesStart;
+namespace Serializer {
+	class Reader;
+	class Writer;
+}
 
-	BVHNode *kids[2];
+// 32 bytes, so two share a cache line
+struct BVHNode {
+	vector3f min, max;
+	// a leaf's objects are the numObjs entries of its tree's object list
+	// from offset. an inner node's first kid is the node right after it,
+	// and its second kid is offset nodes on from it
+	Uint32 offset;
+	Uint32 numObjs; // 0 for inner nodes
 
-	BVHNode() : numTris(0), triIndicesStart(nullptr) {
-		kids[0] = nullptr;
-		kids[1] = nullptr;
-	}
-	bool IsLeaf() const {
-		return triIndicesStart != nullptr;
-	}
+	bool IsLeaf() const { return numObjs != 0; }
+	const BVHNode *GetKid(int i) const { return i ? this + offset : this + 1; }
 };
+static_assert(sizeof(BVHNode) == 32, "BVHNode should be 32 bytes");
+static_assert(std::is_trivially_copyable<BVHNode>::value, "BVHNode is saved and loaded as bytes");
 
+// Nodes are stored in one array, depth first
 class BVHTree {
 public:
 	typedef int objPtr_t;
 	BVHTree(const int numObjs, const objPtr_t *objPtrs, const Aabb *objAabbs);
+	// a tree as written by Save, without building anything
+	BVHTree(Serializer::Reader &rd);
 	~BVHTree() {
 		delete [] m_objPtrAlloc;
 		delete [] m_bvhNodes;
 	}
-	BVHNode *GetRoot() { return m_root; }
+	const BVHNode *GetRoot() const { return m_bvhNodes; }
+	// the objects of a leaf
+	const objPtr_t *GetObjs(const BVHNode *leaf) const { return &m_objPtrAlloc[leaf->offset]; }
+
+	void Save(Serializer::Writer &wr) const;
+
+	// the most threads that may build a tree at once: the two halves of a big
+	// node are built side by side. 1 (the default) keeps to the calling thread
+	static void SetBuildThreads(int numThreads);
+
 private:
-	void BuildNode(BVHNode *node,
-			const objPtr_t *objPtrs,
-			const Aabb *objAabbs,
-			std::vector<objPtr_t> &activeObjIdxs);
-	void MakeLeaf(BVHNode *node, const objPtr_t *objPtrs, std::vector<objPtr_t> &objs);
-	BVHNode *AllocNode() {
-		if (m_nodeAllocPos >= m_nodeAllocMax) Error("Out of space in m_bvhNodes.");
-		return &m_bvhNodes[m_nodeAllocPos++];
-	}
-	BVHNode *m_root;
+	struct BuildBox;
+	struct BuildObj;
+	struct Build;
+	struct Subtree;
+
+	static int BuildSubtree(void *subtree);
+	// answers how many leaves it made
+	size_t BuildNode(Build &build, size_t nodeIdx, size_t begin, size_t end, const BuildBox &box, const BuildBox &centroids, int depth, int threads);
+	void MakeLeaf(Build &build, BVHNode *node, size_t begin, size_t end);
+	void Compact(const BVHNode *nodes, size_t numLeaves);
+
 	objPtr_t *m_objPtrAlloc;
-	size_t m_objPtrAllocPos;
-	size_t m_objPtrAllocMax;
+	size_t m_numObjs;
 
 	BVHNode *m_bvhNodes;
-	size_t m_nodeAllocPos;
-	size_t m_nodeAllocMax;
+	size_t m_numNodes;
+
+	static int s_buildThreads;
 };
 
 #endif /* _BVHTREE_H */
@@ -13,8 +13,11 @@ struct CollisionContact {
 	int triIdx;
 	void *userData1, *userData2;
 	int geomFlag;
+	// not touching yet: pos is where the geoms first meet if they carry on
+	// the way they're going, dist of the way there and depth the rest of it
+	bool swept;
 //	bool vsStatic;		// true => object 2 was in static, else dynamic
-	CollisionContact() : depth(0), dist(0), triIdx(-1), userData1(nullptr), userData2(nullptr), geomFlag(0) { /*empty*/ }
+	CollisionContact() : depth(0), dist(0), triIdx(-1), userData1(nullptr), userData2(nullptr), geomFlag(0), swept(false) { /*empty*/ }
 };
 
 #endif /* _COLLISION_CONTACT_H */
@@ -118,7 +118,17 @@ void BvhTree::CollideGeom(Geom *g, const Aabb &geomAabb, int minMailboxValue, vo
 					if (g->GetGroup() && g2->GetGroup() == g->GetGroup()) continue;
 					double radius2 = g2->GetGeomTree()->GetRadius();
 					vector3d pos2 = g2->GetPosition();
-					if ((pos-pos2).Length() <= (radius + radius2)) {
+					const vector3d relSweep = g->GetSweep() - g2->GetSweep();
+					const double minRadius = std::min(radius, radius2);
+					if (relSweep.LengthSqr() > minRadius*minRadius) {
+						// far enough to go through one or the other in a
+						// step: sweep them, if their spheres meet on the way
+						const vector3d rel = pos - pos2;
+						const double t = Clamp(-rel.Dot(relSweep) / relSweep.LengthSqr(), 0.0, 1.0);
+						if ((rel + relSweep*t).Length() <= (radius + radius2)) {
+							g->CollideSwept(g2, relSweep, callback);
+						}
+					} else if ((pos-pos2).Length() <= (radius + radius2)) {
 						g->Collide(g2, callback);
 					}
 				}
@@ -148,10 +158,14 @@ void BvhTree::BuildNode(BvhNode *node, const std::list<Geom*> &a_geoms, int &out
 
 	for (std::list<Geom*>::const_iterator i = a_geoms.begin();
 			i != a_geoms.end(); ++i) {
+		// and all the way along the geom's sweep
 		vector3d p = (*i)->GetPosition();
+		vector3d p2 = p + (*i)->GetSweep();
 		double rad = (*i)->GetGeomTree()->GetRadius();
 		aabb.Update(p + vector3d(rad,rad,rad));
 		aabb.Update(p - vector3d(rad,rad,rad));
+		aabb.Update(p2 + vector3d(rad,rad,rad));
+		aabb.Update(p2 - vector3d(rad,rad,rad));
 	}
 
 	// divide by longest axis
@@ -273,6 +287,23 @@ void CollisionSpace::CollideRaySphere(const vector3d &start, const vector3d &dir
 	}
 }
 
+// fills in c for a ray that hit g at isect
+static void SetRayContact(Geom *g, const vector3d &start, const vector3d &dir, double len, const isect_t &isect, CollisionContact *c)
+{
+	c->pos = start + dir*double(isect.dist);
+
+	vector3f n = g->GetGeomTree()->GetTriNormal(isect.triIdx);
+	c->normal = vector3d(n.x, n.y, n.z);
+	c->normal = g->GetTransform().ApplyRotationOnly(c->normal);
+
+	c->depth = len - isect.dist;
+	c->triIdx = isect.triIdx;
+	c->userData1 = g->GetUserData();
+	c->userData2 = 0;
+	c->geomFlag = g->GetGeomTree()->GetTriFlag(isect.triIdx);
+	c->dist = isect.dist;
+}
+
 void CollisionSpace::TraceRay(const vector3d &start, const vector3d &dir, double len, CollisionContact *c)
 {
 	PROFILE_SCOPED()
@@ -308,20 +339,8 @@ void CollisionSpace::TraceRay(const vector3d &start, const vector3d &dir, double
 				isect.dist = float(c->dist);
 				isect.triIdx = -1;
 				g->GetGeomTree()->TraceRay(modelStart, modelDir, &isect);
-				if (isect.triIdx != -1) {
-					c->pos = start + dir*double(isect.dist);
-
-					vector3f n = g->GetGeomTree()->GetTriNormal(isect.triIdx);
-					c->normal = vector3d(n.x, n.y, n.z);
-					c->normal = g->GetTransform().ApplyRotationOnly(c->normal);
-
-					c->depth = len - isect.dist;
-					c->triIdx = isect.triIdx;
-					c->userData1 = g->GetUserData();
-					c->userData2 = 0;
-					c->geomFlag = g->GetGeomTree()->GetTriFlag(isect.triIdx);
-					c->dist = isect.dist;
-				}
+				if (isect.triIdx != -1)
+					SetRayContact(g, start, dir, len, isect, c);
 			}
 		} else if (node->kids[0]) {
 			vn_stack[++stackPos] = node->kids[0];
@@ -345,37 +364,115 @@ pop_jizz:
 			isect.dist = float(c->dist);
 			isect.triIdx = -1;
 			(*i)->GetGeomTree()->TraceRay(modelStart, modelDir, &isect);
-			if (isect.triIdx != -1) {
-				c->pos = start + dir*double(isect.dist);
-
-				vector3f n = (*i)->GetGeomTree()->GetTriNormal(isect.triIdx);
-				c->normal = vector3d(n.x, n.y, n.z);
-				c->normal = (*i)->GetTransform().ApplyRotationOnly(c->normal);
-
-				c->depth = len - isect.dist;
-				c->triIdx = isect.triIdx;
-				c->userData1 = (*i)->GetUserData();
-				c->userData2 = 0;
-				c->geomFlag = (*i)->GetGeomTree()->GetTriFlag(isect.triIdx);
-				c->dist = isect.dist;
-			}
+			if (isect.triIdx != -1)
+				SetRayContact(*i, start, dir, len, isect, c);
 		}
 	}
-	{
+	TraceRaySphere(start, dir, len, c);
+}
+
+void CollisionSpace::TraceRaySphere(const vector3d &start, const vector3d &dir, double len, CollisionContact *c)
+{
+	isect_t isect;
+	isect.dist = float(c->dist);
+	isect.triIdx = -1;
+	CollideRaySphere(start, dir, &isect);
+	if (isect.triIdx != -1) {
+		c->pos = start + dir*double(isect.dist);
+		c->normal = vector3d(0.0);
+		c->depth = len - isect.dist;
+		c->triIdx = -1;
+		c->userData1 = sphere.userData;
+		c->userData2 = 0;
+		c->geomFlag = 0;
+	}
+}
+
+// traces the rays listed in rays through g's GeomTree, a packet at a time
+static void TraceGeomRays(Geom *g, int numRays, const int *rays, const vector3d *starts, const vector3d *dirs, const double *lens, CollisionContact *cs)
+{
+	const matrix4x4d &invTrans = g->GetInvTransform();
+	vector3f modelStarts[GeomTree::RAY_PACKET];
+	vector3f modelDirs[GeomTree::RAY_PACKET];
+	isect_t isects[GeomTree::RAY_PACKET];
+
+	for (int first = 0; first < numRays; first += GeomTree::RAY_PACKET) {
+		const int num = std::min(numRays - first, GeomTree::RAY_PACKET);
+		for (int i=0; i<num; i++) {
+			const int r = rays[first+i];
+			vector3d ms = invTrans * starts[r];
+			vector3d md = invTrans.ApplyRotationOnly(dirs[r]);
+			modelStarts[i] = vector3f(ms.x, ms.y, ms.z);
+			modelDirs[i] = vector3f(md.x, md.y, md.z);
+			isects[i].dist = float(cs[r].dist);
+			isects[i].triIdx = -1;
+		}
+		g->GetGeomTree()->TraceRays(num, modelStarts, modelDirs, isects);
+		for (int i=0; i<num; i++) {
+			const int r = rays[first+i];
+			if (isects[i].triIdx != -1)
+				SetRayContact(g, starts[r], dirs[r], lens[r], isects[i], &cs[r]);
+		}
+	}
+}
+
+void CollisionSpace::TraceRays(int numRays, const vector3d *starts, const vector3d *dirs, const double *lens, CollisionContact *cs)
+{
+	PROFILE_SCOPED()
+	// the static geoms each ray reaches, found a ray at a time as in
+	// TraceRay, then gathered up by geom
+	std::vector<std::pair<Geom*, int> > reached;
+	for (int r=0; r<numRays; r++) {
+		cs[r].dist = lens[r];
+		const vector3d &dir = dirs[r];
+		vector3d invDir(1.0/dir.x, 1.0/dir.y, 1.0/dir.z);
 		isect_t isect;
-		isect.dist = float(c->dist);
+		isect.dist = float(lens[r]);
 		isect.triIdx = -1;
-		CollideRaySphere(start, dir, &isect);
-		if (isect.triIdx != -1) {
-			c->pos = start + dir*double(isect.dist);
-			c->normal = vector3d(0.0);
-			c->depth = len - isect.dist;
-			c->triIdx = -1;
-			c->userData1 = sphere.userData;
-			c->userData2 = 0;
-			c->geomFlag = 0;
+
+		BvhNode *vn_stack[16];
+		BvhNode *node = m_staticObjectTree ? m_staticObjectTree->m_root : 0;
+		int stackPos = -1;
+
+		for (;node;) {
+			if (node->CollideRay(starts[r], invDir, &isect)) {
+				if (node->geomStart) {
+					for (int i=0; i<node->numGeoms; i++)
+						reached.push_back(std::make_pair(node->geomStart[i], r));
+				} else if (node->kids[0]) {
+					vn_stack[++stackPos] = node->kids[0];
+					node = node->kids[1];
+					continue;
+				}
+			}
+			if (stackPos < 0) break;
+			node = vn_stack[stackPos--];
 		}
 	}
+	std::sort(reached.begin(), reached.end());
+
+	std::vector<int> rays;
+	for (size_t begin = 0; begin < reached.size(); ) {
+		Geom *g = reached[begin].first;
+		rays.clear();
+		size_t end = begin;
+		for (; end < reached.size() && reached[end].first == g; end++)
+			rays.push_back(reached[end].second);
+		TraceGeomRays(g, int(rays.size()), rays.data(), starts, dirs, lens, cs);
+		begin = end;
+	}
+
+	// every ray goes to every dynamic geom, as in TraceRay
+	rays.resize(numRays);
+	for (int r=0; r<numRays; r++)
+		rays[r] = r;
+	for (Geom *g : m_geoms) {
+		if (g->IsEnabled())
+			TraceGeomRays(g, numRays, rays.data(), starts, dirs, lens, cs);
+	}
+
+	for (int r=0; r<numRays; r++)
+		TraceRaySphere(starts[r], dirs[r], lens[r], &cs[r]);
 }
 
 /*
@@ -391,6 +488,9 @@ void CollisionSpace::CollideGeoms(Geom *a, int minMailboxValue, void (*callback)
 	Aabb ourAabb;
 	ourAabb.min = pos - vector3d(radius, radius, radius);
 	ourAabb.max = pos + vector3d(radius, radius, radius);
+	// swept along the way it's going
+	ourAabb.Update(pos + a->GetSweep() - vector3d(radius, radius, radius));
+	ourAabb.Update(pos + a->GetSweep() + vector3d(radius, radius, radius));
 
 	if (m_staticObjectTree) m_staticObjectTree->CollideGeom(a, ourAabb, 0, callback);
 	if (m_dynamicObjectTree) m_dynamicObjectTree->CollideGeom(a, ourAabb, minMailboxValue, callback);
@@ -31,6 +31,10 @@ public:
 	void AddStaticGeom(Geom*);
 	void RemoveStaticGeom(Geom*);
 	void TraceRay(const vector3d &start, const vector3d &dir, double len, CollisionContact *c);
+	// TraceRay for each of numRays rays. the rays that reach each geom go
+	// down its GeomTree together, so rays near each other should be
+	// next to each other
+	void TraceRays(int numRays, const vector3d *starts, const vector3d *dirs, const double *lens, CollisionContact *cs);
 	void Collide(void (*callback)(CollisionContact*));
 	void SetSphere(const vector3d &pos, double radius, void *user_data) {
 		sphere.pos = pos; sphere.radius = radius; sphere.userData = user_data;
@@ -46,6 +50,7 @@ public:
 private:
 	void CollideGeoms(Geom *a, int minMailboxValue, void (*callback)(CollisionContact*));
 	void CollideRaySphere(const vector3d &start, const vector3d &dir, isect_t *isect);
+	void TraceRaySphere(const vector3d &start, const vector3d &dir, double len, CollisionContact *c);
 	std::list<Geom*> m_geoms;
 	std::list<Geom*> m_staticGeoms;
 	bool m_needStaticGeomRebuild;
@@ -8,6 +8,13 @@
 #include "BVHTree.h"
 
 static const unsigned int MAX_CONTACTS = 8;
+// how close a swept vertex can start to what it hits and still be touching it
+static const double SWEEP_TOUCHING_DIST = 0.01;
+
+// scratch for SweepVerticesOnto, kept between calls so a pair's sweep doesn't
+// allocate each step. collision is only done on the main thread
+static std::vector<int> s_sweepVertices;
+static std::vector<bool> s_sweepSeen;
 
 Geom::Geom(const GeomTree *geomtree) :
 	m_mailboxIndex(0),
@@ -16,7 +23,8 @@ Geom::Geom(const GeomTree *geomtree) :
 	m_active(true),
 	m_geomtree(geomtree),
 	m_data(nullptr),
-	m_group(0)
+	m_group(0),
+	m_sweep(0.0)
 {
 }
 
@@ -74,11 +82,36 @@ void Geom::CollideSphere(Sphere &sphere, void (*callback)(CollisionContact*))
 	}
 }
 
+// the box around node a's box, once transformed by transA
+static void rotatedNodeAabb(const BVHNode *a, const matrix4x4d &transA, Aabb &arot)
+{
+	PROFILE_SCOPED()
+	vector3d p[8];
+	p[0] = transA * vector3d(a->min.x, a->min.y, a->min.z);
+	p[1] = transA * vector3d(a->min.x, a->min.y, a->max.z);
+	p[2] = transA * vector3d(a->min.x, a->max.y, a->min.z);
+	p[3] = transA * vector3d(a->min.x, a->max.y, a->max.z);
+	p[4] = transA * vector3d(a->max.x, a->min.y, a->min.z);
+	p[5] = transA * vector3d(a->max.x, a->min.y, a->max.z);
+	p[6] = transA * vector3d(a->max.x, a->max.y, a->min.z);
+	p[7] = transA * vector3d(a->max.x, a->max.y, a->max.z);
+	arot.min = arot.max = p[0];
+	for (int i=1; i<8; i++) arot.Update(p[i]);
+}
+
+// as Aabb::Intersects
+static bool aabbIsectsNode(const Aabb &a, const BVHNode *b)
+{
+	return (a.min.x < b->max.x) && (a.max.x > b->min.x) &&
+		(a.min.y < b->max.y) && (a.max.y > b->min.y) &&
+		(a.min.z < b->max.z) && (a.max.z > b->min.z);
+}
+
 /*
  * This geom has moved, causing a possible collision with geom b.
- * Collide meshes to see.
+ * Collide meshes to see. Answers how many contacts were reported.
  */
-void Geom::Collide(Geom *b, void (*callback)(CollisionContact*))
+int Geom::Collide(Geom *b, void (*callback)(CollisionContact*))
 {
 	PROFILE_SCOPED()
 	int max_contacts = MAX_CONTACTS;
@@ -93,28 +126,157 @@ void Geom::Collide(Geom *b, void (*callback)(CollisionContact*))
 		transTo = m_invOrient * b->m_orient;
 		b->CollideEdgesWithTrisOf(max_contacts, this, transTo, callback);
 	}
+	return MAX_CONTACTS - max_contacts;
 
 //	t = SDL_GetTicks() - t;
 //	int numEdges = GetGeomTree()->GetNumEdges() + b->GetGeomTree()->GetNumEdges();
 //	Output("%d 'rays' in %dms (%f rps)\n", numEdges, t, 1000.0*numEdges / (double)t);
 }
 
-static bool rotatedAabbIsectsNormalOne(Aabb &a, const matrix4x4d &transA, Aabb &b)
+void Geom::CollideSwept(Geom *b, const vector3d &relSweep, void (*callback)(CollisionContact*))
 {
 	PROFILE_SCOPED()
-	Aabb arot;
-	vector3d p[8];
-	p[0] = transA * vector3d(a.min.x, a.min.y, a.min.z);
-	p[1] = transA * vector3d(a.min.x, a.min.y, a.max.z);
-	p[2] = transA * vector3d(a.min.x, a.max.y, a.min.z);
-	p[3] = transA * vector3d(a.min.x, a.max.y, a.max.z);
-	p[4] = transA * vector3d(a.max.x, a.min.y, a.min.z);
-	p[5] = transA * vector3d(a.max.x, a.min.y, a.max.z);
-	p[6] = transA * vector3d(a.max.x, a.max.y, a.min.z);
-	p[7] = transA * vector3d(a.max.x, a.max.y, a.max.z);
-	arot.min = arot.max = p[0];
-	for (int i=1; i<8; i++) arot.Update(p[i]);
-	return b.Intersects(arot);
+	// if they're touching already that's what's reported, as the response
+	// to it stops them going any further into each other anyway
+	const double radius = GetGeomTree()->GetRadius() + b->GetGeomTree()->GetRadius();
+	if ((GetPosition() - b->GetPosition()).Length() <= radius && Collide(b, callback) > 0)
+		return;
+
+	/* Otherwise conservative advancement, as far as the meshes go: each
+	 * geom's vertices are traced along the sweep onto the other's triangles,
+	 * and the first hit is where they'd meet. Rotation over the step is left
+	 * out, and edges passing through edges are left to Collide next time */
+	CollisionContact contact, bContact;
+	bool hit = SweepVerticesOnto(b, relSweep, contact);
+	if (b->SweepVerticesOnto(this, -relSweep, bContact) && (!hit || bContact.dist < contact.dist)) {
+		contact = bContact;
+		hit = true;
+	}
+	if (!hit) return;
+	// a vertex that's all but on the other's surface already (as when the
+	// geoms were stopped where they'd meet last step) is as good as touching
+	if (contact.dist < SWEEP_TOUCHING_DIST) {
+		contact.swept = false;
+		contact.depth = 0.0;
+	}
+	callback(&contact);
+}
+
+/*
+ * Trace this geom's vertices along sweep onto geom b's triangles. Answers
+ * whether any hit, with contact for the first of them.
+ */
+bool Geom::SweepVerticesOnto(Geom *b, const vector3d &sweep, CollisionContact &contact)
+{
+	PROFILE_SCOPED()
+	const double len = sweep.Length();
+	if (len <= 0.0 || GetGeomTree()->GetNumEdges() == 0) return false;
+
+	// only the vertices that could reach b on the way are traced, so that a
+	// station's thousands aren't when a ship goes by one end of it: the ends
+	// of the edges in the leaves of this geom's edge tree that meet b's box,
+	// swept back along the way this geom goes (all in this geom's space)
+	const Aabb &bAabb = b->GetGeomTree()->GetAabb();
+	BVHNode bNode;
+	bNode.min = vector3f(bAabb.min);
+	bNode.max = vector3f(bAabb.max);
+	Aabb reach;
+	rotatedNodeAabb(&bNode, m_invOrient * b->m_orient, reach);
+	const vector3d back = -m_invOrient.ApplyRotationOnly(sweep);
+	reach.Update(reach.min + back);
+	reach.Update(reach.max + back);
+
+	const int numAllVertices = GetGeomTree()->GetNumVertices();
+	std::vector<int> &vertices = s_sweepVertices;
+	vertices.clear();
+	const BVHTree *edgeTree = GetGeomTree()->GetEdgeTree();
+	const BVHNode *root = edgeTree->GetRoot();
+	if (reach.min.x <= root->min.x && reach.min.y <= root->min.y && reach.min.z <= root->min.z &&
+		reach.max.x >= root->max.x && reach.max.y >= root->max.y && reach.max.z >= root->max.z) {
+		// all of them, as when the geoms are about the same size
+		vertices.resize(numAllVertices);
+		for (int i=0; i<numAllVertices; i++) vertices[i] = i;
+	} else {
+		const GeomTree::Edge *edges = GetGeomTree()->GetEdges();
+		std::vector<bool> &seen = s_sweepSeen;
+		if (int(seen.size()) < numAllVertices) seen.resize(numAllVertices, false);
+		const BVHNode *stack[32];
+		int stackpos = -1;
+		const BVHNode *node = root;
+		for (;;) {
+			if (aabbIsectsNode(reach, node)) {
+				if (!node->IsLeaf()) {
+					stack[++stackpos] = node->GetKid(1);
+					node = node->GetKid(0);
+					continue;
+				}
+				const BVHTree::objPtr_t *objs = edgeTree->GetObjs(node);
+				for (Uint32 i=0; i<node->numObjs; i++) {
+					const GeomTree::Edge &e = edges[objs[i]];
+					if (!seen[e.v1i]) { seen[e.v1i] = true; vertices.push_back(e.v1i); }
+					if (!seen[e.v2i]) { seen[e.v2i] = true; vertices.push_back(e.v2i); }
+				}
+			}
+			if (stackpos < 0) break;
+			node = stack[stackpos--];
+		}
+		for (int v : vertices) seen[v] = false;
+		if (vertices.empty()) return false;
+	}
+
+	const matrix4x4d transToB = b->m_invOrient * m_orient;
+	const vector3d _dir = b->m_invOrient.ApplyRotationOnly(sweep) * (1.0 / len);
+	const vector3f dir(float(_dir.x), float(_dir.y), float(_dir.z));
+
+	// the vertices all go the same way, so a packet of them goes down b's
+	// tree together
+	vector3f starts[GeomTree::RAY_PACKET];
+	vector3f dirs[GeomTree::RAY_PACKET];
+	isect_t isects[GeomTree::RAY_PACKET];
+	for (int i=0; i<GeomTree::RAY_PACKET; i++) dirs[i] = dir;
+
+	isect_t first;
+	first.dist = float(len);
+	first.triIdx = -1;
+	vector3d firstFrom;
+
+	const std::vector<vector3f> &rVertices = GetGeomTree()->GetVertices();
+	const int numVertices = int(vertices.size());
+	for (int v = 0; v < numVertices; v += GeomTree::RAY_PACKET) {
+		const int num = std::min(numVertices - v, GeomTree::RAY_PACKET);
+		for (int i=0; i<num; i++) {
+			const vector3d from = transToB * vector3d(rVertices[vertices[v+i]]);
+			starts[i] = vector3f(float(from.x), float(from.y), float(from.z));
+			isects[i].dist = first.dist;
+			isects[i].triIdx = -1;
+		}
+		b->GetGeomTree()->TraceRays(num, starts, dirs, isects);
+		for (int i=0; i<num; i++) {
+			if (isects[i].triIdx == -1 || isects[i].dist >= first.dist) continue;
+			first = isects[i];
+			firstFrom = vector3d(starts[i].x, starts[i].y, starts[i].z);
+		}
+	}
+	if (first.triIdx == -1) return false;
+
+	// in world coords, where the vertex is now rather than where it'd hit,
+	// as that's what the bodies' responses work out their lever arms from
+	contact.pos = b->GetTransform() * firstFrom;
+	vector3f n = b->m_geomtree->GetTriNormal(first.triIdx);
+	contact.normal = b->GetTransform().ApplyRotationOnly(vector3d(n.x, n.y, n.z));
+	// thin things are hit from either side, so the normal faces back along
+	// the sweep whichever side it was
+	if (contact.normal.Dot(sweep) > 0.0)
+		contact.normal = -contact.normal;
+	contact.dist = first.dist;
+	// how far the vertex would have gone through
+	contact.depth = len - first.dist;
+	contact.triIdx = first.triIdx;
+	contact.userData1 = m_data;
+	contact.userData2 = b->m_data;
+	contact.geomFlag = b->m_geomtree->GetTriFlag(first.triIdx);
+	contact.swept = true;
+	return true;
 }
 
 /*
@@ -125,8 +287,8 @@ void Geom::CollideEdgesWithTrisOf(int &maxContacts, Geom *b, const matrix4x4d &t
 {
 	PROFILE_SCOPED()
 	struct stackobj {
-		BVHNode *edgeNode;
-		BVHNode *triNode;
+		const BVHNode *edgeNode;
+		const BVHNode *triNode;
 	} stack[32];
 	int stackpos = 0;
 
@@ -134,43 +296,45 @@ void Geom::CollideEdgesWithTrisOf(int &maxContacts, Geom *b, const matrix4x4d &t
 	stack[0].triNode = b->GetGeomTree()->GetTriTree()->GetRoot();
 
 	while ((stackpos >= 0) && (maxContacts > 0)) {
-		BVHNode *edgeNode = stack[stackpos].edgeNode;
-		BVHNode *triNode = stack[stackpos].triNode;
+		const BVHNode *edgeNode = stack[stackpos].edgeNode;
+		const BVHNode *triNode = stack[stackpos].triNode;
 		stackpos--;
 
 		// does the edgeNode (with its aabb described in 6 planes transformed and rotated to
 		// b's coordinates) intersect with one or other of b's child nodes?
-		if (triNode->triIndicesStart || edgeNode->triIndicesStart) {
+		if (triNode->IsLeaf() || edgeNode->IsLeaf()) {
 			// reached triangle leaf node or edge leaf node.
 			// Intersect all edges under edgeNode with this leaf
 			CollideEdgesTris(maxContacts, edgeNode, transTo, b, triNode, callback);
 		} else {
-			BVHNode *left = triNode->kids[0];
-			BVHNode *right = triNode->kids[1];
-			bool edgeNodeIsectsLeftChild = rotatedAabbIsectsNormalOne(edgeNode->aabb, transTo, left->aabb);
-			bool edgeNodeIsectsRightChild = rotatedAabbIsectsNormalOne(edgeNode->aabb, transTo, right->aabb);
+			const BVHNode *left = triNode->GetKid(0);
+			const BVHNode *right = triNode->GetKid(1);
+			Aabb edgeAabb;
+			rotatedNodeAabb(edgeNode, transTo, edgeAabb);
+			bool edgeNodeIsectsLeftChild = aabbIsectsNode(edgeAabb, left);
+			bool edgeNodeIsectsRightChild = aabbIsectsNode(edgeAabb, right);
 			//edgeNodeIsectsRightChild = edgeNodeIsectsLeftChild = true;
 			if (edgeNodeIsectsRightChild) {
 				if (edgeNodeIsectsLeftChild) {
 					// isects both. split edgeNode and try again
 					++stackpos;
-					stack[stackpos].edgeNode = edgeNode->kids[0];
+					stack[stackpos].edgeNode = edgeNode->GetKid(0);
 					stack[stackpos].triNode = triNode;
 					++stackpos;
-					stack[stackpos].edgeNode = edgeNode->kids[1];
+					stack[stackpos].edgeNode = edgeNode->GetKid(1);
 					stack[stackpos].triNode = triNode;
 				} else {
 					// hits only right child. go down into that
 					// side with same edge node
 					++stackpos;
 					stack[stackpos].edgeNode = edgeNode;
-					stack[stackpos].triNode = triNode->kids[1];
+					stack[stackpos].triNode = triNode->GetKid(1);
 				}
 			} else if (edgeNodeIsectsLeftChild) {
 				// hits only left child
 				++stackpos;
 				stack[stackpos].edgeNode = edgeNode;
-				stack[stackpos].triNode = triNode->kids[0];
+				stack[stackpos].triNode = triNode->GetKid(0);
 			} else {
 				// hits none
 			}
@@ -187,31 +351,32 @@ void Geom::CollideEdgesTris(int &maxContacts, const BVHNode *edgeNode, const mat
 {
 	PROFILE_SCOPED()
 	if (maxContacts <= 0) return;
-	if (edgeNode->triIndicesStart) {
+	if (edgeNode->IsLeaf()) {
 		const GeomTree::Edge *edges = this->GetGeomTree()->GetEdges();
+		const BVHTree::objPtr_t *edgeIdxs = GetGeomTree()->GetEdgeTree()->GetObjs(edgeNode);
 		int numContacts = 0;
 		vector3f dir;
 		isect_t isect;
 		const std::vector<vector3f> &rVertices = GetGeomTree()->GetVertices();
-		for (int i=0; i<edgeNode->numTris; i++) {
-			const int vtxNum = edges[ edgeNode->triIndicesStart[i] ].v1i;
+		for (Uint32 i=0; i<edgeNode->numObjs; i++) {
+			const int vtxNum = edges[ edgeIdxs[i] ].v1i;
 			const vector3d v1 = transToB * vector3d(rVertices[vtxNum]);
 			const vector3f _from(float(v1.x), float(v1.y), float(v1.z));
 
 			vector3d _dir(
-					double(edges[ edgeNode->triIndicesStart[i] ].dir.x),
-					double(edges[ edgeNode->triIndicesStart[i] ].dir.y),
-					double(edges[ edgeNode->triIndicesStart[i] ].dir.z));
+					double(edges[ edgeIdxs[i] ].dir.x),
+					double(edges[ edgeIdxs[i] ].dir.y),
+					double(edges[ edgeIdxs[i] ].dir.z));
 			_dir = transToB.ApplyRotationOnly(_dir);
 			dir = vector3f(&_dir.x);
-			isect.dist = edges[ edgeNode->triIndicesStart[i] ].len;
+			isect.dist = edges[ edgeIdxs[i] ].len;
 			isect.triIdx = -1;
 
 			b->GetGeomTree()->TraceRay(btriNode, _from, dir, &isect);
 
 			if (isect.triIdx == -1) continue;
 			numContacts++;
-			const double depth = edges[ edgeNode->triIndicesStart[i] ].len - isect.dist;
+			const double depth = edges[ edgeIdxs[i] ].len - isect.dist;
 			// in world coords
 			CollisionContact contact;
 			contact.pos = b->GetTransform() * (v1 + vector3d(&dir.x)*double(isect.dist));
@@ -226,13 +391,13 @@ void Geom::CollideEdgesTris(int &maxContacts, const BVHNode *edgeNode, const mat
 			contact.userData2 = b->m_data;
 			// contact geomFlag is bitwise OR of triangle's and edge's flags
 			contact.geomFlag = b->m_geomtree->GetTriFlag(isect.triIdx) |
-				edges[ edgeNode->triIndicesStart[i] ].triFlag;
+				edges[ edgeIdxs[i] ].triFlag;
 			callback(&contact);
 			if (--maxContacts <= 0) return;
 		}
 	} else {
-		CollideEdgesTris(maxContacts, edgeNode->kids[0], transToB, b, btriNode, callback);
-		CollideEdgesTris(maxContacts, edgeNode->kids[1], transToB, b, btriNode, callback);
+		CollideEdgesTris(maxContacts, edgeNode->GetKid(0), transToB, b, btriNode, callback);
+		CollideEdgesTris(maxContacts, edgeNode->GetKid(1), transToB, b, btriNode, callback);
 	}
 }
 
@@ -26,7 +26,13 @@ public:
 	void Disable() { m_active = false; }
 	bool IsEnabled() { return m_active; }
 	const GeomTree *GetGeomTree() { return m_geomtree; }
-	void Collide(Geom *b, void (*callback)(CollisionContact*));
+	// answers how many contacts were reported
+	int Collide(Geom *b, void (*callback)(CollisionContact*));
+	// as Collide, for geoms that will move by relSweep relative to each
+	// other before they're next collided: if they aren't touching yet,
+	// reports the first thing that gets in the way instead, so that neither
+	// can pass through something thin
+	void CollideSwept(Geom *b, const vector3d &relSweep, void (*callback)(CollisionContact*));
 	void CollideSphere(Sphere &sphere, void (*callback)(CollisionContact*));
 	void SetUserData(void *d) { m_data = d; }
 	void *GetUserData() { return m_data; }
@@ -34,6 +40,10 @@ public:
 	int GetMailboxIndex() const { return m_mailboxIndex; }
 	void SetGroup(int g) { m_group = g; }
 	int GetGroup() const { return m_group; }
+	// how far the geom will move (in its space's coordinates) before it's
+	// next collided. geoms that go further than their radius are swept
+	void SetSweep(const vector3d &sweep) { m_sweep = sweep; }
+	const vector3d &GetSweep() const { return m_sweep; }
 
 	matrix4x4d m_animTransform;
 
@@ -41,6 +51,7 @@ private:
 	void CollideEdgesWithTrisOf(int &maxContacts, Geom *b, const matrix4x4d &transTo, void (*callback)(CollisionContact*));
 	void CollideEdgesTris(int &maxContacts, const BVHNode *edgeNode, const matrix4x4d &transToB,
 		Geom *b, const BVHNode *btriNode, void (*callback)(CollisionContact*));
+	bool SweepVerticesOnto(Geom *b, const vector3d &sweep, CollisionContact &contact);
 	int m_mailboxIndex; // used to avoid duplicate collisions
 	// double-buffer position so we can keep previous position
 	matrix4x4d m_orient, m_invOrient;
@@ -48,6 +59,7 @@ private:
 	const GeomTree *m_geomtree;
 	void *m_data;
 	int m_group;
+	vector3d m_sweep;
 };
 
 #endif /* _GEOM_H */
@@ -17,37 +17,14 @@ GeomTree::GeomTree(const int numVerts, const int numTris, const std::vector<vect
 {
 	PROFILE_SCOPED()
 	assert(static_cast<int>(vertices.size()) == m_numVertices);
-	Profiler::Timer timer;
-	timer.Start();
 
 	const int numIndices = numTris * 3;
-	m_indices.reserve(numIndices);
-	for (int i = 0; i < numIndices; ++i) {
-		m_indices.push_back(indices[i]);
-	}
-
-	m_triFlags.reserve(numTris);
-	for (int i = 0; i < numTris; ++i) {
-		m_triFlags.push_back(triflags[i]);
-	}
+	m_indices.assign(indices, indices + numIndices);
+	m_triFlags.assign(triflags, triflags + numTris);
 
 	m_aabb.min = vector3d(FLT_MAX,FLT_MAX,FLT_MAX);
 	m_aabb.max = vector3d(-FLT_MAX,-FLT_MAX,-FLT_MAX);
 
-	// activeTris = tris we are still trying to put into leaves
-	std::vector<int> activeTris;
-	activeTris.reserve(numTris);
-	for (int i=0; i<numTris; i++)
-	{
-		activeTris.push_back(i*3);
-	}
-
-	typedef std::map< std::pair<int,int>, int > EdgeType;
-	EdgeType edges;
-#define ADD_EDGE(_i1,_i2,_triflag) \
-	if ((_i1) < (_i2)) edges[std::pair<int,int>(_i1,_i2)] = _triflag; \
-	else if ((_i1) > (_i2)) edges[std::pair<int,int>(_i2,_i1)] = _triflag;
-
 	// eliminate duplicate vertices
 	{
 		std::vector<Uint32> xrefs;
@@ -58,16 +35,46 @@ GeomTree::GeomTree(const int numVerts, const int numTris, const std::vector<vect
 		//Output("---   %d vertices welded\n", count - newCount);
 
 		// Remap faces.
-		const Uint32 faceCount = numTris;
-		for (Uint32 f = 0; f < faceCount; f++)
-		{
-			const Uint32 idx = (f * 3);
-			m_indices[idx+0] = xrefs.at(m_indices[idx+0]);
-			m_indices[idx+1] = xrefs.at(m_indices[idx+1]);
-			m_indices[idx+2] = xrefs.at(m_indices[idx+2]);
-		}
+		for (int i = 0; i < numIndices; i++)
+			m_indices[i] = xrefs.at(m_indices[i]);
 	}
 
+	// the edges, each once whichever way round and however many tris share
+	// it. found through an open addressed table of edge numbers (plus one,
+	// so that zero is empty) keyed on the vertex pair, big enough for every
+	// tri to have three edges of its own
+	m_edges.reserve(numIndices);
+	std::vector<Uint64> edgeKeys;
+	edgeKeys.reserve(numIndices);
+	Uint32 tableBits = 4;
+	while ((1U << tableBits) < Uint32(numIndices) * 2) tableBits++;
+	std::vector<Uint32> edgeTable(size_t(1) << tableBits, 0);
+	const Uint32 tableMask = (1U << tableBits) - 1;
+
+	auto addEdge = [&](Uint32 i1, Uint32 i2, Uint32 triflag) {
+		if (i1 == i2) return;
+		if (i1 > i2) std::swap(i1, i2);
+		const Uint64 key = (Uint64(i1) << 32) | i2;
+		Uint32 slot = Uint32((key * 0x9E3779B97F4A7C15ULL) >> (64 - tableBits));
+		for (;;) {
+			const Uint32 e = edgeTable[slot];
+			if (!e) break;
+			if (edgeKeys[e - 1] == key) {
+				// the last tri to share an edge gives it its flag
+				m_edges[e - 1].triFlag = triflag;
+				return;
+			}
+			slot = (slot + 1) & tableMask;
+		}
+		Edge edge;
+		edge.v1i = i1;
+		edge.v2i = i2;
+		edge.triFlag = triflag;
+		m_edges.push_back(edge);
+		edgeKeys.push_back(key);
+		edgeTable[slot] = m_edges.size();
+	};
+
 	// Get radius, m_aabb, and merge duplicate edges
 	m_radius = 0;
 	for (int i=0; i<numTris; i++)
@@ -77,9 +84,9 @@ GeomTree::GeomTree(const int numVerts, const int numTris, const std::vector<vect
 		const int vi2 = m_indices[3*i+1];
 		const int vi3 = m_indices[3*i+2];
 
-		ADD_EDGE(vi1, vi2, triflag);
-		ADD_EDGE(vi1, vi3, triflag);
-		ADD_EDGE(vi2, vi3, triflag);
+		addEdge(vi1, vi2, triflag);
+		addEdge(vi1, vi3, triflag);
+		addEdge(vi2, vi3, triflag);
 
 		vector3d v[3];
 		v[0] = vector3d(m_vertices[vi1]);
@@ -95,61 +102,51 @@ GeomTree::GeomTree(const int numVerts, const int numTris, const std::vector<vect
 	}
 	m_radius = sqrt(m_radius);
 
-	{
-		Aabb *aabbs = new Aabb[activeTris.size()];
-		for (Uint32 i = 0; i < activeTris.size(); i++)
-		{
-			const vector3d v1 = vector3d(m_vertices[m_indices[activeTris[i] + 0]]);
-			const vector3d v2 = vector3d(m_vertices[m_indices[activeTris[i] + 1]]);
-			const vector3d v3 = vector3d(m_vertices[m_indices[activeTris[i] + 2]]);
-			aabbs[i].min = aabbs[i].max = v1;
-			aabbs[i].Update(v2);
-			aabbs[i].Update(v3);
-		}
-
-		//int t = SDL_GetTicks();
-		m_triTree.reset(new BVHTree(activeTris.size(), &activeTris[0], aabbs));
-		delete[] aabbs;
+	// in vertex pair order, as they always have been
+	std::sort(m_edges.begin(), m_edges.end(), [](const Edge &a, const Edge &b) {
+		return a.v1i < b.v1i || (a.v1i == b.v1i && a.v2i < b.v2i);
+	});
+	m_edges.shrink_to_fit();
+	m_numEdges = m_edges.size();
+	for (Edge &edge : m_edges) {
+		// precalc some jizz
+		vector3f dir = m_vertices[edge.v2i] - m_vertices[edge.v1i];
+		edge.len = dir.Length();
+		edge.dir = dir * (1.0f / edge.len);
 	}
-	//Output("Tri tree of %d tris build in %dms\n", activeTris.size(), SDL_GetTicks() - t);
 
-	m_numEdges = edges.size();
-	m_edges.resize( m_numEdges );
-	// to build Edge bvh tree with.
-	m_aabbs.resize( m_numEdges );
-	int *edgeIdxs = new int[m_numEdges];
+	BuildTrees();
+}
 
-	int pos = 0;
-	typedef EdgeType::iterator MapPairIter;
-	for (MapPairIter i = edges.begin(), iEnd = edges.end();	i != iEnd; ++i, pos++)
-	{
-		// precalc some jizz
-		const std::pair<int, int> &vtx = (*i).first;
-		const int triflag = (*i).second;
-		const vector3f &v1 = m_vertices[vtx.first];
-		const vector3f &v2 = m_vertices[vtx.second];
-		vector3f dir = (v2-v1);
-		const float len = dir.Length();
-		dir *= 1.0f/len;
-
-		m_edges[pos].v1i = vtx.first;
-		m_edges[pos].v2i = vtx.second;
-		m_edges[pos].triFlag = triflag;
-		m_edges[pos].len = len;
-		m_edges[pos].dir = dir;
-
-		edgeIdxs[pos] = pos;
-		m_aabbs[pos].min = m_aabbs[pos].max = vector3d(v1);
-		m_aabbs[pos].Update(vector3d(v2));
+void GeomTree::BuildTrees()
+{
+	PROFILE_SCOPED()
+	std::vector<Aabb> aabbs(std::max(m_numTris, m_numEdges));
+	std::vector<int> objs(aabbs.size());
+
+	// tris are referred to by their first index
+	for (int i = 0; i < m_numTris; i++) {
+		objs[i] = i * 3;
+		aabbs[i].min = aabbs[i].max = vector3d(m_vertices[m_indices[i*3 + 0]]);
+		aabbs[i].Update(vector3d(m_vertices[m_indices[i*3 + 1]]));
+		aabbs[i].Update(vector3d(m_vertices[m_indices[i*3 + 2]]));
 	}
+	m_triTree.reset(new BVHTree(m_numTris, &objs[0], &aabbs[0]));
 
-	//t = SDL_GetTicks();
-	m_edgeTree.reset(new BVHTree(m_numEdges, edgeIdxs, &m_aabbs[0]));
-	delete [] edgeIdxs;
-	//Output("Edge tree of %d edges build in %dms\n", m_numEdges, SDL_GetTicks() - t);
+	for (int i = 0; i < m_numEdges; i++) {
+		objs[i] = i;
+		aabbs[i].min = aabbs[i].max = vector3d(m_vertices[m_edges[i].v1i]);
+		aabbs[i].Update(vector3d(m_vertices[m_edges[i].v2i]));
+	}
+	m_edgeTree.reset(new BVHTree(m_numEdges, &objs[0], &aabbs[0]));
+}
 
-	timer.Stop();
-	//Output(" - - GeomTree::GeomTree took: %lf milliseconds\n", timer.millicycles());
+// reads size bytes of an array saved with Writer::Blob
+static void ReadArray(Serializer::Reader &rd, void *out, size_t size)
+{
+	const ByteRange data = rd.Blob();
+	if (data.Size() != size) Error("GeomTree: saved tree is truncated.");
+	if (size) memcpy(out, data.begin, size);
 }
 
 GeomTree::GeomTree(Serializer::Reader &rd)
@@ -164,82 +161,48 @@ GeomTree::GeomTree(Serializer::Reader &rd)
 	m_aabb.min = rd.Vector3d();
 	m_aabb.radius = rd.Double();
 
-	const Uint32 numAabbs = rd.Int32();
-	m_aabbs.resize(numAabbs);
-	for (Uint32 iAabb = 0; iAabb < numAabbs; ++iAabb) {
-		m_aabbs[iAabb].max = rd.Vector3d();
-		m_aabbs[iAabb].min = rd.Vector3d();
-		m_aabbs[iAabb].radius = rd.Double();
-	}
-
+	static_assert(sizeof(Edge) == 7 * 4, "Edge is saved as is");
+	static_assert(sizeof(vector3f) == 3 * 4, "vector3f is saved as is");
 	m_edges.resize(m_numEdges);
-	for (Sint32 iEdge = 0; iEdge < m_numEdges; ++iEdge) {
-		m_edges[iEdge].Load(rd);
-	}
+	ReadArray(rd, m_edges.data(), m_numEdges * sizeof(Edge));
 
 	m_vertices.resize(m_numVertices);
-	for (Sint32 iVert = 0; iVert < m_numVertices; ++iVert) {
-		m_vertices[iVert] = rd.Vector3f();
-	}
+	ReadArray(rd, m_vertices.data(), m_numVertices * sizeof(vector3f));
 
-	const int numIndicies(m_numTris * 3);
-	m_indices.resize(numIndicies);
-	for (Sint32 iIndi = 0; iIndi < numIndicies; ++iIndi) {
-		m_indices[iIndi] = rd.Int32();
-	}
+	m_indices.resize(m_numTris * 3);
+	ReadArray(rd, m_indices.data(), m_numTris * 3 * sizeof(Uint32));
 
 	m_triFlags.resize(m_numTris);
-	for (Sint32 iTri = 0; iTri < m_numTris; ++iTri) {
-		m_triFlags[iTri] = rd.Int32();
-	}
+	ReadArray(rd, m_triFlags.data(), m_numTris * sizeof(Uint32));
 
-	// activeTris = tris we are still trying to put into leaves
-	std::vector<int> activeTris;
-	activeTris.reserve(m_numTris);
-	for (int i = 0; i<m_numTris; i++)
-	{
-		activeTris.push_back(i * 3);
-	}
+	m_triTree.reset(new BVHTree(rd));
+	m_edgeTree.reset(new BVHTree(rd));
+}
 
-	// regenerate the aabb data
-	Aabb *aabbs = new Aabb[activeTris.size()];
-	for (Uint32 i = 0; i<activeTris.size(); i++)
-	{
-		const vector3d v1 = vector3d(m_vertices[m_indices[activeTris[i] + 0]]);
-		const vector3d v2 = vector3d(m_vertices[m_indices[activeTris[i] + 1]]);
-		const vector3d v3 = vector3d(m_vertices[m_indices[activeTris[i] + 2]]);
-		aabbs[i].min = aabbs[i].max = v1;
-		aabbs[i].Update(v2);
-		aabbs[i].Update(v3);
-	}
-	m_triTree.reset(new BVHTree(activeTris.size(), &activeTris[0], aabbs));
-	delete[] aabbs;
-
-	//
-	int *edgeIdxs = new int[m_numEdges];
-	memset(edgeIdxs, 0, sizeof(int)*m_numEdges);
-	for (int i = 0; i<m_numEdges; i++) {
-		edgeIdxs[i] = i;
-	}
-	m_edgeTree.reset(new BVHTree(m_numEdges, edgeIdxs, &m_aabbs[0]));
+// 1/d for the slab tests, avoiding division by zero. a ray that doesn't
+// move along an axis gets slabs so far apart on it that they don't limit
+// the ray, unless it starts outside them
+static inline float RayInverse(float d)
+{
+	return 1.0f / (is_zero_exact(d) ? 1e-20f : d);
 }
 
 static bool SlabsRayAabbTest(const BVHNode *n, const vector3f &start, const vector3f &invDir, isect_t *isect)
 {
 	PROFILE_SCOPED()
 	float
-	l1      = (n->aabb.min.x - start.x) * invDir.x,
-	l2      = (n->aabb.max.x - start.x) * invDir.x,
+	l1      = (n->min.x - start.x) * invDir.x,
+	l2      = (n->max.x - start.x) * invDir.x,
 	lmin    = std::min(l1,l2),
 	lmax    = std::max(l1,l2);
 
-	l1      = (n->aabb.min.y - start.y) * invDir.y;
-	l2      = (n->aabb.max.y - start.y) * invDir.y;
+	l1      = (n->min.y - start.y) * invDir.y;
+	l2      = (n->max.y - start.y) * invDir.y;
 	lmin    = std::max(std::min(l1,l2), lmin);
 	lmax    = std::min(std::max(l1,l2), lmax);
 
-	l1      = (n->aabb.min.z - start.z) * invDir.z;
-	l2      = (n->aabb.max.z - start.z) * invDir.z;
+	l1      = (n->min.z - start.z) * invDir.z;
+	l2      = (n->max.z - start.z) * invDir.z;
 	lmin    = std::max(std::min(l1,l2), lmin);
 	lmax    = std::min(std::max(l1,l2), lmax);
 
@@ -255,24 +218,24 @@ void GeomTree::TraceRay(const vector3f &start, const vector3f &dir, isect_t *ise
 void GeomTree::TraceRay(const BVHNode *currnode, const vector3f &a_origin, const vector3f &a_dir, isect_t *isect) const
 {
 	PROFILE_SCOPED()
-	BVHNode *stack[32];
+	const BVHNode *stack[32];
 	int stackpos = -1;
-	const vector3f invDir( // avoid division by zero please
-		is_zero_exact(a_dir.x) ? 0.0f : (1.0f / a_dir.x),
-		is_zero_exact(a_dir.y) ? 0.0f : (1.0f / a_dir.y),
-		is_zero_exact(a_dir.z) ? 0.0f : (1.0f / a_dir.z));
+	const vector3f invDir(RayInverse(a_dir.x), RayInverse(a_dir.y), RayInverse(a_dir.z));
 
 	for (;;) {
 		while (!currnode->IsLeaf()) {
 			if (!SlabsRayAabbTest(currnode, a_origin, invDir, isect)) goto pop_bstack;
 
 			stackpos++;
-			stack[stackpos] = currnode->kids[1];
-			currnode = currnode->kids[0];
+			stack[stackpos] = currnode->GetKid(1);
+			currnode = currnode->GetKid(0);
 		}
 		// triangle intersection jizz
-		for (int i=0; i<currnode->numTris; i++) {
-			RayTriIntersect(1, a_origin, &a_dir, currnode->triIndicesStart[i], isect);
+		{
+			const BVHTree::objPtr_t *tris = m_triTree->GetObjs(currnode);
+			for (Uint32 i=0; i<currnode->numObjs; i++) {
+				RayTriIntersect(1, a_origin, &a_dir, tris[i], isect);
+			}
 		}
 pop_bstack:
 		if (stackpos < 0) break;
@@ -311,6 +274,152 @@ void GeomTree::RayTriIntersect(int numRays, const vector3f &origin, const vector
 	}
 }
 
+const int GeomTree::RAY_PACKET;
+
+// the rays of a packet a lane each, with each quantity in an array of its
+// own so that the box and triangle tests over the lanes vectorise (as gcc
+// -fopt-info-vec reports they do at -O2). lanes past the
+// last ray repeat the first one, so they never divide by anything the real
+// rays wouldn't. they're still worked out along with the real ones, but
+// live masks them out of the box tests, and their negative dist keeps them
+// from hitting any triangles
+struct GeomTree::RayPacket {
+	float ox[RAY_PACKET], oy[RAY_PACKET], oz[RAY_PACKET];
+	float dx[RAY_PACKET], dy[RAY_PACKET], dz[RAY_PACKET];
+	float ix[RAY_PACKET], iy[RAY_PACKET], iz[RAY_PACKET];
+	float dist[RAY_PACKET];
+	int live[RAY_PACKET];
+	int triIdx[RAY_PACKET];
+};
+
+// as SlabsRayAabbTest, answering whether any of the live rays hit
+static bool SlabsPacketAabbTest(const BVHNode *n, const float *ox, const float *oy, const float *oz,
+	const float *ix, const float *iy, const float *iz, const float *dist, const int *live)
+{
+	const float minx = n->min.x, miny = n->min.y, minz = n->min.z;
+	const float maxx = n->max.x, maxy = n->max.y, maxz = n->max.z;
+
+	int hits = 0;
+	for (int i=0; i<GeomTree::RAY_PACKET; i++) {
+		float
+		l1      = (minx - ox[i]) * ix[i],
+		l2      = (maxx - ox[i]) * ix[i],
+		lmin    = std::min(l1,l2),
+		lmax    = std::max(l1,l2);
+
+		l1      = (miny - oy[i]) * iy[i];
+		l2      = (maxy - oy[i]) * iy[i];
+		lmin    = std::max(std::min(l1,l2), lmin);
+		lmax    = std::min(std::max(l1,l2), lmax);
+
+		l1      = (minz - oz[i]) * iz[i];
+		l2      = (maxz - oz[i]) * iz[i];
+		lmin    = std::max(std::min(l1,l2), lmin);
+		lmax    = std::min(std::max(l1,l2), lmax);
+
+		hits |= ((lmax >= 0.f) & (lmax >= lmin) & (lmin < dist[i]) & live[i]);
+	}
+	return hits != 0;
+}
+
+void GeomTree::TraceRays(int numRays, const vector3f *starts, const vector3f *dirs, isect_t *isects) const
+{
+	PROFILE_SCOPED()
+	RayPacket packet;
+	for (int first = 0; first < numRays; first += RAY_PACKET) {
+		const int num = std::min(numRays - first, RAY_PACKET);
+		for (int i=0; i<RAY_PACKET; i++) {
+			const int ray = first + (i < num ? i : 0);
+			const vector3f &o = starts[ray];
+			const vector3f &d = dirs[ray];
+			packet.ox[i] = o.x; packet.oy[i] = o.y; packet.oz[i] = o.z;
+			packet.dx[i] = d.x; packet.dy[i] = d.y; packet.dz[i] = d.z;
+			packet.ix[i] = RayInverse(d.x);
+			packet.iy[i] = RayInverse(d.y);
+			packet.iz[i] = RayInverse(d.z);
+			packet.dist[i] = i < num ? isects[ray].dist : -1.0f;
+			packet.live[i] = i < num;
+			packet.triIdx[i] = isects[ray].triIdx;
+		}
+
+		TracePacket(packet);
+
+		for (int i=0; i<num; i++) {
+			isects[first+i].dist = packet.dist[i];
+			isects[first+i].triIdx = packet.triIdx[i];
+		}
+	}
+}
+
+void GeomTree::TracePacket(RayPacket &p) const
+{
+	const BVHNode *stack[32];
+	int stackpos = -1;
+	const BVHNode *currnode = m_triTree->GetRoot();
+
+	for (;;) {
+		while (!currnode->IsLeaf()) {
+			if (!SlabsPacketAabbTest(currnode, p.ox, p.oy, p.oz, p.ix, p.iy, p.iz, p.dist, p.live)) goto pop_bstack;
+
+			stackpos++;
+			stack[stackpos] = currnode->GetKid(1);
+			currnode = currnode->GetKid(0);
+		}
+		{
+			const BVHTree::objPtr_t *tris = m_triTree->GetObjs(currnode);
+			for (Uint32 i=0; i<currnode->numObjs; i++) {
+				PacketTriIntersect(p, tris[i]);
+			}
+		}
+pop_bstack:
+		if (stackpos < 0) break;
+		currnode = stack[stackpos];
+		stackpos--;
+	}
+}
+
+// RayTriIntersect for every lane, with the sums done in the same order so
+// that a ray hits just what it would on its own
+void GeomTree::PacketTriIntersect(RayPacket &p, int triIdx) const
+{
+	const vector3f a(m_vertices[m_indices[triIdx+0]]);
+	const vector3f b(m_vertices[m_indices[triIdx+1]]);
+	const vector3f c(m_vertices[m_indices[triIdx+2]]);
+
+	const vector3f n = (c-a).Cross(b-a);
+
+	// first the sums for every lane, into arrays, so that the compiler
+	// can't move the denominator into a branch (where, as it might trap,
+	// the loop wouldn't vectorise)
+	float nominators[RAY_PACKET], denominators[RAY_PACKET];
+	int inside[RAY_PACKET];
+	for (int i=0; i<RAY_PACKET; i++) {
+		// v0_cross, v1_cross and v2_cross from RayTriIntersect, relative
+		// to this lane's origin
+		const float ax = a.x - p.ox[i], ay = a.y - p.oy[i], az = a.z - p.oz[i];
+		const float bx = b.x - p.ox[i], by = b.y - p.oy[i], bz = b.z - p.oz[i];
+		const float cx = c.x - p.ox[i], cy = c.y - p.oy[i], cz = c.z - p.oz[i];
+		nominators[i] = n.x*ax + n.y*ay + n.z*az;
+		denominators[i] = p.dx[i]*n.x + p.dy[i]*n.y + p.dz[i]*n.z;
+
+		const float v0d = (cy*bz - cz*by)*p.dx[i] + (cz*bx - cx*bz)*p.dy[i] + (cx*by - cy*bx)*p.dz[i];
+		const float v1d = (by*az - bz*ay)*p.dx[i] + (bz*ax - bx*az)*p.dy[i] + (bx*ay - by*ax)*p.dz[i];
+		const float v2d = (ay*cz - az*cy)*p.dx[i] + (az*cx - ax*cz)*p.dy[i] + (ax*cy - ay*cx)*p.dz[i];
+		inside[i] = ((v0d > 0) & (v1d > 0) & (v2d > 0)) | ((v0d < 0) & (v1d < 0) & (v2d < 0));
+	}
+
+	// then every lane's distance, kept or not by a select rather than a
+	// branch. lanes that miss divide by 1, as their denominator can be 0
+	// and floating point exceptions may be on; that's done with sums, as a
+	// select there is turned back into a branch around the division
+	for (int i=0; i<RAY_PACKET; i++) {
+		const float dist = nominators[i] / (denominators[i] * inside[i] + float(1 - inside[i]));
+		const bool hit = inside[i] & (dist > 0) & (dist < p.dist[i]);
+		p.dist[i] = hit ? dist : p.dist[i];
+		p.triIdx[i] = hit ? triIdx/3 : p.triIdx[i];
+	}
+}
+
 vector3f GeomTree::GetTriNormal(int triIdx) const
 {
 	PROFILE_SCOPED()
@@ -333,26 +442,14 @@ void GeomTree::Save(Serializer::Writer &wr) const
 	wr.Vector3d(m_aabb.min);
 	wr.Double(m_aabb.radius);
 
-	wr.Int32(m_numEdges);
-	for (Sint32 iAabb = 0; iAabb < m_numEdges; ++iAabb) {
-		wr.Vector3d(m_aabbs[iAabb].max);
-		wr.Vector3d(m_aabbs[iAabb].min);
-		wr.Double(m_aabbs[iAabb].radius);
-	}
-
-	for (Sint32 iEdge = 0; iEdge < m_numEdges; ++iEdge) {
-		m_edges[iEdge].Save(wr);
-	}
+	// the arrays as they are in memory, like Float and Double this isn't
+	// portable across architectures
+	wr.Blob(m_edges.data(), m_numEdges * sizeof(Edge));
+	wr.Blob(m_vertices.data(), m_numVertices * sizeof(vector3f));
+	wr.Blob(m_indices.data(), m_numTris * 3 * sizeof(Uint32));
+	wr.Blob(m_triFlags.data(), m_numTris * sizeof(Uint32));
 
-	for (Sint32 iVert = 0; iVert < m_numVertices; ++iVert) {
-		wr.Vector3f(m_vertices[iVert]);
-	}
-
-	for (Sint32 iIndi = 0; iIndi < (m_numTris * 3); ++iIndi) {
-		wr.Int32(m_indices[iIndi]);
-	}
-
-	for (Sint32 iTri = 0; iTri < m_numTris; ++iTri) {
-		wr.Int32(m_triFlags[iTri]);
-	}
+	// and the finished trees, so loading doesn't have to build them again
+	m_triTree->Save(wr);
+	m_edgeTree->Save(wr);
 }
@@ -29,6 +29,13 @@ public:
 	// isect.triIdx should be -1 unless repeat calls with same isect_t
 	void TraceRay(const vector3f &start, const vector3f &dir, isect_t *isect) const;
 	void TraceRay(const BVHNode *startNode, const vector3f &a_origin, const vector3f &a_dir, isect_t *isect) const;
+	// as TraceRay for each of numRays rays, which needn't share a start.
+	// they go down the tree RAY_PACKET at a time, sharing each node and
+	// triangle they visit, and testing it against all the lanes at once.
+	// that pays most when the rays go much the same way from much the same
+	// place; scattered rays gain only a little over TraceRay
+	static const int RAY_PACKET = 4;
+	void TraceRays(int numRays, const vector3f *starts, const vector3f *dirs, isect_t *isects) const;
 	vector3f GetTriNormal(int triIdx) const;
 	Uint32 GetTriFlag(int triIdx) const { return m_triFlags[triIdx]; }
 	double GetRadius() const { return m_radius; }
@@ -74,7 +81,11 @@ public:
 	void Save(Serializer::Writer &wr) const;
 
 private:
+	void BuildTrees();
 	void RayTriIntersect(int numRays, const vector3f &origin, const vector3f *dirs, int triIdx, isect_t *isects) const;
+	struct RayPacket;
+	void TracePacket(RayPacket &packet) const;
+	void PacketTriIntersect(RayPacket &packet, int triIdx) const;
 
 	int m_numVertices;
 	int m_numEdges;
@@ -82,7 +93,6 @@ private:
 
 	double m_radius;
 	Aabb m_aabb;
-	std::vector<Aabb> m_aabbs;
 
 	std::unique_ptr<BVHTree> m_triTree;
 	std::unique_ptr<BVHTree> m_edgeTree;
@@ -0,0 +1,52 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "DrawSorter.h"
+#include "Material.h"
+#include "Renderer.h"
+#include <algorithm>
+
+namespace Graphics {
+
+void DrawSorter::Add(const matrix4x4f &trans, VertexBuffer *vb, IndexBuffer *ib, RenderState *rs, Material *mat)
+{
+	Draw draw;
+	draw.trans = trans;
+	draw.vertexBuffer = vb;
+	draw.indexBuffer = ib;
+	draw.renderState = rs;
+	draw.material = mat;
+	draw.shader = mat->GetShaderID();
+	m_draws.push_back(draw);
+}
+
+bool DrawSorter::Before(const Draw &a, const Draw &b)
+{
+	if (a.shader != b.shader)
+		return a.shader < b.shader;
+
+	const Material &ma = *a.material;
+	const Material &mb = *b.material;
+	const Texture *ta[] = { ma.texture0, ma.texture1, ma.texture2, ma.texture3, ma.texture4, ma.texture5, ma.texture6 };
+	const Texture *tb[] = { mb.texture0, mb.texture1, mb.texture2, mb.texture3, mb.texture4, mb.texture5, mb.texture6 };
+	for (unsigned int i = 0; i < COUNTOF(ta); i++)
+		if (ta[i] != tb[i])
+			return std::less<const Texture*>()(ta[i], tb[i]);
+
+	return std::less<const RenderState*>()(a.renderState, b.renderState);
+}
+
+void DrawSorter::Flush(Renderer *r)
+{
+	PROFILE_SCOPED()
+	// stable, so draws that tie keep the order they were added in
+	std::stable_sort(m_draws.begin(), m_draws.end(), &DrawSorter::Before);
+
+	for (const Draw &draw : m_draws) {
+		r->SetTransform(draw.trans);
+		r->DrawBufferIndexed(draw.vertexBuffer, draw.indexBuffer, draw.renderState, draw.material);
+	}
+	m_draws.clear();
+}
+
+}
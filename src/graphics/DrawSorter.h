@@ -0,0 +1,49 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _GRAPHICS_DRAWSORTER_H
+#define _GRAPHICS_DRAWSORTER_H
+/*
+ * Collects opaque indexed draws and makes them ordered by shader, then
+ * textures, then render state, so that consecutive draws change as little
+ * GL state as possible. Only for geometry that is depth tested and not
+ * blended, since the order of the draws doesn't matter for that.
+ * Material parameters are read when the draws are flushed, not when they
+ * are added, so the materials mustn't change in between.
+ */
+#include "libs.h"
+
+namespace Graphics {
+
+class IndexBuffer;
+class Material;
+class Renderer;
+class RenderState;
+class VertexBuffer;
+
+class DrawSorter {
+public:
+	void Add(const matrix4x4f &trans, VertexBuffer*, IndexBuffer*, RenderState*, Material*);
+
+	// sorts and makes the draws added since the last flush
+	void Flush(Renderer*);
+
+	bool IsEmpty() const { return m_draws.empty(); }
+
+private:
+	struct Draw {
+		matrix4x4f trans;
+		VertexBuffer *vertexBuffer;
+		IndexBuffer *indexBuffer;
+		RenderState *renderState;
+		Material *material;
+		Uint32 shader;
+	};
+	static bool Before(const Draw &a, const Draw &b);
+
+	std::vector<Draw> m_draws;
+};
+
+}
+
+#endif
@@ -216,7 +216,7 @@ void Line3D::Dirty() {
 }
 //------------------------------------------------------------
 
-Lines::Lines() : m_refreshVertexBuffer(true), m_va(new VertexArray(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE))
+Lines::Lines() : m_dataChanged(true), m_refreshVertexBuffer(true), m_va(new VertexArray(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE))
 {
 	PROFILE_SCOPED()
 	// XXX bug in Radeon drivers will cause crash in glLineWidth if width >= 3
@@ -228,6 +228,7 @@ void Lines::SetData(const Uint32 vertCount, const vector3f *vertices, const Colo
 	assert( vertices );
 
 	// somethings changed so even if the number of verts is constant the data must be uploaded
+	m_dataChanged = true;
 	m_refreshVertexBuffer = true;
 
 	// if the number of vert mismatches then clear the current vertex buffer
@@ -249,6 +250,7 @@ void Lines::SetData(const Uint32 vertCount, const vector3f *vertices, const Colo
 	assert( vertices );
 
 	// somethings changed so even if the number of verts is constant the data must be uploaded
+	m_dataChanged = true;
 	m_refreshVertexBuffer = true;
 
 	// if the number of vert mismatches then clear the current vertex buffer
@@ -270,6 +272,21 @@ void Lines::Draw(Renderer *r, RenderState *rs, const PrimitiveType pt)
 	if (m_va->GetNumVerts() == 0)
 		return;
 
+	if( !m_material.Valid() ) {
+		Graphics::MaterialDescriptor desc;
+		desc.vertexColors = true;
+		m_material.Reset(r->CreateMaterial(desc));
+	}
+	// XXX would be nicer to draw this as a textured triangle strip
+	// can't guarantee linewidth support
+	// glLineWidth(m_width);
+	if( m_dataChanged ) {
+		// lines that are rebuilt every frame are streamed by the renderer,
+		// they only get a buffer of their own once they stay the same
+		m_dataChanged = false;
+		r->DrawTriangles(m_va.get(), rs, m_material.Get(), pt);
+		return;
+	}
 	if( !m_vertexBuffer.Valid() ) {
 		CreateVertexBuffer(r, m_va->GetNumVerts());
 	}
@@ -277,9 +294,6 @@ void Lines::Draw(Renderer *r, RenderState *rs, const PrimitiveType pt)
 		m_refreshVertexBuffer = false;
 		m_vertexBuffer->Populate( *m_va );
 	}
-	// XXX would be nicer to draw this as a textured triangle strip
-	// can't guarantee linewidth support
-	// glLineWidth(m_width);
 	r->DrawBuffer(m_vertexBuffer.Get(), rs, m_material.Get(), pt);
 	// glLineWidth(1.f);
 }
@@ -287,10 +301,6 @@ void Lines::Draw(Renderer *r, RenderState *rs, const PrimitiveType pt)
 void Lines::CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size)
 {
 	PROFILE_SCOPED()
-	Graphics::MaterialDescriptor desc;
-	desc.vertexColors = true;
-	m_material.Reset(r->CreateMaterial(desc));
-
 	Graphics::VertexBufferDesc vbd;
 	vbd.attrib[0].semantic = Graphics::ATTRIB_POSITION;
 	vbd.attrib[0].format = Graphics::ATTRIB_FORMAT_FLOAT3;
@@ -302,7 +312,7 @@ void Lines::CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size)
 }
 
 //------------------------------------------------------------
-PointSprites::PointSprites() : m_refreshVertexBuffer(true)
+PointSprites::PointSprites() : m_dataChanged(true), m_refreshVertexBuffer(true)
 {
 }
 
@@ -321,6 +331,7 @@ void PointSprites::SetData(const int count, const vector3f *positions, const Col
 		m_va->Add(positions[i], colours[i], vSize);
 	}
 
+	m_dataChanged = true;
 	m_refreshVertexBuffer = true;
 	m_material.Reset(pMaterial);
 }
@@ -331,7 +342,13 @@ void PointSprites::Draw(Renderer *r, RenderState *rs)
 	if (m_va->GetNumVerts() == 0)
 		return;
 
-	if (!m_vertexBuffer.Valid() || !m_material.Valid()) {
+	if( m_dataChanged ) {
+		// streamed until the same sprites are drawn twice, see Lines::Draw
+		m_dataChanged = false;
+		r->DrawTriangles(m_va.get(), rs, m_material.Get(), Graphics::POINTS);
+		return;
+	}
+	if (!m_vertexBuffer.Valid() || m_va->GetNumVerts() != m_vertexBuffer->GetVertexCount()) {
 		CreateVertexBuffer(r, m_va->GetNumVerts());
 	}
 	if( m_refreshVertexBuffer ) {
@@ -357,7 +374,7 @@ void PointSprites::CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size)
 }
 
 //------------------------------------------------------------
-Points::Points() : m_refreshVertexBuffer(true)
+Points::Points() : m_dataChanged(true), m_refreshVertexBuffer(true)
 {
 	PROFILE_SCOPED()
 }
@@ -375,7 +392,6 @@ void Points::SetData(Renderer* r, const int count, const vector3f *positions, co
 		m_va->Clear();
 	} else {
 		m_va.reset(new VertexArray(ATTRIB_POSITION | ATTRIB_DIFFUSE, total));
-		CreateVertexBuffer(r, total);
 	}
 
 	matrix4x4f rot(trans);
@@ -403,6 +419,7 @@ void Points::SetData(Renderer* r, const int count, const vector3f *positions, co
 		m_va->Add(pos + rotv2, color); //bottom right
 	}
 
+	m_dataChanged = true;
 	m_refreshVertexBuffer = true;
 }
 
@@ -419,7 +436,6 @@ void Points::SetData(Renderer* r, const int count, const vector3f *positions, co
 		m_va->Clear();
 	} else {
 		m_va.reset(new VertexArray(ATTRIB_POSITION | ATTRIB_DIFFUSE, total));
-		CreateVertexBuffer(r, total);
 	}
 
 	matrix4x4f rot(trans);
@@ -447,6 +463,7 @@ void Points::SetData(Renderer* r, const int count, const vector3f *positions, co
 		m_va->Add(pos + rotv2, color[i]); //bottom right
 	}
 
+	m_dataChanged = true;
 	m_refreshVertexBuffer = true;
 }
 
@@ -456,6 +473,17 @@ void Points::Draw(Renderer *r, RenderState *rs)
 	if (m_va->GetNumVerts() == 0)
 		return;
 
+	if( !m_material.Valid() ) {
+		Graphics::MaterialDescriptor desc;
+		desc.vertexColors = true;
+		m_material.Reset(r->CreateMaterial(desc));
+	}
+	if( m_dataChanged ) {
+		// streamed until the same points are drawn twice, see Lines::Draw
+		m_dataChanged = false;
+		r->DrawTriangles(m_va.get(), rs, m_material.Get(), Graphics::TRIANGLES);
+		return;
+	}
 	if (!m_vertexBuffer.Valid() || (m_va->GetNumVerts() != m_vertexBuffer->GetVertexCount())) {
 		CreateVertexBuffer(r, m_va->GetNumVerts());
 	}
@@ -470,10 +498,6 @@ void Points::Draw(Renderer *r, RenderState *rs)
 void Points::CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size)
 {
 	PROFILE_SCOPED()
-	Graphics::MaterialDescriptor desc;
-	desc.vertexColors = true;
-	m_material.Reset(r->CreateMaterial(desc));
-
 	Graphics::VertexBufferDesc vbd;
 	vbd.attrib[0].semantic = Graphics::ATTRIB_POSITION;
 	vbd.attrib[0].format = Graphics::ATTRIB_FORMAT_FLOAT3;
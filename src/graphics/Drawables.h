@@ -84,6 +84,7 @@ public:
 private:
 	void CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size);
 
+	bool m_dataChanged;
 	bool m_refreshVertexBuffer;
 	RefCountedPtr<Material> m_material;
 	RefCountedPtr<VertexBuffer> m_vertexBuffer;
@@ -100,6 +101,7 @@ public:
 private:
 	void CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size);
 
+	bool m_dataChanged;
 	bool m_refreshVertexBuffer;
 	RefCountedPtr<Graphics::Material> m_material;
 	RefCountedPtr<VertexBuffer> m_vertexBuffer;
@@ -117,6 +119,7 @@ public:
 private:
 	void CreateVertexBuffer(Graphics::Renderer *r, const Uint32 size);
 
+	bool m_dataChanged;
 	bool m_refreshVertexBuffer;
 	RefCountedPtr<Material> m_material;
 	RefCountedPtr<VertexBuffer> m_vertexBuffer;
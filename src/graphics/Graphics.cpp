@@ -5,6 +5,7 @@
 #include "FileSystem.h"
 #include "Material.h"
 #include "Renderer.h"
+#include "RendererRecorder.h"
 #include "OS.h"
 #include "StringF.h"
 #include <sstream>
@@ -87,6 +88,8 @@ Renderer* Init(Settings vs)
 		Error("Failed to set video mode: %s", SDL_GetError());
 		return nullptr;
 	}
+	if (vs.recordCommands)
+		renderer = new RendererRecorder(renderer);
 
 	if (vs.rendererType == Graphics::RENDERER_DUMMY) {
 		width = vs.width;
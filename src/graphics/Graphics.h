@@ -31,6 +31,7 @@ namespace Graphics {
 		bool useAnisotropicFiltering;
 		bool enableDebugMessages;
 		bool gl3ForwardCompatible;
+		bool recordCommands;		// wrap the renderer in a RendererRecorder
 		int vsync;
 		int requestedSamples;
 		int height;
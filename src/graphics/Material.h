@@ -101,6 +101,9 @@ public:
 	virtual void Apply() { }
 	virtual void Unapply() { }
 	virtual bool IsProgramLoaded() const = 0;
+	// identifies the shader the material draws with, for ordering draws
+	// that share one next to each other. 0 if there is none
+	virtual Uint32 GetShaderID() const { return 0; }
 
 	virtual void SetCommonUniforms(const matrix4x4f& mv, const matrix4x4f& proj) = 0;
 
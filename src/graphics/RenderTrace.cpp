@@ -0,0 +1,565 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "RenderTrace.h"
+#include "Renderer.h"
+#include "Material.h"
+#include "RenderState.h"
+#include "RenderTarget.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "StringF.h"
+#include "utils.h"
+#include <set>
+
+namespace Graphics {
+namespace Trace {
+
+const char *CommandName(Command cmd)
+{
+	static const char *s_names[MAX_COMMAND] = {
+		"end",
+		"begin_frame", "end_frame", "swap_buffers",
+		"create_material", "create_texture", "create_render_state", "create_render_target",
+		"create_vertex_buffer", "create_index_buffer", "create_instance_buffer",
+		"update_vertex_buffer", "update_index_buffer", "update_instance_buffer", "set_material_params",
+		"set_render_target", "set_render_state", "clear_screen", "clear_depth_buffer", "set_clear_color",
+		"set_viewport", "set_transform", "set_transform_d", "set_perspective", "set_orthographic",
+		"set_projection", "set_depth_range", "set_wireframe", "set_lights", "set_ambient", "set_scissor",
+		"set_matrix_mode", "push_matrix", "pop_matrix", "load_identity", "load_matrix", "translate",
+		"scale", "push_state", "pop_state",
+		"draw_triangles", "draw_point_sprites", "draw_point_sprites_sized", "draw_buffer",
+		"draw_buffer_indexed", "draw_buffer_instanced", "draw_buffer_indexed_instanced",
+	};
+	return cmd < MAX_COMMAND ? s_names[cmd] : "unknown";
+}
+
+namespace {
+
+// the objects a trace has defined, as created on the renderer replaying it
+class Replayer {
+public:
+	Replayer(Renderer *r, Reader &rd, ReplayStats &stats) : m_renderer(r), m_rd(rd), m_stats(stats),
+		m_lastRenderState(0), m_lastMaterial(0), m_lastRenderTarget(~0u), m_haveTransform(false) {}
+	~Replayer();
+
+	// answers false at the end of the trace
+	bool Step(std::string &error);
+
+private:
+	template <typename T>
+	T *Find(std::map<Uint32, T> &objects, Uint32 id);
+	Material *GetMaterial(Uint32 id);
+	bool CanDraw(Uint32 materialId) const { return !m_specialMaterials.count(materialId); }
+	void Draw(Uint32 renderStateId, Uint32 materialId, Uint64 vertices);
+
+	void CreateTexture();
+	void CreateRenderTarget();
+	void SetMaterialParams();
+	void SetTransform(const void *m, size_t size);
+
+	Renderer *m_renderer;
+	Reader &m_rd;
+	ReplayStats &m_stats;
+
+	std::map<Uint32, RefCountedPtr<Material>> m_materials;
+	std::map<Uint32, RefCountedPtr<Texture>> m_textures;
+	std::map<Uint32, RenderState*> m_renderStates;
+	std::map<Uint32, RenderTarget*> m_renderTargets;
+	std::map<Uint32, RefCountedPtr<VertexBuffer>> m_vertexBuffers;
+	std::map<Uint32, RefCountedPtr<IndexBuffer>> m_indexBuffers;
+	std::map<Uint32, RefCountedPtr<InstanceBuffer>> m_instanceBuffers;
+	// materials last drawn with specialParameter0 set
+	std::set<Uint32> m_specialMaterials;
+	std::vector<Renderer::StateTicket*> m_stateTickets;
+
+	Uint32 m_lastRenderState;
+	Uint32 m_lastMaterial;
+	Uint32 m_lastRenderTarget;
+	bool m_haveTransform;
+	Uint8 m_lastTransform[sizeof(matrix4x4d)];
+};
+
+Replayer::~Replayer()
+{
+	while (!m_stateTickets.empty()) {
+		delete m_stateTickets.back();
+		m_stateTickets.pop_back();
+	}
+	m_renderer->SetRenderTarget(nullptr);
+	for (auto &rt : m_renderTargets)
+		delete rt.second;
+}
+
+template <typename T>
+T *Replayer::Find(std::map<Uint32, T> &objects, Uint32 id)
+{
+	auto it = objects.find(id);
+	return it != objects.end() ? &it->second : nullptr;
+}
+
+Material *Replayer::GetMaterial(Uint32 id)
+{
+	RefCountedPtr<Material> *m = Find(m_materials, id);
+	return m ? m->Get() : nullptr;
+}
+
+void Replayer::Draw(Uint32 renderStateId, Uint32 materialId, Uint64 vertices)
+{
+	++m_stats.draws;
+	m_stats.verticesDrawn += vertices;
+	if (renderStateId != m_lastRenderState)
+		++m_stats.renderStateChanges;
+	if (materialId != m_lastMaterial)
+		++m_stats.materialChanges;
+	m_lastRenderState = renderStateId;
+	m_lastMaterial = materialId;
+}
+
+void Replayer::CreateTexture()
+{
+	const Uint32 id = m_rd.Get<Uint32>();
+	const TextureFormat format = TextureFormat(m_rd.Get<Uint32>());
+	const vector2f dataSize = m_rd.Get<vector2f>();
+	const vector2f texSize = m_rd.Get<vector2f>();
+	const TextureSampleMode sampleMode = TextureSampleMode(m_rd.Get<Uint32>());
+	const bool generateMipmaps = m_rd.Get<Uint8>() != 0;
+	const bool allowCompression = m_rd.Get<Uint8>() != 0;
+	const bool useAnisotropicFiltering = m_rd.Get<Uint8>() != 0;
+	const Uint32 numberOfMipMaps = m_rd.Get<Uint32>();
+	const TextureType type = TextureType(m_rd.Get<Uint32>());
+	if (m_rd.Failed())
+		return;
+
+	const TextureDescriptor desc(format, dataSize, texSize, sampleMode, generateMipmaps,
+		allowCompression, useAnisotropicFiltering, numberOfMipMaps, type);
+	m_textures[id].Reset(m_renderer->CreateTexture(desc));
+}
+
+void Replayer::CreateRenderTarget()
+{
+	const Uint32 id = m_rd.Get<Uint32>();
+	const Uint16 width = m_rd.Get<Uint16>();
+	const Uint16 height = m_rd.Get<Uint16>();
+	const TextureFormat colorFormat = TextureFormat(m_rd.Get<Uint32>());
+	const TextureFormat depthFormat = TextureFormat(m_rd.Get<Uint32>());
+	const bool allowDepthTexture = m_rd.Get<Uint8>() != 0;
+	if (m_rd.Failed())
+		return;
+
+	delete m_renderTargets[id];
+	m_renderTargets[id] = m_renderer->CreateRenderTarget(RenderTargetDesc(width, height, colorFormat, depthFormat, allowDepthTexture));
+}
+
+void Replayer::SetMaterialParams()
+{
+	const Uint32 id = m_rd.Get<Uint32>();
+	const MaterialParams params = m_rd.Get<MaterialParams>();
+	Material *m = GetMaterial(id);
+	if (!m)
+		return;
+
+	Texture *textures[COUNTOF(params.textures)];
+	for (Uint32 i = 0; i < COUNTOF(params.textures); i++) {
+		RefCountedPtr<Texture> *t = Find(m_textures, params.textures[i]);
+		textures[i] = t ? t->Get() : nullptr;
+	}
+	m->texture0 = textures[0];
+	m->texture1 = textures[1];
+	m->texture2 = textures[2];
+	m->texture3 = textures[3];
+	m->texture4 = textures[4];
+	m->texture5 = textures[5];
+	m->texture6 = textures[6];
+	m->heatGradient = textures[7];
+	m->diffuse = params.diffuse;
+	m->specular = params.specular;
+	m->emissive = params.emissive;
+	m->shininess = params.shininess;
+	m->specialParameter0 = nullptr;
+
+	if (params.hasSpecialParameter)
+		m_specialMaterials.insert(id);
+	else
+		m_specialMaterials.erase(id);
+}
+
+void Replayer::SetTransform(const void *m, size_t size)
+{
+	if (m_haveTransform && size <= sizeof(m_lastTransform) && memcmp(m_lastTransform, m, size) == 0)
+		++m_stats.redundantTransforms;
+	memset(m_lastTransform, 0, sizeof(m_lastTransform));
+	memcpy(m_lastTransform, m, std::min(size, sizeof(m_lastTransform)));
+	m_haveTransform = true;
+}
+
+bool Replayer::Step(std::string &error)
+{
+	if (m_rd.AtEnd()) {
+		error = "trace ends without an end command";
+		return false;
+	}
+
+	const Uint8 cmd = m_rd.Get<Uint8>();
+	if (cmd >= MAX_COMMAND) {
+		error = stringf("unknown command %0{u}", Uint32(cmd));
+		return false;
+	}
+	++m_stats.commands;
+	++m_stats.commandCounts[cmd];
+
+	Renderer *r = m_renderer;
+	switch (Command(cmd)) {
+	case CMD_END:
+		return false;
+
+	case CMD_BEGIN_FRAME: r->BeginFrame(); break;
+	case CMD_END_FRAME: r->EndFrame(); break;
+	case CMD_SWAP_BUFFERS:
+		++m_stats.frames;
+		r->SwapBuffers();
+		break;
+
+	case CMD_CREATE_MATERIAL: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const MaterialDescriptor desc = m_rd.Get<MaterialDescriptor>();
+		m_materials[id].Reset(r->CreateMaterial(desc));
+		++m_stats.objectsCreated;
+		break;
+	}
+	case CMD_CREATE_TEXTURE:
+		CreateTexture();
+		++m_stats.objectsCreated;
+		break;
+	case CMD_CREATE_RENDER_STATE: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		m_renderStates[id] = r->CreateRenderState(m_rd.Get<RenderStateDesc>());
+		++m_stats.objectsCreated;
+		break;
+	}
+	case CMD_CREATE_RENDER_TARGET:
+		CreateRenderTarget();
+		++m_stats.objectsCreated;
+		break;
+	case CMD_CREATE_VERTEX_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const VertexBufferDesc desc = m_rd.Get<VertexBufferDesc>();
+		m_vertexBuffers[id].Reset(r->CreateVertexBuffer(desc));
+		++m_stats.objectsCreated;
+		break;
+	}
+	case CMD_CREATE_INDEX_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const Uint32 size = m_rd.Get<Uint32>();
+		const BufferUsage usage = BufferUsage(m_rd.Get<Uint32>());
+		m_indexBuffers[id].Reset(r->CreateIndexBuffer(size, usage));
+		++m_stats.objectsCreated;
+		break;
+	}
+	case CMD_CREATE_INSTANCE_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const Uint32 size = m_rd.Get<Uint32>();
+		const BufferUsage usage = BufferUsage(m_rd.Get<Uint32>());
+		m_instanceBuffers[id].Reset(r->CreateInstanceBuffer(size, usage));
+		++m_stats.objectsCreated;
+		break;
+	}
+
+	case CMD_UPDATE_VERTEX_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const Uint32 count = m_rd.Get<Uint32>();
+		const Uint32 size = m_rd.Get<Uint32>();
+		RefCountedPtr<VertexBuffer> *vb = Find(m_vertexBuffers, id);
+		const VertexBufferDesc *desc = vb ? &(*vb)->GetDesc() : nullptr;
+		if (!desc || size != desc->numVertices * desc->stride) {
+			error = stringf("vertex buffer %0{u} update doesn't match its definition", id);
+			return false;
+		}
+		(*vb)->SetVertexCount(count);
+		m_rd.GetBytes((*vb)->Map<Uint8>(BUFFER_MAP_WRITE), size);
+		(*vb)->Unmap();
+		m_stats.bytesUploaded += size;
+		break;
+	}
+	case CMD_UPDATE_INDEX_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const Uint32 count = m_rd.Get<Uint32>();
+		RefCountedPtr<IndexBuffer> *ib = Find(m_indexBuffers, id);
+		if (!ib) {
+			error = stringf("index buffer %0{u} is not defined", id);
+			return false;
+		}
+		const Uint32 size = (*ib)->GetSize() * sizeof(Uint32);
+		(*ib)->SetIndexCount(count);
+		m_rd.GetBytes((*ib)->Map(BUFFER_MAP_WRITE), size);
+		(*ib)->Unmap();
+		m_stats.bytesUploaded += size;
+		break;
+	}
+	case CMD_UPDATE_INSTANCE_BUFFER: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		const Uint32 count = m_rd.Get<Uint32>();
+		RefCountedPtr<InstanceBuffer> *ib = Find(m_instanceBuffers, id);
+		if (!ib) {
+			error = stringf("instance buffer %0{u} is not defined", id);
+			return false;
+		}
+		const Uint32 size = (*ib)->GetSize() * sizeof(matrix4x4f);
+		(*ib)->SetInstanceCount(count);
+		m_rd.GetBytes((*ib)->Map(BUFFER_MAP_WRITE), size);
+		(*ib)->Unmap();
+		m_stats.bytesUploaded += size;
+		break;
+	}
+	case CMD_SET_MATERIAL_PARAMS:
+		SetMaterialParams();
+		break;
+
+	case CMD_SET_RENDER_TARGET: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		if (id == m_lastRenderTarget)
+			++m_stats.redundantRenderTargets;
+		m_lastRenderTarget = id;
+		RenderTarget **rt = Find(m_renderTargets, id);
+		r->SetRenderTarget(rt ? *rt : nullptr);
+		break;
+	}
+	case CMD_SET_RENDER_STATE: {
+		const Uint32 id = m_rd.Get<Uint32>();
+		if (id == m_lastRenderState)
+			++m_stats.redundantRenderStates;
+		m_lastRenderState = id;
+		RenderState **rs = Find(m_renderStates, id);
+		if (rs)
+			r->SetRenderState(*rs);
+		break;
+	}
+	case CMD_CLEAR_SCREEN: r->ClearScreen(); break;
+	case CMD_CLEAR_DEPTH_BUFFER: r->ClearDepthBuffer(); break;
+	case CMD_SET_CLEAR_COLOR: r->SetClearColor(m_rd.Get<Color>()); break;
+	case CMD_SET_VIEWPORT: {
+		Sint32 vp[4];
+		m_rd.GetBytes(vp, sizeof(vp));
+		r->SetViewport(vp[0], vp[1], vp[2], vp[3]);
+		break;
+	}
+	case CMD_SET_TRANSFORM: {
+		const matrix4x4f m = m_rd.Get<matrix4x4f>();
+		SetTransform(&m, sizeof(m));
+		r->SetTransform(m);
+		break;
+	}
+	case CMD_SET_TRANSFORM_D: {
+		const matrix4x4d m = m_rd.Get<matrix4x4d>();
+		SetTransform(&m, sizeof(m));
+		r->SetTransform(m);
+		break;
+	}
+	case CMD_SET_PERSPECTIVE: {
+		float args[4];
+		m_rd.GetBytes(args, sizeof(args));
+		r->SetPerspectiveProjection(args[0], args[1], args[2], args[3]);
+		break;
+	}
+	case CMD_SET_ORTHOGRAPHIC: {
+		float args[6];
+		m_rd.GetBytes(args, sizeof(args));
+		r->SetOrthographicProjection(args[0], args[1], args[2], args[3], args[4], args[5]);
+		break;
+	}
+	case CMD_SET_PROJECTION: r->SetProjection(m_rd.Get<matrix4x4f>()); break;
+	case CMD_SET_DEPTH_RANGE: {
+		const double znear = m_rd.Get<double>();
+		const double zfar = m_rd.Get<double>();
+		r->SetDepthRange(znear, zfar);
+		break;
+	}
+	case CMD_SET_WIREFRAME: r->SetWireFrameMode(m_rd.Get<Uint8>() != 0); break;
+	case CMD_SET_LIGHTS: {
+		const Uint32 count = std::min(m_rd.Get<Uint32>(), TOTAL_NUM_LIGHTS);
+		Light lights[TOTAL_NUM_LIGHTS];
+		for (Uint32 i = 0; i < count; i++) {
+			lights[i].SetType(Light::LightType(m_rd.Get<Uint32>()));
+			lights[i].SetPosition(m_rd.Get<vector3f>());
+			lights[i].SetDiffuse(m_rd.Get<Color>());
+			lights[i].SetSpecular(m_rd.Get<Color>());
+		}
+		r->SetLights(count, lights);
+		break;
+	}
+	case CMD_SET_AMBIENT: r->SetAmbientColor(m_rd.Get<Color>()); break;
+	case CMD_SET_SCISSOR: {
+		const bool enabled = m_rd.Get<Uint8>() != 0;
+		const vector2f pos = m_rd.Get<vector2f>();
+		const vector2f size = m_rd.Get<vector2f>();
+		r->SetScissor(enabled, pos, size);
+		break;
+	}
+
+	case CMD_SET_MATRIX_MODE: r->SetMatrixMode(MatrixMode(m_rd.Get<Uint32>())); break;
+	case CMD_PUSH_MATRIX: r->PushMatrix(); break;
+	case CMD_POP_MATRIX: r->PopMatrix(); break;
+	case CMD_LOAD_IDENTITY: r->LoadIdentity(); break;
+	case CMD_LOAD_MATRIX: r->LoadMatrix(m_rd.Get<matrix4x4f>()); break;
+	case CMD_TRANSLATE: {
+		const vector3f v = m_rd.Get<vector3f>();
+		r->Translate(v.x, v.y, v.z);
+		break;
+	}
+	case CMD_SCALE: {
+		const vector3f v = m_rd.Get<vector3f>();
+		r->Scale(v.x, v.y, v.z);
+		break;
+	}
+	// the state stack is protected, but a ticket may use it
+	case CMD_PUSH_STATE: m_stateTickets.push_back(new Renderer::StateTicket(r)); break;
+	case CMD_POP_STATE:
+		if (!m_stateTickets.empty()) {
+			delete m_stateTickets.back();
+			m_stateTickets.pop_back();
+		}
+		break;
+
+	case CMD_DRAW_TRIANGLES: {
+		VertexArray va(AttributeSet(m_rd.Get<Uint32>()));
+		m_rd.GetVector(va.position);
+		m_rd.GetVector(va.normal);
+		m_rd.GetVector(va.diffuse);
+		m_rd.GetVector(va.uv0);
+		m_rd.GetVector(va.tangent);
+		const Uint32 rsId = m_rd.Get<Uint32>();
+		const Uint32 mId = m_rd.Get<Uint32>();
+		const PrimitiveType type = PrimitiveType(m_rd.Get<Uint32>());
+		Draw(rsId, mId, va.GetNumVerts());
+		m_stats.bytesUploaded += va.position.size() * sizeof(vector3f) + va.normal.size() * sizeof(vector3f) +
+			va.diffuse.size() * sizeof(Color) + va.uv0.size() * sizeof(vector2f) + va.tangent.size() * sizeof(vector3f);
+		RenderState **rs = Find(m_renderStates, rsId);
+		if (!CanDraw(mId) || !rs || va.IsEmpty())
+			++m_stats.drawsSkipped;
+		else
+			r->DrawTriangles(&va, *rs, GetMaterial(mId), type);
+		break;
+	}
+	case CMD_DRAW_POINT_SPRITES: {
+		const Uint32 count = m_rd.Get<Uint32>();
+		std::vector<vector3f> positions(count);
+		if (count)
+			m_rd.GetBytes(&positions[0], count * sizeof(vector3f));
+		const Uint32 rsId = m_rd.Get<Uint32>();
+		const Uint32 mId = m_rd.Get<Uint32>();
+		const float size = m_rd.Get<float>();
+		Draw(rsId, mId, count);
+		m_stats.bytesUploaded += count * sizeof(vector3f);
+		RenderState **rs = Find(m_renderStates, rsId);
+		if (!CanDraw(mId) || !rs || !count || m_rd.Failed())
+			++m_stats.drawsSkipped;
+		else
+			r->DrawPointSprites(count, &positions[0], *rs, GetMaterial(mId), size);
+		break;
+	}
+	case CMD_DRAW_POINT_SPRITES_SIZED: {
+		const Uint32 count = m_rd.Get<Uint32>();
+		std::vector<vector3f> positions(count);
+		std::vector<vector2f> offsets(count);
+		std::vector<float> sizes(count);
+		if (count) {
+			m_rd.GetBytes(&positions[0], count * sizeof(vector3f));
+			m_rd.GetBytes(&offsets[0], count * sizeof(vector2f));
+			m_rd.GetBytes(&sizes[0], count * sizeof(float));
+		}
+		const Uint32 rsId = m_rd.Get<Uint32>();
+		const Uint32 mId = m_rd.Get<Uint32>();
+		Draw(rsId, mId, count);
+		m_stats.bytesUploaded += count * (sizeof(vector3f) + sizeof(vector2f) + sizeof(float));
+		RenderState **rs = Find(m_renderStates, rsId);
+		if (!CanDraw(mId) || !rs || !count || m_rd.Failed())
+			++m_stats.drawsSkipped;
+		else
+			r->DrawPointSprites(count, &positions[0], &offsets[0], &sizes[0], *rs, GetMaterial(mId));
+		break;
+	}
+	case CMD_DRAW_BUFFER:
+	case CMD_DRAW_BUFFER_INDEXED:
+	case CMD_DRAW_BUFFER_INSTANCED:
+	case CMD_DRAW_BUFFER_INDEXED_INSTANCED: {
+		const bool indexed = (cmd == CMD_DRAW_BUFFER_INDEXED || cmd == CMD_DRAW_BUFFER_INDEXED_INSTANCED);
+		const bool instanced = (cmd == CMD_DRAW_BUFFER_INSTANCED || cmd == CMD_DRAW_BUFFER_INDEXED_INSTANCED);
+		const Uint32 vbId = m_rd.Get<Uint32>();
+		const Uint32 ibId = indexed ? m_rd.Get<Uint32>() : 0;
+		const Uint32 rsId = m_rd.Get<Uint32>();
+		const Uint32 mId = m_rd.Get<Uint32>();
+		const Uint32 instId = instanced ? m_rd.Get<Uint32>() : 0;
+		const PrimitiveType type = PrimitiveType(m_rd.Get<Uint32>());
+
+		RefCountedPtr<VertexBuffer> *vb = Find(m_vertexBuffers, vbId);
+		RefCountedPtr<IndexBuffer> *ib = indexed ? Find(m_indexBuffers, ibId) : nullptr;
+		RefCountedPtr<InstanceBuffer> *inst = instanced ? Find(m_instanceBuffers, instId) : nullptr;
+		RenderState **rs = Find(m_renderStates, rsId);
+		if (!vb || (indexed && !ib) || (instanced && !inst) || !rs) {
+			error = stringf("draw %0 uses objects the trace doesn't define", CommandName(Command(cmd)));
+			return false;
+		}
+
+		Uint64 vertices = indexed ? (*ib)->GetIndexCount() : (*vb)->GetVertexCount();
+		if (instanced)
+			vertices *= (*inst)->GetInstanceCount();
+		Draw(rsId, mId, vertices);
+		if (!CanDraw(mId)) {
+			++m_stats.drawsSkipped;
+			break;
+		}
+
+		Material *m = GetMaterial(mId);
+		switch (cmd) {
+		case CMD_DRAW_BUFFER: r->DrawBuffer(vb->Get(), *rs, m, type); break;
+		case CMD_DRAW_BUFFER_INDEXED: r->DrawBufferIndexed(vb->Get(), ib->Get(), *rs, m, type); break;
+		case CMD_DRAW_BUFFER_INSTANCED: r->DrawBufferInstanced(vb->Get(), *rs, m, inst->Get(), type); break;
+		default: r->DrawBufferIndexedInstanced(vb->Get(), ib->Get(), *rs, m, inst->Get(), type); break;
+		}
+		break;
+	}
+
+	case MAX_COMMAND:
+		break;
+	}
+
+	if (m_rd.Failed()) {
+		error = stringf("trace is truncated in a %0 command", CommandName(Command(cmd)));
+		return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+bool Replay(Renderer *r, const ByteRange &trace, ReplayStats &stats, std::string &error)
+{
+	PROFILE_SCOPED()
+	Reader rd(trace);
+
+	char magic[sizeof(MAGIC)];
+	rd.GetBytes(magic, sizeof(magic));
+	if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+		error = "not a renderer trace";
+		return false;
+	}
+	if (rd.Get<Uint32>() != VERSION) {
+		error = "trace is from a different version";
+		return false;
+	}
+	if (rd.Get<Uint32>() != BYTE_ORDER_MARK) {
+		error = "trace was written on a machine of different byte order";
+		return false;
+	}
+	// the window size at capture, the replay draws at whatever size it has
+	rd.Get<Sint32>();
+	rd.Get<Sint32>();
+
+	Replayer replayer(r, rd, stats);
+	while (replayer.Step(error)) {}
+	return error.empty();
+}
+
+} // namespace Trace
+} // namespace Graphics
@@ -0,0 +1,200 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _GRAPHICS_RENDERTRACE_H
+#define _GRAPHICS_RENDERTRACE_H
+/*
+ * Binary traces of renderer calls, as written by RendererRecorder and
+ * played back against any renderer by Trace::Replay.
+ *
+ * A trace is a header followed by commands, each a Command byte and
+ * its arguments. Everything is in the byte order of the machine that wrote
+ * it, traces are for profiling and not meant to be portable.
+ * Objects (materials, textures, buffers...) are referred to by an id that
+ * the trace defines before it is first used. Id 0 is null.
+ */
+#include "libs.h"
+#include "ByteRange.h"
+
+namespace Graphics {
+
+class Renderer;
+
+namespace Trace {
+
+static const char MAGIC[8] = { 'P', 'I', 'O', 'R', 'T', 'R', 'C', '\0' };
+static const Uint32 VERSION = 1;
+// written after the version, so a trace from a machine of the other byte
+// order is rejected instead of misread
+static const Uint32 BYTE_ORDER_MARK = 0x01020304;
+
+enum Command {
+	CMD_END,
+
+	// frame
+	CMD_BEGIN_FRAME,
+	CMD_END_FRAME,
+	CMD_SWAP_BUFFERS,
+
+	// definitions
+	CMD_CREATE_MATERIAL,		// id, MaterialDescriptor
+	CMD_CREATE_TEXTURE,			// id, TextureDescriptor
+	CMD_CREATE_RENDER_STATE,	// id, RenderStateDesc
+	CMD_CREATE_RENDER_TARGET,	// id, RenderTargetDesc
+	CMD_CREATE_VERTEX_BUFFER,	// id, VertexBufferDesc
+	CMD_CREATE_INDEX_BUFFER,	// id, size, usage
+	CMD_CREATE_INSTANCE_BUFFER,	// id, size, usage
+
+	// uploads
+	CMD_UPDATE_VERTEX_BUFFER,	// id, vertex count, bytes
+	CMD_UPDATE_INDEX_BUFFER,	// id, index count, bytes
+	CMD_UPDATE_INSTANCE_BUFFER,	// id, instance count, bytes
+	CMD_SET_MATERIAL_PARAMS,	// id, MaterialParams
+
+	// state
+	CMD_SET_RENDER_TARGET,
+	CMD_SET_RENDER_STATE,
+	CMD_CLEAR_SCREEN,
+	CMD_CLEAR_DEPTH_BUFFER,
+	CMD_SET_CLEAR_COLOR,
+	CMD_SET_VIEWPORT,
+	CMD_SET_TRANSFORM,			// matrix4x4f
+	CMD_SET_TRANSFORM_D,		// matrix4x4d
+	CMD_SET_PERSPECTIVE,
+	CMD_SET_ORTHOGRAPHIC,
+	CMD_SET_PROJECTION,
+	CMD_SET_DEPTH_RANGE,
+	CMD_SET_WIREFRAME,
+	CMD_SET_LIGHTS,
+	CMD_SET_AMBIENT,
+	CMD_SET_SCISSOR,
+
+	// matrix stack
+	CMD_SET_MATRIX_MODE,
+	CMD_PUSH_MATRIX,
+	CMD_POP_MATRIX,
+	CMD_LOAD_IDENTITY,
+	CMD_LOAD_MATRIX,
+	CMD_TRANSLATE,
+	CMD_SCALE,
+	CMD_PUSH_STATE,
+	CMD_POP_STATE,
+
+	// draws
+	CMD_DRAW_TRIANGLES,			// VertexArray, render state, material, primitive
+	CMD_DRAW_POINT_SPRITES,
+	CMD_DRAW_POINT_SPRITES_SIZED,
+	CMD_DRAW_BUFFER,
+	CMD_DRAW_BUFFER_INDEXED,
+	CMD_DRAW_BUFFER_INSTANCED,
+	CMD_DRAW_BUFFER_INDEXED_INSTANCED,
+
+	MAX_COMMAND
+};
+
+// the per-draw parameters of a material, with textures as trace ids
+struct MaterialParams {
+	Uint32 textures[8];	// texture0-6, heatGradient
+	Color diffuse;
+	Color specular;
+	Color emissive;
+	Sint32 shininess;
+	// specialParameter0 points at effect specific data that can't be
+	// captured, only whether it was set is
+	Uint32 hasSpecialParameter;
+};
+
+// appends plain values to a growing buffer
+class Writer {
+public:
+	template <typename T> void Put(const T &value) { PutBytes(&value, sizeof(T)); }
+	void PutBytes(const void *data, size_t size) {
+		const Uint8 *bytes = static_cast<const Uint8*>(data);
+		m_data.insert(m_data.end(), bytes, bytes + size);
+	}
+	template <typename T> void PutVector(const std::vector<T> &values) {
+		Put<Uint32>(values.size());
+		if (!values.empty())
+			PutBytes(&values[0], values.size() * sizeof(T));
+	}
+
+	const std::vector<Uint8> &GetData() const { return m_data; }
+	size_t GetSize() const { return m_data.size(); }
+
+private:
+	std::vector<Uint8> m_data;
+};
+
+// reads back what Writer wrote. reading past the end answers zeroes and
+// marks the reader as failed, rather than reading beyond the data
+class Reader {
+public:
+	Reader(const ByteRange &data) : m_at(data.begin), m_end(data.end), m_failed(false) {}
+
+	template <typename T> T Get() { T value; GetBytes(&value, sizeof(T)); return value; }
+	bool GetBytes(void *out, size_t size) {
+		if (size_t(m_end - m_at) < size) {
+			memset(out, 0, size);
+			m_at = m_end;
+			m_failed = true;
+			return false;
+		}
+		memcpy(out, m_at, size);
+		m_at += size;
+		return true;
+	}
+	template <typename T> void GetVector(std::vector<T> &values) {
+		const Uint32 count = Get<Uint32>();
+		if (size_t(m_end - m_at) / sizeof(T) < count) {
+			m_at = m_end;
+			m_failed = true;
+			return;
+		}
+		values.resize(count);
+		if (count)
+			GetBytes(&values[0], count * sizeof(T));
+	}
+
+	bool AtEnd() const { return m_at == m_end; }
+	bool Failed() const { return m_failed; }
+
+private:
+	const char *m_at;
+	const char *m_end;
+	bool m_failed;
+};
+
+// what a replay found in the trace
+struct ReplayStats {
+	Uint32 frames = 0;
+	Uint32 commands = 0;
+	Uint32 commandCounts[MAX_COMMAND] = {};
+	Uint32 objectsCreated = 0;
+	Uint32 draws = 0;
+	// draws with materials whose specialParameter0 was set are counted,
+	// but not made, since what it pointed at isn't in the trace
+	Uint32 drawsSkipped = 0;
+	Uint64 verticesDrawn = 0;			// indices for indexed draws, times instances
+	Uint64 bytesUploaded = 0;			// buffer contents and vertices drawn from memory
+	// draws that use a different material or render state to the draw
+	// before them
+	Uint32 materialChanges = 0;
+	Uint32 renderStateChanges = 0;
+	// calls that set what was already set
+	Uint32 redundantRenderStates = 0;
+	Uint32 redundantTransforms = 0;
+	Uint32 redundantRenderTargets = 0;
+};
+
+// answers the name of a command, for reports
+const char *CommandName(Command cmd);
+
+// issues the calls in the trace to the renderer. answers false, with the
+// reason in error, if the trace is not one that can be replayed
+bool Replay(Renderer *r, const ByteRange &trace, ReplayStats &stats, std::string &error);
+
+} // namespace Trace
+
+} // namespace Graphics
+
+#endif
@@ -89,6 +89,9 @@ public:
 	virtual bool SetProjection(const matrix4x4f &m) = 0;
 
 	virtual bool SetRenderState(RenderState*) = 0;
+	// forget any state the renderer skips setting again because it thinks
+	// it's already set, after code outside it has made its own API calls
+	virtual void InvalidateStateCache() { }
 
 	// XXX maybe GL-specific. maybe should be part of the render state
 	virtual bool SetDepthRange(double znear, double zfar) = 0;
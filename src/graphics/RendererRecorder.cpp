@@ -0,0 +1,941 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "RendererRecorder.h"
+#include "Material.h"
+#include "RenderState.h"
+#include "RenderTarget.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "FileSystem.h"
+#include "utils.h"
+
+namespace Graphics {
+
+namespace Recorder {
+
+// hands the parameters set on it to the wrapped material when it's used
+class Material : public Graphics::Material {
+public:
+	Material(Uint32 id, Graphics::Material *material) : m_id(id), m_material(material) {
+		m_descriptor = material->GetDescriptor();
+	}
+
+	Uint32 GetId() const { return m_id; }
+
+	Graphics::Material *Sync() {
+		Graphics::Material *m = m_material.Get();
+		m->texture0 = texture0;
+		m->texture1 = texture1;
+		m->texture2 = texture2;
+		m->texture3 = texture3;
+		m->texture4 = texture4;
+		m->texture5 = texture5;
+		m->texture6 = texture6;
+		m->heatGradient = heatGradient;
+		m->diffuse = diffuse;
+		m->specular = specular;
+		m->emissive = emissive;
+		m->shininess = shininess;
+		m->specialParameter0 = specialParameter0;
+		return m;
+	}
+
+	virtual void Apply() override { Sync()->Apply(); }
+	virtual void Unapply() override { m_material->Unapply(); }
+	virtual bool IsProgramLoaded() const override { return m_material->IsProgramLoaded(); }
+	virtual Uint32 GetShaderID() const override { return m_material->GetShaderID(); }
+	virtual void SetCommonUniforms(const matrix4x4f& mv, const matrix4x4f& proj) override { m_material->SetCommonUniforms(mv, proj); }
+
+private:
+	const Uint32 m_id;
+	RefCountedPtr<Graphics::Material> m_material;
+};
+
+// writes go to a copy of the contents, which is handed to the wrapped
+// buffer on Unmap
+class VertexBuffer : public Graphics::VertexBuffer {
+public:
+	VertexBuffer(RendererRecorder *recorder, Uint32 id, Graphics::VertexBuffer *vb) :
+		Graphics::VertexBuffer(vb->GetDesc()),
+		m_recorder(recorder),
+		m_id(id),
+		m_buffer(vb),
+		m_size(m_desc.numVertices * m_desc.stride),
+		m_data(new Uint8[m_size])
+	{
+		m_numVertices = vb->GetVertexCount();
+		memset(m_data.get(), 0, m_size);
+	}
+
+	Uint32 GetId() const { return m_id; }
+	const Uint8 *GetData() const { return m_data.get(); }
+	Uint32 GetSize() const { return m_size; }
+
+	Graphics::VertexBuffer *Sync() {
+		m_buffer->SetVertexCount(m_numVertices);
+		return m_buffer.Get();
+	}
+
+	virtual bool Populate(const VertexArray &va) override {
+		const bool result = Sync()->Populate(va);
+		const Uint32 count = std::min(va.GetNumVerts(), m_desc.numVertices);
+		for (Uint32 i = 0; i < MAX_ATTRIBS && m_desc.attrib[i].semantic != ATTRIB_NONE; i++) {
+			const VertexAttribDesc &attrib = m_desc.attrib[i];
+			Uint8 *dst = m_data.get() + attrib.offset;
+			const Uint32 size = VertexBufferDesc::GetAttribSize(attrib.format);
+			switch (attrib.semantic) {
+			case ATTRIB_POSITION:	CopyAttrib(dst, size, count, va.position);	break;
+			case ATTRIB_NORMAL:		CopyAttrib(dst, size, count, va.normal);	break;
+			case ATTRIB_DIFFUSE:	CopyAttrib(dst, size, count, va.diffuse);	break;
+			case ATTRIB_UV0:		CopyAttrib(dst, size, count, va.uv0);		break;
+			case ATTRIB_TANGENT:	CopyAttrib(dst, size, count, va.tangent);	break;
+			default:
+				break;
+			}
+		}
+		m_recorder->Updated(this);
+		return result;
+	}
+
+	virtual void BufferData(const size_t size, void *data) override {
+		Sync()->BufferData(size, data);
+		memcpy(m_data.get(), data, std::min<size_t>(size, m_size));
+		m_recorder->Updated(this);
+	}
+
+	virtual void Unmap() override {
+		if (m_mapMode == BUFFER_MAP_WRITE) {
+			Uint8 *dst = Sync()->Map<Uint8>(BUFFER_MAP_WRITE);
+			memcpy(dst, m_data.get(), m_size);
+			m_buffer->Unmap();
+			m_recorder->Updated(this);
+		}
+		m_mapMode = BUFFER_MAP_NONE;
+	}
+
+	virtual void Bind() override { Sync()->Bind(); }
+	virtual void Release() override { m_buffer->Release(); }
+
+protected:
+	virtual Uint8 *MapInternal(BufferMapMode mode) override {
+		m_mapMode = mode;
+		return m_data.get();
+	}
+
+private:
+	template <typename T>
+	void CopyAttrib(Uint8 *dst, Uint32 size, Uint32 count, const std::vector<T> &src) {
+		const Uint32 bytes = std::min<Uint32>(size, sizeof(T));
+		for (Uint32 i = 0; i < count && i < src.size(); i++) {
+			memcpy(dst, &src[i], bytes);
+			dst += m_desc.stride;
+		}
+	}
+
+	RendererRecorder *m_recorder;
+	const Uint32 m_id;
+	RefCountedPtr<Graphics::VertexBuffer> m_buffer;
+	const Uint32 m_size;
+	std::unique_ptr<Uint8[]> m_data;
+};
+
+class IndexBuffer : public Graphics::IndexBuffer {
+public:
+	IndexBuffer(RendererRecorder *recorder, Uint32 id, Graphics::IndexBuffer *ib) :
+		Graphics::IndexBuffer(ib->GetSize(), ib->GetUsage()),
+		m_recorder(recorder),
+		m_id(id),
+		m_buffer(ib),
+		m_data(new Uint32[m_size])
+	{
+		m_indexCount = ib->GetIndexCount();
+		memset(m_data.get(), 0, m_size * sizeof(Uint32));
+	}
+
+	Uint32 GetId() const { return m_id; }
+	const Uint32 *GetData() const { return m_data.get(); }
+
+	Graphics::IndexBuffer *Sync() {
+		m_buffer->SetIndexCount(m_indexCount);
+		return m_buffer.Get();
+	}
+
+	virtual Uint32 *Map(BufferMapMode mode) override {
+		m_mapMode = mode;
+		return m_data.get();
+	}
+
+	virtual void Unmap() override {
+		if (m_mapMode == BUFFER_MAP_WRITE) {
+			Uint32 *dst = Sync()->Map(BUFFER_MAP_WRITE);
+			memcpy(dst, m_data.get(), m_size * sizeof(Uint32));
+			m_buffer->Unmap();
+			m_recorder->Updated(this);
+		}
+		m_mapMode = BUFFER_MAP_NONE;
+	}
+
+	virtual void BufferData(const size_t size, void *data) override {
+		Sync()->BufferData(size, data);
+		memcpy(m_data.get(), data, std::min<size_t>(size, m_size * sizeof(Uint32)));
+		m_recorder->Updated(this);
+	}
+
+	virtual void Bind() override { Sync()->Bind(); }
+	virtual void Release() override { m_buffer->Release(); }
+
+private:
+	RendererRecorder *m_recorder;
+	const Uint32 m_id;
+	RefCountedPtr<Graphics::IndexBuffer> m_buffer;
+	std::unique_ptr<Uint32[]> m_data;
+};
+
+class InstanceBuffer : public Graphics::InstanceBuffer {
+public:
+	InstanceBuffer(RendererRecorder *recorder, Uint32 id, Graphics::InstanceBuffer *ib) :
+		Graphics::InstanceBuffer(ib->GetSize(), ib->GetUsage()),
+		m_recorder(recorder),
+		m_id(id),
+		m_buffer(ib),
+		m_data(new matrix4x4f[m_size])
+	{
+		m_instanceCount = ib->GetInstanceCount();
+	}
+
+	Uint32 GetId() const { return m_id; }
+	const matrix4x4f *GetData() const { return m_data.get(); }
+
+	Graphics::InstanceBuffer *Sync() {
+		m_buffer->SetInstanceCount(m_instanceCount);
+		return m_buffer.Get();
+	}
+
+	virtual matrix4x4f *Map(BufferMapMode mode) override {
+		m_mapMode = mode;
+		return m_data.get();
+	}
+
+	virtual void Unmap() override {
+		if (m_mapMode == BUFFER_MAP_WRITE) {
+			matrix4x4f *dst = Sync()->Map(BUFFER_MAP_WRITE);
+			memcpy(dst, m_data.get(), m_size * sizeof(matrix4x4f));
+			m_buffer->Unmap();
+			m_recorder->Updated(this);
+		}
+		m_mapMode = BUFFER_MAP_NONE;
+	}
+
+	virtual void Bind() override { Sync()->Bind(); }
+	virtual void Release() override { m_buffer->Release(); }
+
+private:
+	RendererRecorder *m_recorder;
+	const Uint32 m_id;
+	RefCountedPtr<Graphics::InstanceBuffer> m_buffer;
+	std::unique_ptr<matrix4x4f[]> m_data;
+};
+
+// swap the wrappers for what they wrap
+static Graphics::Material *Unwrap(Graphics::Material *m)
+{
+	return m ? static_cast<Material*>(m)->Sync() : nullptr;
+}
+
+static Graphics::VertexBuffer *Unwrap(Graphics::VertexBuffer *vb)
+{
+	return vb ? static_cast<VertexBuffer*>(vb)->Sync() : nullptr;
+}
+
+static Graphics::IndexBuffer *Unwrap(Graphics::IndexBuffer *ib)
+{
+	return ib ? static_cast<IndexBuffer*>(ib)->Sync() : nullptr;
+}
+
+static Graphics::InstanceBuffer *Unwrap(Graphics::InstanceBuffer *ib)
+{
+	return ib ? static_cast<InstanceBuffer*>(ib)->Sync() : nullptr;
+}
+
+} // namespace Recorder
+
+RendererRecorder::RendererRecorder(Renderer *renderer) :
+	Renderer(renderer->GetSDLWindow(), renderer->GetWindowWidth(), renderer->GetWindowHeight()),
+	m_renderer(renderer),
+	m_name(std::string(renderer->GetName()) + " (recording)"),
+	m_nextId(1),
+	m_numLights(0),
+	m_framesToCapture(0),
+	m_capturing(false)
+{
+}
+
+RendererRecorder::~RendererRecorder()
+{
+	// the textures, and the window, belong to the wrapped renderer
+	RemoveAllCachedTextures();
+	while (!m_stateTickets.empty())
+		PopState();
+	m_renderer.reset();
+	m_window = nullptr;
+}
+
+void RendererRecorder::Capture(const std::string &filename, Uint32 numFrames)
+{
+	if (IsCapturing() || !numFrames)
+		return;
+	m_filename = filename;
+	m_framesToCapture = numFrames;
+}
+
+Trace::Writer *RendererRecorder::Record(Trace::Command cmd)
+{
+	if (!m_trace)
+		return nullptr;
+	m_trace->Put<Uint8>(cmd);
+	return m_trace.get();
+}
+
+bool RendererRecorder::Define(Uint32 id)
+{
+	return m_defined.insert(id).second;
+}
+
+// the state set before the capture started, as far as it can be asked for
+void RendererRecorder::WriteSnapshot()
+{
+	Sint32 vp[4];
+	m_renderer->GetCurrentViewport(vp);
+	Trace::Writer *w = Record(Trace::CMD_SET_VIEWPORT);
+	w->PutBytes(vp, sizeof(vp));
+
+	Record(Trace::CMD_SET_PROJECTION)->Put(m_renderer->GetCurrentProjection());
+	Record(Trace::CMD_SET_TRANSFORM)->Put(m_renderer->GetCurrentModelView());
+	WriteLights();
+	Record(Trace::CMD_SET_AMBIENT)->Put(m_ambient);
+}
+
+void RendererRecorder::WriteLights()
+{
+	Trace::Writer *w = Record(Trace::CMD_SET_LIGHTS);
+	w->Put<Uint32>(m_numLights);
+	for (Uint32 i = 0; i < m_numLights; i++) {
+		w->Put<Uint32>(m_lights[i].GetType());
+		w->Put(m_lights[i].GetPosition());
+		w->Put(m_lights[i].GetDiffuse());
+		w->Put(m_lights[i].GetSpecular());
+	}
+}
+
+void RendererRecorder::FinishCapture()
+{
+	Record(Trace::CMD_END);
+
+	static const std::string dir("traces");
+	FileSystem::userFiles.MakeDirectory(dir);
+	const std::string path = FileSystem::JoinPathBelow(dir, m_filename);
+	FILE *f = FileSystem::userFiles.OpenWriteStream(path);
+	if (f) {
+		const std::vector<Uint8> &data = m_trace->GetData();
+		const size_t written = fwrite(&data[0], 1, data.size(), f);
+		fclose(f);
+		if (written == data.size())
+			Output("Renderer trace written to %s (%u bytes)\n", path.c_str(), Uint32(data.size()));
+		else
+			Output("Renderer trace %s could not be written completely\n", path.c_str());
+	} else
+		Output("Could not open renderer trace %s for writing\n", path.c_str());
+
+	// the ids of unwrapped objects only mean anything within a trace, and
+	// the objects may be gone by the next one
+	m_trace.reset();
+	m_ids.clear();
+	m_defined.clear();
+	m_materialParams.clear();
+	m_capturing = false;
+}
+
+Uint32 RendererRecorder::Ref(Texture *t)
+{
+	if (!t)
+		return 0;
+	// textures created inside the wrapped renderer, like those of render
+	// targets, get an id the first time they're seen
+	auto it = m_ids.find(t);
+	if (it == m_ids.end())
+		it = m_ids.insert(std::make_pair(t, NewId())).first;
+	const Uint32 id = it->second;
+
+	if (Define(id)) {
+		const TextureDescriptor &desc = t->GetDescriptor();
+		Trace::Writer *w = Record(Trace::CMD_CREATE_TEXTURE);
+		w->Put(id);
+		w->Put<Uint32>(desc.format);
+		w->Put(desc.dataSize);
+		w->Put(desc.texSize);
+		w->Put<Uint32>(desc.sampleMode);
+		w->Put<Uint8>(desc.generateMipmaps);
+		w->Put<Uint8>(desc.allowCompression);
+		w->Put<Uint8>(desc.useAnisotropicFiltering);
+		w->Put<Uint32>(desc.numberOfMipMaps);
+		w->Put<Uint32>(desc.type);
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(RenderState *rs)
+{
+	if (!rs)
+		return 0;
+	auto it = m_ids.find(rs);
+	if (it == m_ids.end())
+		it = m_ids.insert(std::make_pair(rs, NewId())).first;
+	const Uint32 id = it->second;
+
+	if (Define(id)) {
+		Trace::Writer *w = Record(Trace::CMD_CREATE_RENDER_STATE);
+		w->Put(id);
+		w->Put(rs->GetDesc());
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(RenderTarget *rt)
+{
+	if (!rt)
+		return 0;
+	auto it = m_ids.find(rt);
+	if (it == m_ids.end())
+		it = m_ids.insert(std::make_pair(rt, NewId())).first;
+	const Uint32 id = it->second;
+
+	if (Define(id)) {
+		const RenderTargetDesc &desc = rt->GetDesc();
+		Trace::Writer *w = Record(Trace::CMD_CREATE_RENDER_TARGET);
+		w->Put(id);
+		w->Put(desc.width);
+		w->Put(desc.height);
+		w->Put<Uint32>(desc.colorFormat);
+		w->Put<Uint32>(desc.depthFormat);
+		w->Put<Uint8>(desc.allowDepthTexture);
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(Material *m)
+{
+	if (!m)
+		return 0;
+	const Uint32 id = static_cast<Recorder::Material*>(m)->GetId();
+
+	if (Define(id)) {
+		Trace::Writer *w = Record(Trace::CMD_CREATE_MATERIAL);
+		w->Put(id);
+		w->Put(m->GetDescriptor());
+	}
+
+	// parameters are set on the material directly, so the trace only finds
+	// out about them when it's drawn with
+	Trace::MaterialParams params = {};
+	Texture *textures[] = { m->texture0, m->texture1, m->texture2, m->texture3, m->texture4, m->texture5, m->texture6, m->heatGradient };
+	static_assert(COUNTOF(textures) == COUNTOF(params.textures), "texture count mismatch");
+	for (Uint32 i = 0; i < COUNTOF(textures); i++)
+		params.textures[i] = Ref(textures[i]);
+	params.diffuse = m->diffuse;
+	params.specular = m->specular;
+	params.emissive = m->emissive;
+	params.shininess = m->shininess;
+	params.hasSpecialParameter = m->specialParameter0 ? 1 : 0;
+
+	auto it = m_materialParams.find(id);
+	if (it == m_materialParams.end() || memcmp(&it->second, &params, sizeof(params)) != 0) {
+		m_materialParams[id] = params;
+		Trace::Writer *w = Record(Trace::CMD_SET_MATERIAL_PARAMS);
+		w->Put(id);
+		w->Put(params);
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(VertexBuffer *vb)
+{
+	if (!vb)
+		return 0;
+	Recorder::VertexBuffer *buffer = static_cast<Recorder::VertexBuffer*>(vb);
+	const Uint32 id = buffer->GetId();
+	if (Define(id)) {
+		Trace::Writer *w = Record(Trace::CMD_CREATE_VERTEX_BUFFER);
+		w->Put(id);
+		w->Put(buffer->GetDesc());
+		Updated(buffer);
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(IndexBuffer *ib)
+{
+	if (!ib)
+		return 0;
+	Recorder::IndexBuffer *buffer = static_cast<Recorder::IndexBuffer*>(ib);
+	const Uint32 id = buffer->GetId();
+	if (Define(id)) {
+		Trace::Writer *w = Record(Trace::CMD_CREATE_INDEX_BUFFER);
+		w->Put(id);
+		w->Put(buffer->GetSize());
+		w->Put<Uint32>(buffer->GetUsage());
+		Updated(buffer);
+	}
+	return id;
+}
+
+Uint32 RendererRecorder::Ref(InstanceBuffer *ib)
+{
+	if (!ib)
+		return 0;
+	Recorder::InstanceBuffer *buffer = static_cast<Recorder::InstanceBuffer*>(ib);
+	const Uint32 id = buffer->GetId();
+	if (Define(id)) {
+		Trace::Writer *w = Record(Trace::CMD_CREATE_INSTANCE_BUFFER);
+		w->Put(id);
+		w->Put(buffer->GetSize());
+		w->Put<Uint32>(buffer->GetUsage());
+		Updated(buffer);
+	}
+	return id;
+}
+
+// buffers not yet used in this capture are written out in full when they
+// are first drawn with, so until then their uploads can be left out
+void RendererRecorder::Updated(Recorder::VertexBuffer *vb)
+{
+	if (!m_trace || !m_defined.count(vb->GetId()))
+		return;
+	Trace::Writer *w = Record(Trace::CMD_UPDATE_VERTEX_BUFFER);
+	w->Put(vb->GetId());
+	w->Put(vb->GetVertexCount());
+	w->Put(vb->GetSize());
+	w->PutBytes(vb->GetData(), vb->GetSize());
+}
+
+void RendererRecorder::Updated(Recorder::IndexBuffer *ib)
+{
+	if (!m_trace || !m_defined.count(ib->GetId()))
+		return;
+	Trace::Writer *w = Record(Trace::CMD_UPDATE_INDEX_BUFFER);
+	w->Put(ib->GetId());
+	w->Put(ib->GetIndexCount());
+	w->PutBytes(ib->GetData(), ib->GetSize() * sizeof(Uint32));
+}
+
+void RendererRecorder::Updated(Recorder::InstanceBuffer *ib)
+{
+	if (!m_trace || !m_defined.count(ib->GetId()))
+		return;
+	Trace::Writer *w = Record(Trace::CMD_UPDATE_INSTANCE_BUFFER);
+	w->Put(ib->GetId());
+	w->Put(ib->GetInstanceCount());
+	w->PutBytes(ib->GetData(), ib->GetSize() * sizeof(matrix4x4f));
+}
+
+bool RendererRecorder::BeginFrame()
+{
+	if (m_framesToCapture && !m_capturing) {
+		m_trace.reset(new Trace::Writer);
+		m_trace->PutBytes(Trace::MAGIC, sizeof(Trace::MAGIC));
+		m_trace->Put(Trace::VERSION);
+		m_trace->Put(Trace::BYTE_ORDER_MARK);
+		m_trace->Put<Sint32>(m_width);
+		m_trace->Put<Sint32>(m_height);
+		m_capturing = true;
+		WriteSnapshot();
+	}
+	Record(Trace::CMD_BEGIN_FRAME);
+	return m_renderer->BeginFrame();
+}
+
+bool RendererRecorder::EndFrame()
+{
+	Record(Trace::CMD_END_FRAME);
+	return m_renderer->EndFrame();
+}
+
+bool RendererRecorder::SwapBuffers()
+{
+	Record(Trace::CMD_SWAP_BUFFERS);
+	const bool result = m_renderer->SwapBuffers();
+
+	// the wrapped renderer counts its draws, everything else counts objects
+	// with this one
+	const Stats::TFrameData &frame = m_renderer->GetStats().FrameStatsPrevious();
+	for (Uint32 i = 0; i < Stats::MAX_STAT; i++)
+		m_stats.AddToStatCount(Stats::StatType(i), frame.m_stats[i]);
+	m_stats.NextFrame();
+
+	if (m_capturing && --m_framesToCapture == 0)
+		FinishCapture();
+	return result;
+}
+
+bool RendererRecorder::SetRenderTarget(RenderTarget *rt)
+{
+	if (m_trace) {
+		const Uint32 id = Ref(rt);
+		Record(Trace::CMD_SET_RENDER_TARGET)->Put(id);
+	}
+	return m_renderer->SetRenderTarget(rt);
+}
+
+bool RendererRecorder::ClearScreen()
+{
+	Record(Trace::CMD_CLEAR_SCREEN);
+	return m_renderer->ClearScreen();
+}
+
+bool RendererRecorder::ClearDepthBuffer()
+{
+	Record(Trace::CMD_CLEAR_DEPTH_BUFFER);
+	return m_renderer->ClearDepthBuffer();
+}
+
+bool RendererRecorder::SetClearColor(const Color &c)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_CLEAR_COLOR))
+		w->Put(c);
+	return m_renderer->SetClearColor(c);
+}
+
+bool RendererRecorder::SetViewport(int x, int y, int width, int height)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_VIEWPORT)) {
+		const Sint32 vp[4] = { x, y, width, height };
+		w->PutBytes(vp, sizeof(vp));
+	}
+	return m_renderer->SetViewport(x, y, width, height);
+}
+
+bool RendererRecorder::SetTransform(const matrix4x4d &m)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_TRANSFORM_D))
+		w->Put(m);
+	return m_renderer->SetTransform(m);
+}
+
+bool RendererRecorder::SetTransform(const matrix4x4f &m)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_TRANSFORM))
+		w->Put(m);
+	return m_renderer->SetTransform(m);
+}
+
+bool RendererRecorder::SetPerspectiveProjection(float fov, float aspect, float near_, float far_)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_PERSPECTIVE)) {
+		const float args[] = { fov, aspect, near_, far_ };
+		w->PutBytes(args, sizeof(args));
+	}
+	return m_renderer->SetPerspectiveProjection(fov, aspect, near_, far_);
+}
+
+bool RendererRecorder::SetOrthographicProjection(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_ORTHOGRAPHIC)) {
+		const float args[] = { xmin, xmax, ymin, ymax, zmin, zmax };
+		w->PutBytes(args, sizeof(args));
+	}
+	return m_renderer->SetOrthographicProjection(xmin, xmax, ymin, ymax, zmin, zmax);
+}
+
+bool RendererRecorder::SetProjection(const matrix4x4f &m)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_PROJECTION))
+		w->Put(m);
+	return m_renderer->SetProjection(m);
+}
+
+bool RendererRecorder::SetRenderState(RenderState *rs)
+{
+	if (m_trace) {
+		const Uint32 id = Ref(rs);
+		Record(Trace::CMD_SET_RENDER_STATE)->Put(id);
+	}
+	return m_renderer->SetRenderState(rs);
+}
+
+bool RendererRecorder::SetDepthRange(double znear, double zfar)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_DEPTH_RANGE)) {
+		w->Put(znear);
+		w->Put(zfar);
+	}
+	return m_renderer->SetDepthRange(znear, zfar);
+}
+
+bool RendererRecorder::SetWireFrameMode(bool enabled)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_WIREFRAME))
+		w->Put<Uint8>(enabled);
+	return m_renderer->SetWireFrameMode(enabled);
+}
+
+bool RendererRecorder::SetLights(Uint32 numlights, const Light *l)
+{
+	m_numLights = std::min(numlights, TOTAL_NUM_LIGHTS);
+	for (Uint32 i = 0; i < m_numLights; i++)
+		m_lights[i] = l[i];
+	if (m_trace)
+		WriteLights();
+	return m_renderer->SetLights(numlights, l);
+}
+
+bool RendererRecorder::SetAmbientColor(const Color &c)
+{
+	m_ambient = c;
+	if (Trace::Writer *w = Record(Trace::CMD_SET_AMBIENT))
+		w->Put(c);
+	return m_renderer->SetAmbientColor(c);
+}
+
+bool RendererRecorder::SetScissor(bool enabled, const vector2f &pos, const vector2f &size)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_SCISSOR)) {
+		w->Put<Uint8>(enabled);
+		w->Put(pos);
+		w->Put(size);
+	}
+	return m_renderer->SetScissor(enabled, pos, size);
+}
+
+bool RendererRecorder::DrawTriangles(const VertexArray *v, RenderState *rs, Material *m, PrimitiveType type)
+{
+	if (m_trace) {
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_TRIANGLES);
+		w->Put<Uint32>(v->GetAttributeSet());
+		w->PutVector(v->position);
+		w->PutVector(v->normal);
+		w->PutVector(v->diffuse);
+		w->PutVector(v->uv0);
+		w->PutVector(v->tangent);
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put<Uint32>(type);
+	}
+	return m_renderer->DrawTriangles(v, rs, Recorder::Unwrap(m), type);
+}
+
+bool RendererRecorder::DrawPointSprites(const Uint32 count, const vector3f *positions, RenderState *rs, Material *m, float size)
+{
+	if (m_trace) {
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_POINT_SPRITES);
+		w->Put(count);
+		w->PutBytes(positions, count * sizeof(vector3f));
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put(size);
+	}
+	return m_renderer->DrawPointSprites(count, positions, rs, Recorder::Unwrap(m), size);
+}
+
+bool RendererRecorder::DrawPointSprites(const Uint32 count, const vector3f *positions, const vector2f *offsets, const float *sizes, RenderState *rs, Material *m)
+{
+	if (m_trace) {
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_POINT_SPRITES_SIZED);
+		w->Put(count);
+		w->PutBytes(positions, count * sizeof(vector3f));
+		w->PutBytes(offsets, count * sizeof(vector2f));
+		w->PutBytes(sizes, count * sizeof(float));
+		w->Put(rsId);
+		w->Put(mId);
+	}
+	return m_renderer->DrawPointSprites(count, positions, offsets, sizes, rs, Recorder::Unwrap(m));
+}
+
+bool RendererRecorder::DrawBuffer(VertexBuffer *vb, RenderState *rs, Material *m, PrimitiveType type)
+{
+	if (m_trace) {
+		const Uint32 vbId = Ref(vb);
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_BUFFER);
+		w->Put(vbId);
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put<Uint32>(type);
+	}
+	return m_renderer->DrawBuffer(Recorder::Unwrap(vb), rs, Recorder::Unwrap(m), type);
+}
+
+bool RendererRecorder::DrawBufferIndexed(VertexBuffer *vb, IndexBuffer *ib, RenderState *rs, Material *m, PrimitiveType type)
+{
+	if (m_trace) {
+		const Uint32 vbId = Ref(vb);
+		const Uint32 ibId = Ref(ib);
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_BUFFER_INDEXED);
+		w->Put(vbId);
+		w->Put(ibId);
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put<Uint32>(type);
+	}
+	return m_renderer->DrawBufferIndexed(Recorder::Unwrap(vb), Recorder::Unwrap(ib), rs, Recorder::Unwrap(m), type);
+}
+
+bool RendererRecorder::DrawBufferInstanced(VertexBuffer *vb, RenderState *rs, Material *m, InstanceBuffer *inst, PrimitiveType type)
+{
+	if (m_trace) {
+		const Uint32 vbId = Ref(vb);
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		const Uint32 instId = Ref(inst);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_BUFFER_INSTANCED);
+		w->Put(vbId);
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put(instId);
+		w->Put<Uint32>(type);
+	}
+	return m_renderer->DrawBufferInstanced(Recorder::Unwrap(vb), rs, Recorder::Unwrap(m), Recorder::Unwrap(inst), type);
+}
+
+bool RendererRecorder::DrawBufferIndexedInstanced(VertexBuffer *vb, IndexBuffer *ib, RenderState *rs, Material *m, InstanceBuffer *inst, PrimitiveType type)
+{
+	if (m_trace) {
+		const Uint32 vbId = Ref(vb);
+		const Uint32 ibId = Ref(ib);
+		const Uint32 rsId = Ref(rs);
+		const Uint32 mId = Ref(m);
+		const Uint32 instId = Ref(inst);
+		Trace::Writer *w = Record(Trace::CMD_DRAW_BUFFER_INDEXED_INSTANCED);
+		w->Put(vbId);
+		w->Put(ibId);
+		w->Put(rsId);
+		w->Put(mId);
+		w->Put(instId);
+		w->Put<Uint32>(type);
+	}
+	return m_renderer->DrawBufferIndexedInstanced(Recorder::Unwrap(vb), Recorder::Unwrap(ib), rs, Recorder::Unwrap(m), Recorder::Unwrap(inst), type);
+}
+
+// objects are defined in the trace when they're first used rather than
+// when they're created, so that every capture has all it needs
+
+Material *RendererRecorder::CreateMaterial(const MaterialDescriptor &descriptor)
+{
+	Graphics::Material *m = m_renderer->CreateMaterial(descriptor);
+	return m ? new Recorder::Material(NewId(), m) : nullptr;
+}
+
+Texture *RendererRecorder::CreateTexture(const TextureDescriptor &descriptor)
+{
+	Texture *t = m_renderer->CreateTexture(descriptor);
+	// a new texture may have the address of one that has gone, so it
+	// mustn't keep that one's id; Ref gives it its own when it's first used
+	if (t)
+		m_ids.erase(t);
+	return t;
+}
+
+RenderState *RendererRecorder::CreateRenderState(const RenderStateDesc &desc)
+{
+	// render states are kept by the renderer, so asking again for the same
+	// one answers the same object and the id it already has
+	return m_renderer->CreateRenderState(desc);
+}
+
+RenderTarget *RendererRecorder::CreateRenderTarget(const RenderTargetDesc &desc)
+{
+	RenderTarget *rt = m_renderer->CreateRenderTarget(desc);
+	if (rt)
+		m_ids.erase(rt);
+	return rt;
+}
+
+VertexBuffer *RendererRecorder::CreateVertexBuffer(const VertexBufferDesc &desc)
+{
+	Graphics::VertexBuffer *vb = m_renderer->CreateVertexBuffer(desc);
+	return vb ? new Recorder::VertexBuffer(this, NewId(), vb) : nullptr;
+}
+
+IndexBuffer *RendererRecorder::CreateIndexBuffer(Uint32 size, BufferUsage usage)
+{
+	Graphics::IndexBuffer *ib = m_renderer->CreateIndexBuffer(size, usage);
+	return ib ? new Recorder::IndexBuffer(this, NewId(), ib) : nullptr;
+}
+
+InstanceBuffer *RendererRecorder::CreateInstanceBuffer(Uint32 size, BufferUsage usage)
+{
+	Graphics::InstanceBuffer *ib = m_renderer->CreateInstanceBuffer(size, usage);
+	return ib ? new Recorder::InstanceBuffer(this, NewId(), ib) : nullptr;
+}
+
+void RendererRecorder::SetMatrixMode(MatrixMode mm)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SET_MATRIX_MODE))
+		w->Put<Uint32>(Uint32(mm));
+	m_renderer->SetMatrixMode(mm);
+}
+
+void RendererRecorder::PushMatrix()
+{
+	Record(Trace::CMD_PUSH_MATRIX);
+	m_renderer->PushMatrix();
+}
+
+void RendererRecorder::PopMatrix()
+{
+	Record(Trace::CMD_POP_MATRIX);
+	m_renderer->PopMatrix();
+}
+
+void RendererRecorder::LoadIdentity()
+{
+	Record(Trace::CMD_LOAD_IDENTITY);
+	m_renderer->LoadIdentity();
+}
+
+void RendererRecorder::LoadMatrix(const matrix4x4f &m)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_LOAD_MATRIX))
+		w->Put(m);
+	m_renderer->LoadMatrix(m);
+}
+
+void RendererRecorder::Translate(const float x, const float y, const float z)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_TRANSLATE))
+		w->Put(vector3f(x, y, z));
+	m_renderer->Translate(x, y, z);
+}
+
+void RendererRecorder::Scale(const float x, const float y, const float z)
+{
+	if (Trace::Writer *w = Record(Trace::CMD_SCALE))
+		w->Put(vector3f(x, y, z));
+	m_renderer->Scale(x, y, z);
+}
+
+// PushState is protected, but a ticket may call it
+void RendererRecorder::PushState()
+{
+	Record(Trace::CMD_PUSH_STATE);
+	m_stateTickets.push_back(new StateTicket(m_renderer.get()));
+}
+
+void RendererRecorder::PopState()
+{
+	Record(Trace::CMD_POP_STATE);
+	assert(!m_stateTickets.empty());
+	delete m_stateTickets.back();
+	m_stateTickets.pop_back();
+}
+
+}
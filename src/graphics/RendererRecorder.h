@@ -0,0 +1,172 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _GRAPHICS_RENDERERRECORDER_H
+#define _GRAPHICS_RENDERERRECORDER_H
+/*
+ * A renderer that passes every call on to another one, and can capture the
+ * calls made over a few frames into a trace (see RenderTrace.h) that can be
+ * replayed later against any renderer, including the dummy one.
+ *
+ * Buffers and materials are wrapped, so uploads and material parameters can
+ * be recorded; the wrappers are swapped for the real objects before calls
+ * reach the wrapped renderer. Each buffer keeps a copy of its contents, so
+ * that a capture can define buffers created before it started. Textures,
+ * render states and targets are handed out unwrapped since code outside
+ * the renderer casts them to backend types. Texture contents aren't
+ * captured, replays draw with blank textures of the same description.
+ *
+ * Turned on with the RecordRenderer config option, since it costs memory
+ * and time even when not capturing.
+ */
+#include "Renderer.h"
+#include "RenderTrace.h"
+#include <set>
+
+namespace Graphics {
+
+namespace Recorder {
+	class Material;
+	class VertexBuffer;
+	class IndexBuffer;
+	class InstanceBuffer;
+}
+
+class RendererRecorder : public Renderer
+{
+public:
+	// takes ownership of the renderer
+	RendererRecorder(Renderer *renderer);
+	virtual ~RendererRecorder();
+
+	// writes the calls made in the next numFrames frames to the named file
+	// in the user's traces directory
+	void Capture(const std::string &filename, Uint32 numFrames);
+	bool IsCapturing() const { return m_capturing || m_framesToCapture; }
+
+	virtual const char* GetName() const override final { return m_name.c_str(); }
+	virtual RendererType GetRendererType() const override final { return m_renderer->GetRendererType(); }
+	virtual void WriteRendererInfo(std::ostream &out) const override final { m_renderer->WriteRendererInfo(out); }
+	virtual void CheckRenderErrors(const char *func = nullptr, const int line = -1) const override final { m_renderer->CheckRenderErrors(func, line); }
+	virtual bool SupportsInstancing() override final { return m_renderer->SupportsInstancing(); }
+	virtual bool GetNearFarRange(float &near_, float &far_) const override final { return m_renderer->GetNearFarRange(near_, far_); }
+
+	virtual bool BeginFrame() override final;
+	virtual bool EndFrame() override final;
+	virtual bool SwapBuffers() override final;
+
+	virtual bool SetRenderTarget(RenderTarget*) override final;
+
+	virtual bool ClearScreen() override final;
+	virtual bool ClearDepthBuffer() override final;
+	virtual bool SetClearColor(const Color &c) override final;
+
+	virtual bool SetViewport(int x, int y, int width, int height) override final;
+
+	virtual bool SetTransform(const matrix4x4d &m) override final;
+	virtual bool SetTransform(const matrix4x4f &m) override final;
+	virtual bool SetPerspectiveProjection(float fov, float aspect, float near_, float far_) override final;
+	virtual bool SetOrthographicProjection(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax) override final;
+	virtual bool SetProjection(const matrix4x4f &m) override final;
+
+	virtual bool SetRenderState(RenderState*) override final;
+	virtual void InvalidateStateCache() override final { m_renderer->InvalidateStateCache(); }
+
+	virtual bool SetDepthRange(double znear, double zfar) override final;
+	virtual bool SetWireFrameMode(bool enabled) override final;
+
+	virtual bool SetLights(Uint32 numlights, const Light *l) override final;
+	virtual Uint32 GetNumLights() const override final { return m_renderer->GetNumLights(); }
+	virtual bool SetAmbientColor(const Color &c) override final;
+
+	virtual bool SetScissor(bool enabled, const vector2f &pos = vector2f(0.0f), const vector2f &size = vector2f(0.0f)) override final;
+
+	virtual bool DrawTriangles(const VertexArray *vertices, RenderState *state, Material *material, PrimitiveType type=TRIANGLES) override final;
+	virtual bool DrawPointSprites(const Uint32 count, const vector3f *positions, RenderState *rs, Material *material, float size) override final;
+	virtual bool DrawPointSprites(const Uint32 count, const vector3f *positions, const vector2f *offsets, const float *sizes, RenderState *rs, Material *material) override final;
+	virtual bool DrawBuffer(VertexBuffer*, RenderState*, Material*, PrimitiveType type=TRIANGLES) override final;
+	virtual bool DrawBufferIndexed(VertexBuffer*, IndexBuffer*, RenderState*, Material*, PrimitiveType=TRIANGLES) override final;
+	virtual bool DrawBufferInstanced(VertexBuffer*, RenderState*, Material*, InstanceBuffer*, PrimitiveType type=TRIANGLES) override final;
+	virtual bool DrawBufferIndexedInstanced(VertexBuffer*, IndexBuffer*, RenderState*, Material*, InstanceBuffer*, PrimitiveType=TRIANGLES) override final;
+
+	virtual Material *CreateMaterial(const MaterialDescriptor &descriptor) override final;
+	virtual Texture *CreateTexture(const TextureDescriptor &descriptor) override final;
+	virtual RenderState *CreateRenderState(const RenderStateDesc &) override final;
+	virtual RenderTarget *CreateRenderTarget(const RenderTargetDesc &) override final;
+	virtual VertexBuffer *CreateVertexBuffer(const VertexBufferDesc&) override final;
+	virtual IndexBuffer *CreateIndexBuffer(Uint32 size, BufferUsage) override final;
+	virtual InstanceBuffer *CreateInstanceBuffer(Uint32 size, BufferUsage) override final;
+
+	virtual bool ReloadShaders() override final { return m_renderer->ReloadShaders(); }
+
+	virtual const matrix4x4f& GetCurrentModelView() const override final { return m_renderer->GetCurrentModelView(); }
+	virtual const matrix4x4f& GetCurrentProjection() const override final { return m_renderer->GetCurrentProjection(); }
+	virtual void GetCurrentViewport(Sint32 *vp) const override final { m_renderer->GetCurrentViewport(vp); }
+
+	virtual void SetMatrixMode(MatrixMode mm) override final;
+	virtual void PushMatrix() override final;
+	virtual void PopMatrix() override final;
+	virtual void LoadIdentity() override final;
+	virtual void LoadMatrix(const matrix4x4f &m) override final;
+	virtual void Translate( const float x, const float y, const float z ) override final;
+	virtual void Scale( const float x, const float y, const float z ) override final;
+
+	virtual bool Screendump(ScreendumpState &sd) override final { return m_renderer->Screendump(sd); }
+	virtual bool FrameGrab(ScreendumpState &sd) override final { return m_renderer->FrameGrab(sd); }
+
+protected:
+	virtual void PushState() override final;
+	virtual void PopState() override final;
+
+private:
+	friend class Recorder::Material;
+	friend class Recorder::VertexBuffer;
+	friend class Recorder::IndexBuffer;
+	friend class Recorder::InstanceBuffer;
+
+	// the trace being written, or null when not capturing
+	Trace::Writer *Record(Trace::Command cmd);
+	void WriteSnapshot();
+	void FinishCapture();
+
+	// answer the trace ids of objects, defining them in the trace the first
+	// time they're used in a capture
+	Uint32 Ref(Material *m);
+	Uint32 Ref(Texture *t);
+	Uint32 Ref(RenderState *rs);
+	Uint32 Ref(RenderTarget *rt);
+	Uint32 Ref(VertexBuffer *vb);
+	Uint32 Ref(IndexBuffer *ib);
+	Uint32 Ref(InstanceBuffer *ib);
+	bool Define(Uint32 id);
+	Uint32 NewId() { return m_nextId++; }
+	void WriteLights();
+
+	// called by the buffer wrappers when their contents change
+	void Updated(Recorder::VertexBuffer *vb);
+	void Updated(Recorder::IndexBuffer *ib);
+	void Updated(Recorder::InstanceBuffer *ib);
+
+	std::unique_ptr<Renderer> m_renderer;
+	std::string m_name;
+
+	Uint32 m_nextId;
+	// unwrapped objects used in the current capture, by what they were
+	// handed out as
+	std::map<const void*, Uint32> m_ids;
+	// PushState tickets held on the wrapped renderer
+	std::vector<StateTicket*> m_stateTickets;
+	Uint32 m_numLights;
+
+	// capture
+	std::string m_filename;
+	Uint32 m_framesToCapture;
+	bool m_capturing;
+	std::unique_ptr<Trace::Writer> m_trace;
+	std::set<Uint32> m_defined;
+	std::map<Uint32, Trace::MaterialParams> m_materialParams;
+};
+
+}
+
+#endif
@@ -23,6 +23,19 @@ public:
 		// buffers
 		STAT_CREATE_BUFFER,
 		STAT_DESTROY_BUFFER,
+		STAT_STREAM_BUFFERS,	// transient geometry ring, buffers in use
+		STAT_STREAM_BYTES,		// vertex data written to it this frame
+		STAT_STREAM_OVERFLOWS,	// times it had to be orphaned mid-frame
+
+		// state changes made, and skipped as already set
+		STAT_PROGRAM_CHANGES,
+		STAT_PROGRAM_CHANGES_SKIPPED,
+		STAT_RENDERSTATE_CHANGES,
+		STAT_RENDERSTATE_CHANGES_SKIPPED,
+		STAT_TEXTURE_BINDS,
+		STAT_TEXTURE_BINDS_SKIPPED,
+		STAT_UNIFORMS_SET,
+		STAT_UNIFORMS_SKIPPED,
 
 		// objects
 		STAT_BUILDINGS,
@@ -599,7 +599,7 @@ void RendererGL2::SetMaterialShaderTransforms(Material *m)
 bool RendererGL2::DrawTriangles(const VertexArray *v, RenderState *rs, Material *m, PrimitiveType t)
 {
 	PROFILE_SCOPED()
-	if (!v || v->position.size() < 3) return false;
+	if (!v || v->IsEmpty()) return false;
 
 	const AttributeSet attribs = v->GetAttributeSet();
 	RefCountedPtr<VertexBuffer> drawVB;
@@ -56,6 +56,7 @@ void BillboardMaterial::Apply()
 
 void BillboardMaterial::Unapply()
 {
+	TextureGL::SetActiveUnit(0);
 	static_cast<TextureGL*>(texture0)->Unbind();
 }
 
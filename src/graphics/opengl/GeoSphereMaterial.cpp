@@ -92,7 +92,9 @@ void GeoSphereSurfaceMaterial::Apply()
 void GeoSphereSurfaceMaterial::Unapply()
 {
 	if(texture0) {
+		TextureGL::SetActiveUnit(1);
 		static_cast<TextureGL*>(texture1)->Unbind();
+		TextureGL::SetActiveUnit(0);
 		static_cast<TextureGL*>(texture0)->Unbind();
 	}
 }
@@ -225,7 +227,9 @@ void GeoSphereStarMaterial::Apply()
 void GeoSphereStarMaterial::Unapply()
 {
 	if (texture0) {
+		TextureGL::SetActiveUnit(1);
 		static_cast<TextureGL*>(texture1)->Unbind();
+		TextureGL::SetActiveUnit(0);
 		static_cast<TextureGL*>(texture0)->Unbind();
 	}
 }
@@ -23,6 +23,11 @@ bool Material::IsProgramLoaded() const
 	return m_program->Loaded();
 }
 
+Uint32 Material::GetShaderID() const
+{
+	return m_program ? m_program->GetProgram() : 0;
+}
+
 void Material::SetCommonUniforms(const matrix4x4f& mv, const matrix4x4f& proj)
 {
 	const matrix4x4f ViewProjection = proj * mv;
@@ -32,6 +32,7 @@ namespace Graphics {
 			virtual void Apply() override;
 			virtual void Unapply() override;
 			virtual bool IsProgramLoaded() const override final;
+			virtual Uint32 GetShaderID() const override final;
 			virtual void SetProgram(Program *p) { m_program = p; }
 			virtual void SetCommonUniforms(const matrix4x4f& mv, const matrix4x4f& proj) override;
 
@@ -139,34 +139,35 @@ void MultiMaterial::Unapply()
 {
 	// Might not be necessary to unbind textures, but let's not old graphics code (eg, old-UI)
 	if (heatGradient) {
+		TextureGL::SetActiveUnit(7);
 		static_cast<TextureGL*>(heatGradient)->Unbind();
-		glActiveTexture(GL_TEXTURE6);
 	}
 	if (texture6) {
+		TextureGL::SetActiveUnit(6);
 		static_cast<TextureGL*>(texture6)->Unbind();
-		glActiveTexture(GL_TEXTURE5);
 	}
 	if (texture5) {
+		TextureGL::SetActiveUnit(5);
 		static_cast<TextureGL*>(texture5)->Unbind();
-		glActiveTexture(GL_TEXTURE4);
 	}
 	if (texture4) {
+		TextureGL::SetActiveUnit(4);
 		static_cast<TextureGL*>(texture4)->Unbind();
-		glActiveTexture(GL_TEXTURE3);
 	}
 	if (texture3) {
+		TextureGL::SetActiveUnit(3);
 		static_cast<TextureGL*>(texture3)->Unbind();
-		glActiveTexture(GL_TEXTURE2);
 	}
 	if (texture2) {
+		TextureGL::SetActiveUnit(2);
 		static_cast<TextureGL*>(texture2)->Unbind();
-		glActiveTexture(GL_TEXTURE1);
 	}
 	if (texture1) {
+		TextureGL::SetActiveUnit(1);
 		static_cast<TextureGL*>(texture1)->Unbind();
-		glActiveTexture(GL_TEXTURE0);
 	}
 	if (texture0) {
+		TextureGL::SetActiveUnit(0);
 		static_cast<TextureGL*>(texture0)->Unbind();
 	}
 }
@@ -19,6 +19,8 @@ namespace OGL {
 // #version 330 for OpenGL3.3
 static const char *s_glslVersion = "#version 140\n";
 GLuint Program::s_curProgram = 0;
+Uint32 Program::s_issued = 0;
+Uint32 Program::s_skipped = 0;
 
 // Check and warn about compile & link errors
 static bool check_glsl_errors(const char *filename, GLuint obj)
@@ -215,6 +217,9 @@ Program::Program(const std::string &name, const std::string &defines)
 
 Program::~Program()
 {
+	// the name may be handed out again
+	if (s_curProgram == m_program)
+		s_curProgram = 0;
 	glDeleteProgram(m_program);
 }
 
@@ -228,8 +233,11 @@ void Program::Reload()
 
 void Program::Use()
 {
-	if (s_curProgram != m_program)
+	if (s_curProgram != m_program) {
 		glUseProgram(m_program);
+		++s_issued;
+	} else
+		++s_skipped;
 	s_curProgram = m_program;
 }
 
@@ -239,6 +247,13 @@ void Program::Unuse()
 	s_curProgram = 0;
 }
 
+void Program::GetCallCounts(Uint32 &issued, Uint32 &skipped)
+{
+	issued = s_issued;
+	skipped = s_skipped;
+	s_issued = s_skipped = 0;
+}
+
 //load, compile and link
 void Program::LoadShaders(const std::string &name, const std::string &defines)
 {
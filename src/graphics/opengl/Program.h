@@ -29,6 +29,11 @@ namespace Graphics {
 			virtual void Use();
 			virtual void Unuse();
 			bool Loaded() const { return success; }
+			GLuint GetProgram() const { return m_program; }
+
+			// answers how many program switches were made and skipped as
+			// redundant since the last time it was asked
+			static void GetCallCounts(Uint32 &issued, Uint32 &skipped);
 
 			// Uniforms.
 			Uniform uProjectionMatrix;
@@ -66,6 +71,8 @@ namespace Graphics {
 
 		protected:
 			static GLuint s_curProgram;
+			static Uint32 s_issued;
+			static Uint32 s_skipped;
 
 			void LoadShaders(const std::string&, const std::string &defines);
 			virtual void InitUniforms();
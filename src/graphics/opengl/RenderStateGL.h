@@ -11,7 +11,9 @@ namespace OGL {
 class RenderState : public Graphics::RenderState {
 public:
 	RenderState(const RenderStateDesc&);
-	void Apply();
+	// sets the GL state that differs from previous, which is what was
+	// applied last. nullptr if that isn't known, to set all of it
+	void Apply(const RenderState *previous);
 };
 
 }
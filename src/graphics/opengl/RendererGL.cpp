@@ -18,6 +18,7 @@
 #include "MaterialGL.h"
 #include "RenderStateGL.h"
 #include "RenderTargetGL.h"
+#include "StreamBuffer.h"
 #include "VertexBufferGL.h"
 #include "MultiMaterial.h"
 #include "Program.h"
@@ -139,7 +140,6 @@ void RendererOGL::RegisterRenderer() {
 
 // static member instantiations
 bool RendererOGL::initted = false;
-RendererOGL::AttribBufferMap RendererOGL::s_AttribBufferMap;
 
 // typedefs
 typedef std::vector<std::pair<MaterialDescriptor, OGL::Program*> >::const_iterator ProgramIterator;
@@ -235,6 +235,8 @@ RendererOGL::RendererOGL(SDL_Window *window, const Graphics::Settings &vs, SDL_G
 	if (vs.enableDebugMessages)
 		GLDebug::Enable();
 
+	m_streamBuffer.reset(new OGL::StreamBuffer());
+
 	// check enum PrimitiveType matches OpenGL values
 	assert(POINTS == GL_POINTS);
 	assert(LINE_SINGLE == GL_LINES);
@@ -252,6 +254,7 @@ RendererOGL::~RendererOGL()
 	for (auto state : m_renderStates)
 		delete state.second;
 
+	m_streamBuffer.reset();
 	SDL_GL_DeleteContext(m_glContext);
 }
 
@@ -475,6 +478,23 @@ bool RendererOGL::SwapBuffers()
 	CheckRenderErrors(__FUNCTION__,__LINE__);
 
 	SDL_GL_SwapWindow(m_window);
+
+	m_stats.AddToStatCount(Stats::STAT_STREAM_BUFFERS, m_streamBuffer->GetBufferCount());
+	m_stats.AddToStatCount(Stats::STAT_STREAM_BYTES, m_streamBuffer->GetBytesStreamed());
+	m_stats.AddToStatCount(Stats::STAT_STREAM_OVERFLOWS, m_streamBuffer->GetOrphanCount());
+	m_streamBuffer->NextFrame();
+
+	Uint32 issued, skipped;
+	OGL::Program::GetCallCounts(issued, skipped);
+	m_stats.AddToStatCount(Stats::STAT_PROGRAM_CHANGES, issued);
+	m_stats.AddToStatCount(Stats::STAT_PROGRAM_CHANGES_SKIPPED, skipped);
+	OGL::TextureGL::GetCallCounts(issued, skipped);
+	m_stats.AddToStatCount(Stats::STAT_TEXTURE_BINDS, issued);
+	m_stats.AddToStatCount(Stats::STAT_TEXTURE_BINDS_SKIPPED, skipped);
+	OGL::Uniform::GetCallCounts(issued, skipped);
+	m_stats.AddToStatCount(Stats::STAT_UNIFORMS_SET, issued);
+	m_stats.AddToStatCount(Stats::STAT_UNIFORMS_SKIPPED, skipped);
+
 	m_stats.NextFrame();
 	return true;
 }
@@ -482,13 +502,22 @@ bool RendererOGL::SwapBuffers()
 bool RendererOGL::SetRenderState(RenderState *rs)
 {
 	if (m_activeRenderState != rs) {
-		static_cast<OGL::RenderState*>(rs)->Apply();
+		static_cast<OGL::RenderState*>(rs)->Apply(static_cast<OGL::RenderState*>(m_activeRenderState));
 		m_activeRenderState = rs;
-	}
+		m_stats.AddToStatCount(Stats::STAT_RENDERSTATE_CHANGES, 1);
+	} else
+		m_stats.AddToStatCount(Stats::STAT_RENDERSTATE_CHANGES_SKIPPED, 1);
 	CheckRenderErrors(__FUNCTION__,__LINE__);
 	return true;
 }
 
+void RendererOGL::InvalidateStateCache()
+{
+	// the program is left alone, imgui puts back the one it found
+	m_activeRenderState = nullptr;
+	OGL::TextureGL::InvalidateBindings();
+}
+
 bool RendererOGL::SetRenderTarget(RenderTarget *rt)
 {
 	PROFILE_SCOPED()
@@ -661,62 +690,13 @@ void RendererOGL::SetMaterialShaderTransforms(Material *m)
 bool RendererOGL::DrawTriangles(const VertexArray *v, RenderState *rs, Material *m, PrimitiveType t)
 {
 	PROFILE_SCOPED()
-	if (!v || v->position.size() < 3) return false;
-
-	const AttributeSet attribs = v->GetAttributeSet();
-	RefCountedPtr<VertexBuffer> drawVB;
-
-	// see if we have a buffer to re-use
-	AttribBufferIter iter = s_AttribBufferMap.find(std::make_pair(attribs, v->position.size()));
-	if (iter == s_AttribBufferMap.end()) {
-		// not found a buffer so create a new one
-		VertexBufferDesc vbd;
-		Uint32 attribIdx = 0;
-		assert(v->HasAttrib(ATTRIB_POSITION));
-		vbd.attrib[attribIdx].semantic = ATTRIB_POSITION;
-		vbd.attrib[attribIdx].format = ATTRIB_FORMAT_FLOAT3;
-		++attribIdx;
-
-		if (v->HasAttrib(ATTRIB_NORMAL)) {
-			vbd.attrib[attribIdx].semantic = ATTRIB_NORMAL;
-			vbd.attrib[attribIdx].format = ATTRIB_FORMAT_FLOAT3;
-			++attribIdx;
-		}
-		if (v->HasAttrib(ATTRIB_DIFFUSE)) {
-			vbd.attrib[attribIdx].semantic = ATTRIB_DIFFUSE;
-			vbd.attrib[attribIdx].format = ATTRIB_FORMAT_UBYTE4;
-			++attribIdx;
-		}
-		if (v->HasAttrib(ATTRIB_UV0)) {
-			vbd.attrib[attribIdx].semantic = ATTRIB_UV0;
-			vbd.attrib[attribIdx].format = ATTRIB_FORMAT_FLOAT2;
-			++attribIdx;
-		}
-		if (v->HasAttrib(ATTRIB_TANGENT)) {
-			vbd.attrib[attribIdx].semantic = ATTRIB_TANGENT;
-			vbd.attrib[attribIdx].format = ATTRIB_FORMAT_FLOAT3;
-			++attribIdx;
-		}
-		vbd.numVertices = static_cast<Uint32>(v->position.size());
-		vbd.usage = BUFFER_USAGE_DYNAMIC;	// dynamic since we'll be reusing these buffers if possible
-
-		// VertexBuffer
-		RefCountedPtr<VertexBuffer> vb;
-		vb.Reset(CreateVertexBuffer(vbd));
-		vb->Populate(*v);
-
-		// add to map
-		s_AttribBufferMap[std::make_pair(attribs, v->position.size())] = vb;
-		drawVB = vb;
-	}
-	else {
-		// got a buffer so use it and fill it with newest data
-		drawVB = iter->second;
-		drawVB->Populate(*v);
-	}
+	if (!v || v->IsEmpty()) return false;
+	assert(v->HasAttrib(ATTRIB_POSITION));
 
-	const bool res = DrawBuffer(drawVB.Get(), rs, m, t);
-	CheckRenderErrors(__FUNCTION__,__LINE__);
+	// streamed rather than given a buffer of its own, as whatever's drawn
+	// this way is usually rebuilt next frame, often with a different count
+	const Uint32 firstVertex = m_streamBuffer->Write(*v);
+	const bool res = DrawStreamed(v->GetAttributeSet(), firstVertex, v->GetNumVerts(), rs, m, t);
 
 	m_stats.AddToStatCount(Stats::STAT_DRAWTRIS, 1);
 
@@ -726,7 +706,10 @@ bool RendererOGL::DrawTriangles(const VertexArray *v, RenderState *rs, Material
 bool RendererOGL::DrawPointSprites(const Uint32 count, const vector3f *positions, RenderState *rs, Material *material, float size)
 {
 	PROFILE_SCOPED()
-	if (count == 0 || !material || !material->texture0)
+	// nothing to draw isn't a failure
+	if (count == 0)
+		return true;
+	if (!material || !material->texture0)
 		return false;
 
 	size = Clamp(size, 0.1f, FLT_MAX);
@@ -738,46 +721,21 @@ bool RendererOGL::DrawPointSprites(const Uint32 count, const vector3f *positions
 	};
 	#pragma pack(pop)
 
-	RefCountedPtr<VertexBuffer> drawVB;
-	AttribBufferIter iter = s_AttribBufferMap.find(std::make_pair(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL, count));
-	if (iter == s_AttribBufferMap.end())
-	{
-		// NB - we're (ab)using the normal type to hold (uv coordinate offset value + point size)
-		Graphics::VertexBufferDesc vbd;
-		vbd.attrib[0].semantic = Graphics::ATTRIB_POSITION;
-		vbd.attrib[0].format   = Graphics::ATTRIB_FORMAT_FLOAT3;
-		vbd.attrib[1].semantic = Graphics::ATTRIB_NORMAL;
-		vbd.attrib[1].format   = Graphics::ATTRIB_FORMAT_FLOAT3;
-		vbd.numVertices = count;
-		vbd.usage = Graphics::BUFFER_USAGE_DYNAMIC;	// we could be updating this per-frame
-
-		// VertexBuffer
-		RefCountedPtr<VertexBuffer> vb;
-		vb.Reset(CreateVertexBuffer(vbd));
-
-		// add to map
-		s_AttribBufferMap[std::make_pair(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL, count)] = vb;
-		drawVB = vb;
-	}
-	else
-	{
-		drawVB = iter->second;
-	}
-
-	// got a buffer so use it and fill it with newest data
-	PosNormVert* vtxPtr = drawVB->Map<PosNormVert>(Graphics::BUFFER_MAP_WRITE);
-	assert(drawVB->GetDesc().stride == sizeof(PosNormVert));
+	// NB - we're (ab)using the normal type to hold (uv coordinate offset value + point size)
+	const AttributeSet attribs = ATTRIB_POSITION | ATTRIB_NORMAL;
+	assert(m_streamBuffer->GetLayout(attribs).stride == sizeof(PosNormVert));
+	Uint32 firstVertex;
+	PosNormVert* vtxPtr = reinterpret_cast<PosNormVert*>(m_streamBuffer->Map(attribs, count, firstVertex));
 	for(Uint32 i=0 ; i<count ; i++)
 	{
 		vtxPtr[i].pos	= positions[i];
 		vtxPtr[i].norm	= vector3f(0.0f, 0.0f, size);
 	}
-	drawVB->Unmap();
+	m_streamBuffer->Unmap();
 
 	SetTransform(matrix4x4f::Identity());
-	DrawBuffer(drawVB.Get(), rs, material, Graphics::POINTS);
+	DrawStreamed(attribs, firstVertex, count, rs, material, Graphics::POINTS);
 	GetStats().AddToStatCount(Graphics::Stats::STAT_DRAWPOINTSPRITES, 1);
-	CheckRenderErrors(__FUNCTION__,__LINE__);
 
 	return true;
 }
@@ -785,7 +743,10 @@ bool RendererOGL::DrawPointSprites(const Uint32 count, const vector3f *positions
 bool RendererOGL::DrawPointSprites(const Uint32 count, const vector3f *positions, const vector2f *offsets, const float *sizes, RenderState *rs, Material *material)
 {
 	PROFILE_SCOPED()
-	if (count == 0 || !material || !material->texture0)
+	// nothing to draw isn't a failure
+	if (count == 0)
+		return true;
+	if (!material || !material->texture0)
 		return false;
 
 	#pragma pack(push, 4)
@@ -795,47 +756,40 @@ bool RendererOGL::DrawPointSprites(const Uint32 count, const vector3f *positions
 	};
 	#pragma pack(pop)
 
-	RefCountedPtr<VertexBuffer> drawVB;
-	AttribBufferIter iter = s_AttribBufferMap.find(std::make_pair(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL, count));
-	if (iter == s_AttribBufferMap.end())
-	{
-		// NB - we're (ab)using the normal type to hold (uv coordinate offset value + point size)
-		Graphics::VertexBufferDesc vbd;
-		vbd.attrib[0].semantic = Graphics::ATTRIB_POSITION;
-		vbd.attrib[0].format   = Graphics::ATTRIB_FORMAT_FLOAT3;
-		vbd.attrib[1].semantic = Graphics::ATTRIB_NORMAL;
-		vbd.attrib[1].format   = Graphics::ATTRIB_FORMAT_FLOAT3;
-		vbd.numVertices = count;
-		vbd.usage = Graphics::BUFFER_USAGE_DYNAMIC;	// we could be updating this per-frame
-
-		// VertexBuffer
-		RefCountedPtr<VertexBuffer> vb;
-		vb.Reset(CreateVertexBuffer(vbd));
-
-		// add to map
-		s_AttribBufferMap[std::make_pair(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL, count)] = vb;
-		drawVB = vb;
-	}
-	else
-	{
-		drawVB = iter->second;
-	}
-
-	// got a buffer so use it and fill it with newest data
-	PosNormVert* vtxPtr = drawVB->Map<PosNormVert>(Graphics::BUFFER_MAP_WRITE);
-	assert(drawVB->GetDesc().stride == sizeof(PosNormVert));
+	// NB - we're (ab)using the normal type to hold (uv coordinate offset value + point size)
+	const AttributeSet attribs = ATTRIB_POSITION | ATTRIB_NORMAL;
+	assert(m_streamBuffer->GetLayout(attribs).stride == sizeof(PosNormVert));
+	Uint32 firstVertex;
+	PosNormVert* vtxPtr = reinterpret_cast<PosNormVert*>(m_streamBuffer->Map(attribs, count, firstVertex));
 	for(Uint32 i=0 ; i<count ; i++)
 	{
 		vtxPtr[i].pos	= positions[i];
 		vtxPtr[i].norm	= vector3f(offsets[i], Clamp(sizes[i], 0.1f, FLT_MAX));
 	}
-	drawVB->Unmap();
+	m_streamBuffer->Unmap();
 
 	SetTransform(matrix4x4f::Identity());
-	DrawBuffer(drawVB.Get(), rs, material, Graphics::POINTS);
+	DrawStreamed(attribs, firstVertex, count, rs, material, Graphics::POINTS);
 	GetStats().AddToStatCount(Graphics::Stats::STAT_DRAWPOINTSPRITES, 1);
+
+	return true;
+}
+
+bool RendererOGL::DrawStreamed(AttributeSet attribs, Uint32 firstVertex, Uint32 numVertices, RenderState *state, Material *mat, PrimitiveType pt)
+{
+	PROFILE_SCOPED()
+	SetRenderState(state);
+	mat->Apply();
+
+	SetMaterialShaderTransforms(mat);
+
+	m_streamBuffer->Bind(attribs);
+	glDrawArrays(pt, firstVertex, numVertices);
+	m_streamBuffer->Release();
 	CheckRenderErrors(__FUNCTION__,__LINE__);
 
+	m_stats.AddToStatCount(Stats::STAT_DRAWCALL, 1);
+
 	return true;
 }
 
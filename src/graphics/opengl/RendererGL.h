@@ -38,6 +38,7 @@ namespace OGL {
 	class RingMaterial;
 	class FresnelColourMaterial;
 	class ShieldMaterial;
+	class StreamBuffer;
 	class UIMaterial;
 	class BillboardMaterial;
 }
@@ -67,6 +68,7 @@ public:
 	virtual bool SwapBuffers() override final;
 
 	virtual bool SetRenderState(RenderState*) override final;
+	virtual void InvalidateStateCache() override final;
 	virtual bool SetRenderTarget(RenderTarget*) override final;
 
 	virtual bool SetDepthRange(double znear, double zfar) override final;
@@ -141,6 +143,9 @@ protected:
 
 	void SetMaterialShaderTransforms(Material *);
 
+	// draws numVertices from the stream buffer, starting at firstVertex
+	bool DrawStreamed(AttributeSet, Uint32 firstVertex, Uint32 numVertices, RenderState*, Material*, PrimitiveType);
+
 	matrix4x4f& GetCurrentTransform() { return m_currentTransform; }
 	matrix4x4f m_currentTransform;
 
@@ -176,9 +181,8 @@ protected:
 private:
 	static bool initted;
 
-	typedef std::map<std::pair<AttributeSet, size_t>, RefCountedPtr<VertexBuffer>> AttribBufferMap;
-	typedef AttribBufferMap::iterator AttribBufferIter;
-	static AttribBufferMap s_AttribBufferMap;
+	// transient geometry from DrawTriangles and DrawPointSprites
+	std::unique_ptr<OGL::StreamBuffer> m_streamBuffer;
 
 	SDL_GLContext m_glContext;
 };
@@ -38,6 +38,7 @@ void RingMaterial::Apply()
 
 void RingMaterial::Unapply()
 {
+	TextureGL::SetActiveUnit(0);
 	static_cast<TextureGL*>(texture0)->Unbind();
 }
 
@@ -30,6 +30,7 @@ namespace Graphics {
 			}
 
 			virtual void Unapply() override {
+				TextureGL::SetActiveUnit(0);
 				static_cast<TextureGL*>(texture0)->Unbind();
 				glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
 			}
@@ -0,0 +1,201 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "graphics/opengl/StreamBuffer.h"
+#include "graphics/opengl/VertexBufferGL.h"
+#include "graphics/VertexArray.h"
+#include "utils.h"
+
+namespace Graphics { namespace OGL {
+
+// a frame in flight should be long finished by the time its buffer comes
+// round again, so this is only hit when the driver is badly behind
+static const GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+// copies one attribute of every vertex into the interleaved buffer
+template <typename T>
+static void CopyAttrib(Uint8 *dst, const Uint32 stride, const std::vector<T> &src)
+{
+	for (const T &value : src) {
+		memcpy(dst, &value, sizeof(T));
+		dst += stride;
+	}
+}
+
+StreamBuffer::StreamBuffer() :
+	m_current(0),
+	m_offset(0),
+	m_bytesStreamed(0),
+	m_orphans(0),
+	m_useFences(glewIsSupported("GL_ARB_sync"))
+{
+	PROFILE_SCOPED()
+	for (Frame &frame : m_frames) {
+		frame.fence = 0;
+		frame.size = INITIAL_SIZE;
+		glGenBuffers(1, &frame.buffer);
+		Orphan(frame);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (auto &layout : m_layouts)
+		glDeleteVertexArrays(FRAMES_IN_FLIGHT, layout.second.vao);
+	for (Frame &frame : m_frames) {
+		if (frame.fence)
+			glDeleteSync(frame.fence);
+		glDeleteBuffers(1, &frame.buffer);
+	}
+}
+
+const VertexBufferDesc &StreamBuffer::GetLayout(AttributeSet attribs)
+{
+	auto iter = m_layouts.find(attribs);
+	if (iter != m_layouts.end())
+		return iter->second.desc;
+
+	static const std::pair<VertexAttrib, VertexAttribFormat> order[] = {
+		{ ATTRIB_POSITION, ATTRIB_FORMAT_FLOAT3 },
+		{ ATTRIB_NORMAL, ATTRIB_FORMAT_FLOAT3 },
+		{ ATTRIB_DIFFUSE, ATTRIB_FORMAT_UBYTE4 },
+		{ ATTRIB_UV0, ATTRIB_FORMAT_FLOAT2 },
+		{ ATTRIB_TANGENT, ATTRIB_FORMAT_FLOAT3 },
+	};
+
+	Layout &layout = m_layouts[attribs];
+	VertexBufferDesc &desc = layout.desc;
+	Uint32 attribIdx = 0;
+	for (const auto &attrib : order) {
+		if (!(attribs & attrib.first))
+			continue;
+		desc.attrib[attribIdx].semantic = attrib.first;
+		desc.attrib[attribIdx].format = attrib.second;
+		desc.attrib[attribIdx].offset = desc.stride;
+		desc.stride += VertexBufferDesc::GetAttribSize(attrib.second);
+		++attribIdx;
+	}
+	desc.usage = BUFFER_USAGE_DYNAMIC;
+	assert(desc.stride > 0);
+
+	// the attribute pointers are relative to the start of the buffer, so
+	// each frame's buffer gets its own VAO and draws pass a first vertex
+	glGenVertexArrays(FRAMES_IN_FLIGHT, layout.vao);
+	for (Uint32 i = 0; i < FRAMES_IN_FLIGHT; i++) {
+		glBindVertexArray(layout.vao[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, m_frames[i].buffer);
+		SetupVertexAttribs(desc);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return desc;
+}
+
+Uint8 *StreamBuffer::Map(AttributeSet attribs, Uint32 numVertices, Uint32 &firstVertex)
+{
+	PROFILE_SCOPED()
+	assert(numVertices > 0);
+	const Uint32 stride = GetLayout(attribs).stride;
+	const Uint32 bytes = numVertices * stride;
+	Frame &frame = m_frames[m_current];
+
+	glBindBuffer(GL_ARRAY_BUFFER, frame.buffer);
+
+	// start on a whole vertex, so the draw can address it by index
+	firstVertex = (m_offset + stride - 1) / stride;
+	if (firstVertex * stride + bytes > frame.size) {
+		// out of room this frame. orphaning hands the draws already issued
+		// the old storage, and this one starts again at the top of the new
+		while (frame.size < bytes)
+			frame.size *= 2;
+		Orphan(frame);
+		++m_orphans;
+		firstVertex = 0;
+	}
+
+	const Uint32 offset = firstVertex * stride;
+	m_offset = offset + bytes;
+	m_bytesStreamed += bytes;
+
+	return reinterpret_cast<Uint8*>(glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+}
+
+void StreamBuffer::Unmap()
+{
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Uint32 StreamBuffer::Write(const VertexArray &va)
+{
+	PROFILE_SCOPED()
+	const AttributeSet attribs = va.GetAttributeSet();
+	const VertexBufferDesc &desc = GetLayout(attribs);
+
+	Uint32 firstVertex;
+	Uint8 *data = Map(attribs, va.GetNumVerts(), firstVertex);
+	for (Uint32 i = 0; i < MAX_ATTRIBS && desc.attrib[i].semantic != ATTRIB_NONE; i++) {
+		const VertexAttribDesc &attrib = desc.attrib[i];
+		Uint8 *dst = data + attrib.offset;
+		switch (attrib.semantic) {
+		case ATTRIB_POSITION:	CopyAttrib(dst, desc.stride, va.position);	break;
+		case ATTRIB_NORMAL:		CopyAttrib(dst, desc.stride, va.normal);	break;
+		case ATTRIB_DIFFUSE:	CopyAttrib(dst, desc.stride, va.diffuse);	break;
+		case ATTRIB_UV0:		CopyAttrib(dst, desc.stride, va.uv0);		break;
+		case ATTRIB_TANGENT:	CopyAttrib(dst, desc.stride, va.tangent);	break;
+		default:
+			break;
+		}
+	}
+	Unmap();
+
+	return firstVertex;
+}
+
+void StreamBuffer::Bind(AttributeSet attribs)
+{
+	GetLayout(attribs);
+	// the attributes were enabled when the VAO was set up and are never
+	// disabled, so binding it is all there is to do
+	glBindVertexArray(m_layouts.find(attribs)->second.vao[m_current]);
+}
+
+void StreamBuffer::Release()
+{
+	glBindVertexArray(0);
+}
+
+void StreamBuffer::NextFrame()
+{
+	PROFILE_SCOPED()
+	if (m_useFences)
+		m_frames[m_current].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_current = (m_current + 1) % FRAMES_IN_FLIGHT;
+	Frame &frame = m_frames[m_current];
+	if (frame.fence) {
+		const GLenum result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+		glDeleteSync(frame.fence);
+		frame.fence = 0;
+		if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+			Orphan(frame);
+	} else if (!m_useFences) {
+		Orphan(frame);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_offset = 0;
+	m_bytesStreamed = 0;
+	m_orphans = 0;
+}
+
+void StreamBuffer::Orphan(Frame &frame)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, frame.buffer);
+	glBufferData(GL_ARRAY_BUFFER, frame.size, nullptr, GL_STREAM_DRAW);
+}
+
+} }
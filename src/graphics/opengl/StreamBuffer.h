@@ -0,0 +1,85 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef OGL_STREAMBUFFER_H
+#define OGL_STREAMBUFFER_H
+/*
+ * Transient geometry that is rebuilt every time it's drawn (DrawTriangles,
+ * DrawPointSprites, changing Drawables) is written into a ring of large
+ * vertex buffers, one per frame in flight, instead of getting a buffer of
+ * its own per vertex count.
+ * Draws sub-allocate from the current frame's buffer and write their range
+ * unsynchronised; a fence at the end of each frame makes sure the GPU has
+ * finished with a buffer before it comes round again. Where ARB_sync is
+ * missing the buffer is orphaned instead. If a frame outgrows its buffer
+ * the buffer is orphaned and grown, so nothing already drawn is overwritten.
+ */
+#include "OpenGLLibs.h"
+#include "graphics/VertexBuffer.h"
+#include <map>
+
+namespace Graphics {
+
+class VertexArray;
+
+namespace OGL {
+
+class StreamBuffer {
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// copies the contents of the VertexArray into the current frame's
+	// buffer, and answers the index of its first vertex there
+	Uint32 Write(const VertexArray &);
+
+	// reserves numVertices in the layout used for attribs (see GetLayout),
+	// answering where to write them and the index of the first one. Unmap
+	// before drawing
+	Uint8 *Map(AttributeSet attribs, Uint32 numVertices, Uint32 &firstVertex);
+	void Unmap();
+
+	// binds the vertex layout for attribs over the current frame's buffer
+	void Bind(AttributeSet attribs);
+	void Release();
+
+	// fences the frame just submitted and moves on to the next buffer
+	void NextFrame();
+
+	// the vertex layout streamed for an attribute set: attributes in
+	// position, normal, diffuse, uv0, tangent order, tightly packed
+	const VertexBufferDesc &GetLayout(AttributeSet attribs);
+
+	Uint32 GetBufferCount() const { return FRAMES_IN_FLIGHT; }
+	Uint32 GetBytesStreamed() const { return m_bytesStreamed; }
+	Uint32 GetOrphanCount() const { return m_orphans; }
+
+private:
+	static const Uint32 FRAMES_IN_FLIGHT = 3;
+	static const Uint32 INITIAL_SIZE = 2 * 1024 * 1024;
+
+	struct Frame {
+		GLuint buffer;
+		GLsync fence;
+		Uint32 size;
+	};
+
+	struct Layout {
+		VertexBufferDesc desc;
+		GLuint vao[FRAMES_IN_FLIGHT];
+	};
+
+	void Orphan(Frame &frame);
+
+	Frame m_frames[FRAMES_IN_FLIGHT];
+	Uint32 m_current;
+	Uint32 m_offset;
+	Uint32 m_bytesStreamed;
+	Uint32 m_orphans;
+	bool m_useFences;
+	std::map<AttributeSet, Layout> m_layouts;
+};
+
+} }
+
+#endif // OGL_STREAMBUFFER_H
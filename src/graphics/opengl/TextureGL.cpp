@@ -5,6 +5,7 @@
 #include "RendererGL.h"
 #include "TextureGL.h"
 #include <cassert>
+#include <algorithm>
 #include "utils.h"
 
 static const unsigned int MIN_COMPRESSED_TEXTURE_DIMENSION = 16;
@@ -12,6 +13,11 @@ static const unsigned int MIN_COMPRESSED_TEXTURE_DIMENSION = 16;
 namespace Graphics {
 namespace OGL {
 
+GLuint TextureGL::s_bound[TextureGL::MAX_TRACKED_UNITS] = {};
+unsigned int TextureGL::s_activeUnit = 0;
+Uint32 TextureGL::s_issued = 0;
+Uint32 TextureGL::s_skipped = 0;
+
 inline GLint GLInternalFormat(TextureFormat format) {
 	switch (format) {
 		case TEXTURE_RGB_888: return GL_RGB;
@@ -83,7 +89,7 @@ TextureGL::TextureGL(const TextureDescriptor &descriptor, const bool useCompress
 	m_target = GLTextureType(descriptor.type);
 
 	glGenTextures(1, &m_texture);
-	glBindTexture(m_target, m_texture);
+	Bind();
 	CHECKERRORS();
 
 	// useCompressed is the global scope flag whereas descriptor.allowCompression is the local texture mode flag
@@ -240,6 +246,10 @@ TextureGL::TextureGL(const TextureDescriptor &descriptor, const bool useCompress
 
 TextureGL::~TextureGL()
 {
+	// GL unbinds a deleted texture, and may hand its name out again
+	for (GLuint &bound : s_bound)
+		if (bound == m_texture)
+			bound = 0;
 	glDeleteTextures(1, &m_texture);
 }
 
@@ -247,8 +257,8 @@ void TextureGL::Update(const void *data, const vector2f &pos, const vector2f &da
 {
 	PROFILE_SCOPED()
 	assert(m_target == GL_TEXTURE_2D);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(m_target, m_texture);
+	SetActiveUnit(0);
+	Bind();
 
 	switch (m_target) {
 		case GL_TEXTURE_2D:
@@ -282,7 +292,7 @@ void TextureGL::Update(const void *data, const vector2f &pos, const vector2f &da
 	if (GetDescriptor().generateMipmaps && !IsCompressed(format))
 		glGenerateMipmap(m_target);
 
-	glBindTexture(m_target, 0);
+	Unbind();
 	CHECKERRORS();
 }
 
@@ -290,8 +300,8 @@ void TextureGL::Update(const TextureCubeData &data, const vector2f &dataSize, Te
 {
 	PROFILE_SCOPED()
 	assert(m_target == GL_TEXTURE_CUBE_MAP);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(m_target, m_texture);
+	SetActiveUnit(0);
+	Bind();
 
 	switch (m_target) {
 		case GL_TEXTURE_CUBE_MAP:
@@ -340,18 +350,56 @@ void TextureGL::Update(const TextureCubeData &data, const vector2f &dataSize, Te
 	if (GetDescriptor().generateMipmaps && !IsCompressed(format))
 		glGenerateMipmap(m_target);
 
-	glBindTexture(m_target, 0);
+	Unbind();
 	CHECKERRORS();
 }
 
 void TextureGL::Bind()
 {
 	glBindTexture(m_target, m_texture);
+	if (s_activeUnit < MAX_TRACKED_UNITS)
+		s_bound[s_activeUnit] = m_texture;
 }
 
 void TextureGL::Unbind()
 {
 	glBindTexture(m_target, 0);
+	if (s_activeUnit < MAX_TRACKED_UNITS)
+		s_bound[s_activeUnit] = 0;
+}
+
+void TextureGL::BindToUnit(unsigned int unit)
+{
+	if (unit < MAX_TRACKED_UNITS && s_bound[unit] == m_texture) {
+		++s_skipped;
+		return;
+	}
+	SetActiveUnit(unit);
+	Bind();
+	++s_issued;
+}
+
+void TextureGL::SetActiveUnit(unsigned int unit)
+{
+	if (unit != s_activeUnit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		s_activeUnit = unit;
+	}
+}
+
+void TextureGL::InvalidateBindings()
+{
+	// whatever was done behind our back, make the next binds happen
+	std::fill(s_bound, s_bound + MAX_TRACKED_UNITS, GLuint(~0u));
+	glActiveTexture(GL_TEXTURE0);
+	s_activeUnit = 0;
+}
+
+void TextureGL::GetCallCounts(Uint32 &issued, Uint32 &skipped)
+{
+	issued = s_issued;
+	skipped = s_skipped;
+	s_issued = s_skipped = 0;
 }
 
 void TextureGL::SetSampleMode(TextureSampleMode mode)
@@ -381,7 +429,7 @@ void TextureGL::SetSampleMode(TextureSampleMode mode)
 			minFilter = mipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
 			break;
 	}
-	glBindTexture(m_target, m_texture);
+	Bind();
 	glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, magFilter);
 	glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, minFilter);
 
@@ -392,7 +440,7 @@ void TextureGL::SetSampleMode(TextureSampleMode mode)
 		glTexParameterf(m_target, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
 	}
 
-	glBindTexture(m_target, 0);
+	Unbind();
 	CHECKERRORS();
 }
 
@@ -402,9 +450,9 @@ void TextureGL::BuildMipmaps()
 	const bool mipmaps = descriptor.generateMipmaps;
 	if (mipmaps)
 	{
-		glBindTexture(m_target, m_texture);
+		Bind();
 		glGenerateMipmap(m_target);
-		glBindTexture(m_target, 0);
+		Unbind();
 	}
 }
 
@@ -19,9 +19,24 @@ namespace Graphics
 			TextureGL(const TextureDescriptor &descriptor, const bool useCompressed, const bool useAnisoFiltering);
 			virtual ~TextureGL();
 
+			// bind to the active texture unit
 			virtual void Bind() override final;
 			virtual void Unbind() override final;
 
+			// bind to a texture unit for drawing, skipped if it's already
+			// bound there, which leaves the active unit as it was. Everything
+			// in this renderer that touches texture bindings goes through
+			// TextureGL so that the record is right, and selects the unit
+			// itself before an Unbind
+			void BindToUnit(unsigned int unit);
+			static void SetActiveUnit(unsigned int unit);
+			// forget the recorded bindings, after code outside the renderer
+			// has bound textures of its own
+			static void InvalidateBindings();
+			// answers how many binds were made and skipped as redundant
+			// since the last time it was asked
+			static void GetCallCounts(Uint32 &issued, Uint32 &skipped);
+
 			virtual void SetSampleMode(TextureSampleMode) override final;
 			virtual void BuildMipmaps() override final;
 			virtual uint32_t GetTextureID() const override final { assert(sizeof(uint32_t)==sizeof(GLuint)); return m_texture; }
@@ -30,6 +45,14 @@ namespace Graphics
 			GLenum m_target;
 			GLuint m_texture;
 			const bool m_useAnisoFiltering;
+
+			// texture last bound to each unit, by name (names are unique
+			// across targets)
+			static const unsigned int MAX_TRACKED_UNITS = 16;
+			static GLuint s_bound[MAX_TRACKED_UNITS];
+			static unsigned int s_activeUnit;
+			static Uint32 s_issued;
+			static Uint32 s_skipped;
 		};
 	}
 }
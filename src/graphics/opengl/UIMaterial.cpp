@@ -42,10 +42,11 @@ namespace Graphics {
 		{
 			// Might not be necessary to unbind textures, but let's not old graphics code (eg, old-UI)
 			if ( texture1 ) {
+				TextureGL::SetActiveUnit(1);
 				static_cast<TextureGL*>(texture1)->Unbind();
-				glActiveTexture(GL_TEXTURE0);
 			}
 			if ( texture0 ) {
+				TextureGL::SetActiveUnit(0);
 				static_cast<TextureGL*>(texture0)->Unbind();
 			}
 		}
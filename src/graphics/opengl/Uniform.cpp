@@ -3,87 +3,117 @@
 
 #include "Uniform.h"
 #include "TextureGL.h"
+#include <cstring>
 
 namespace Graphics {
 namespace OGL {
 
+Uint32 Uniform::s_issued = 0;
+Uint32 Uniform::s_skipped = 0;
+
 Uniform::Uniform()
 : m_location(-1)
+, m_valueSize(0)
 {
 }
 
 void Uniform::Init(const char *name, GLuint program)
 {
 	m_location = glGetUniformLocation(program, name);
+	m_valueSize = 0;
+}
+
+bool Uniform::Changed(const void *value, Uint32 size)
+{
+	assert(size <= sizeof(m_value));
+	if (m_valueSize == size && memcmp(m_value, value, size) == 0) {
+		++s_skipped;
+		return false;
+	}
+	memcpy(m_value, value, size);
+	m_valueSize = size;
+	++s_issued;
+	return true;
+}
+
+void Uniform::GetCallCounts(Uint32 &issued, Uint32 &skipped)
+{
+	issued = s_issued;
+	skipped = s_skipped;
+	s_issued = s_skipped = 0;
 }
 
 void Uniform::Set(int i)
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&i, sizeof(i)))
 		glUniform1i(m_location, i);
 }
 
 void Uniform::Set(float f)
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&f, sizeof(f)))
 		glUniform1f(m_location, f);
 }
 
 void Uniform::Set(const vector3f &v)
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&v[0], sizeof(float) * 3))
 		glUniform3f(m_location, v.x, v.y, v.z);
 }
 
 void Uniform::Set(const vector3d &v)
 {
-	if (m_location != -1)
-		glUniform3f(m_location, static_cast<float>(v.x), static_cast<float>(v.y), static_cast<float>(v.z)); //yes, 3f
+	const vector3f vf(v);
+	if (m_location != -1 && Changed(&vf[0], sizeof(float) * 3))
+		glUniform3f(m_location, vf.x, vf.y, vf.z); //yes, 3f
 }
 
 void Uniform::Set(const Color &c)
 {
-	Color4f c4f = c.ToColor4f();
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&c, sizeof(c))) {
+		Color4f c4f = c.ToColor4f();
 		glUniform4f(m_location, c4f.r, c4f.g, c4f.b, c4f.a);
+	}
 }
 
 void Uniform::Set(const int v[3])
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(v, sizeof(int) * 3))
 		glUniform3i(m_location, v[0],v[1],v[2]);
 }
 
 void Uniform::Set(const float x, const float y, const float z, const float w)
 {
-	if (m_location != -1)
+	const float v[4] = { x, y, z, w };
+	if (m_location != -1 && Changed(v, sizeof(v)))
 		glUniform4f(m_location, x, y, z, w);
 }
 
 void Uniform::Set(const float m[9])
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(m, sizeof(float) * 9))
 		glUniformMatrix3fv(m_location, 1, GL_FALSE, m);
 }
 
 void Uniform::Set(const matrix3x3f &m)
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&m[0], sizeof(float) * 9))
 		glUniformMatrix3fv(m_location, 1, GL_FALSE, &m[0]);
 }
 
 void Uniform::Set(const matrix4x4f &m)
 {
-	if (m_location != -1)
+	if (m_location != -1 && Changed(&m[0], sizeof(float) * 16))
 		glUniformMatrix4fv(m_location, 1, GL_FALSE, &m[0]);
 }
 
 void Uniform::Set(Texture *tex, unsigned int unit)
 {
 	if (m_location != -1 && tex) {
-		glActiveTexture(GL_TEXTURE0 + unit);
-		static_cast<TextureGL*>(tex)->Bind();
-		glUniform1i(m_location, unit);
+		static_cast<TextureGL*>(tex)->BindToUnit(unit);
+		const int sampler = unit;
+		if (Changed(&sampler, sizeof(sampler)))
+			glUniform1i(m_location, sampler);
 	}
 }
 
@@ -35,8 +35,22 @@ namespace Graphics {
 			void Set(Texture *t, unsigned int unit);
 			bool IsValid() const { return (m_location != -1); }
 
+			// answers how many glUniform calls were made and skipped as
+			// redundant since the last time it was asked
+			static void GetCallCounts(Uint32 &issued, Uint32 &skipped);
+
 		private:
+			// the uniform belongs to one program, and GL keeps its value
+			// between uses of that program, so setting the value it had
+			// last time can be skipped. answers false if that's the case
+			bool Changed(const void *value, Uint32 size);
+
 			GLint m_location;
+			Uint32 m_valueSize; // 0 until set
+			Uint8 m_value[sizeof(matrix4x4f)];
+
+			static Uint32 s_issued;
+			static Uint32 s_skipped;
 		};
 	}
 }
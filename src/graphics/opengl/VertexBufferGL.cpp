@@ -36,6 +36,43 @@ GLenum get_component_type(VertexAttribFormat fmt)
 	}
 }
 
+void SetupVertexAttribs(const VertexBufferDesc &desc)
+{
+	for (Uint8 i = 0; i < MAX_ATTRIBS; i++) {
+		const auto& attr  = desc.attrib[i];
+		if (attr.semantic == ATTRIB_NONE)
+			break;
+
+		// Tell OpenGL what the array contains
+		const auto offset = reinterpret_cast<const GLvoid*>(attr.offset);
+		switch (attr.semantic) {
+		case ATTRIB_POSITION:
+			glEnableVertexAttribArray(0);	// Enable the attribute at that location
+			glVertexAttribPointer(0, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, desc.stride, offset);
+			break;
+		case ATTRIB_NORMAL:
+			glEnableVertexAttribArray(1);	// Enable the attribute at that location
+			glVertexAttribPointer(1, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, desc.stride, offset);
+			break;
+		case ATTRIB_DIFFUSE:
+			glEnableVertexAttribArray(2);	// Enable the attribute at that location
+			glVertexAttribPointer(2, get_num_components(attr.format), get_component_type(attr.format), GL_TRUE, desc.stride, offset);	// only normalise the colours
+			break;
+		case ATTRIB_UV0:
+			glEnableVertexAttribArray(3);	// Enable the attribute at that location
+			glVertexAttribPointer(3, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, desc.stride, offset);
+			break;
+		case ATTRIB_TANGENT:
+			glEnableVertexAttribArray(4);	// Enable the attribute at that location
+			glVertexAttribPointer(4, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, desc.stride, offset);
+			break;
+		case ATTRIB_NONE:
+		default:
+			break;
+		}
+	}
+}
+
 VertexBuffer::VertexBuffer(const VertexBufferDesc &desc) :
 	Graphics::VertexBuffer(desc)
 {
@@ -76,39 +113,7 @@ VertexBuffer::VertexBuffer(const VertexBufferDesc &desc) :
 	glBufferData(GL_ARRAY_BUFFER, dataSize, 0, usage);
 
 	//Setup the VAO pointers
-	for (Uint8 i = 0; i < MAX_ATTRIBS; i++) {
-		const auto& attr  = m_desc.attrib[i];
-		if (attr.semantic == ATTRIB_NONE)
-			break;
-
-		// Tell OpenGL what the array contains
-		const auto offset = reinterpret_cast<const GLvoid*>(attr.offset);
-		switch (attr.semantic) {
-		case ATTRIB_POSITION:
-			glEnableVertexAttribArray(0);	// Enable the attribute at that location
-			glVertexAttribPointer(0, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, m_desc.stride, offset);
-			break;
-		case ATTRIB_NORMAL:
-			glEnableVertexAttribArray(1);	// Enable the attribute at that location
-			glVertexAttribPointer(1, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, m_desc.stride, offset);
-			break;
-		case ATTRIB_DIFFUSE:
-			glEnableVertexAttribArray(2);	// Enable the attribute at that location
-			glVertexAttribPointer(2, get_num_components(attr.format), get_component_type(attr.format), GL_TRUE, m_desc.stride, offset);	// only normalise the colours
-			break;
-		case ATTRIB_UV0:
-			glEnableVertexAttribArray(3);	// Enable the attribute at that location
-			glVertexAttribPointer(3, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, m_desc.stride, offset);
-			break;
-		case ATTRIB_TANGENT:
-			glEnableVertexAttribArray(4);	// Enable the attribute at that location
-			glVertexAttribPointer(4, get_num_components(attr.format), get_component_type(attr.format), GL_FALSE, m_desc.stride, offset);
-			break;
-		case ATTRIB_NONE:
-		default:
-			break;
-		}
-	}
+	SetupVertexAttribs(m_desc);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
@@ -8,6 +8,10 @@
 
 namespace Graphics { namespace OGL {
 
+// points and enables the attributes of the bound VAO at the bound
+// GL_ARRAY_BUFFER, laid out as desc (offsets and stride already filled in)
+void SetupVertexAttribs(const VertexBufferDesc &desc);
+
 class GLBufferBase {
 public:
 	GLBufferBase() : m_written(false) {}
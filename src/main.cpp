@@ -4,9 +4,11 @@
 #include "libs.h"
 #include "Pi.h"
 #include "ModelViewer.h"
+#include "Benchmark.h"
 #include "Game.h"
 #include "galaxy/GalaxyGenerator.h"
 #include "galaxy/Galaxy.h"
+#include "FileSourcePack.h"
 #include "utils.h"
 #include <cstdio>
 #include <cstdlib>
@@ -16,6 +18,9 @@ enum RunMode {
 	MODE_MODELVIEWER,
 	MODE_GALAXYDUMP,
 	MODE_SKIPMENU,
+	MODE_BENCH,
+	MODE_REPLAY,
+	MODE_PACK,
 	MODE_VERSION,
 	MODE_USAGE,
 	MODE_USAGE_ERROR
@@ -61,6 +66,21 @@ int main(int argc, char** argv)
 			goto start;
 		}
 
+		if (modeopt == "bench" || modeopt == "b") {
+			mode = MODE_BENCH;
+			goto start;
+		}
+
+		if (modeopt == "replay" || modeopt == "rp") {
+			mode = MODE_REPLAY;
+			goto start;
+		}
+
+		if (modeopt == "pack" || modeopt == "pk") {
+			mode = MODE_PACK;
+			goto start;
+		}
+
 		if (modeopt == "version" || modeopt == "v") {
 			mode = MODE_VERSION;
 			goto start;
@@ -81,6 +101,10 @@ start:
 	long int sx = 0, sy = 0, sz = 0;
 	std::string filename;
 	int startPlanet = 0; // zero is off
+	std::string benchScenario("station");
+	long int benchTicks = 1000;
+	long int benchCount = 0; // zero is the scenario's default
+	std::string traceName;
 
 	switch (mode) {
 		case MODE_GALAXYDUMP: {
@@ -120,6 +144,48 @@ start:
 			}
 			// fallthrough
 		}
+		case MODE_BENCH: {
+			// fallthrough protect
+			if (mode == MODE_BENCH)
+			{
+				if (argc > pos && !strchr(argv[pos], '=')) { // scenario or savefile (optional)
+					benchScenario = argv[pos];
+					++pos;
+				}
+				if (argc > pos && !strchr(argv[pos], '=')) { // ticks (optional)
+					char* end = nullptr;
+					benchTicks = std::strtol(argv[pos], &end, 0);
+					if (end == nullptr || *end != 0 || benchTicks <= 0) {
+						Output("pioneer: invalid tick count: %s\n", argv[pos]);
+						break;
+					}
+					++pos;
+				}
+				if (argc > pos && !strchr(argv[pos], '=')) { // count (optional)
+					char* end = nullptr;
+					benchCount = std::strtol(argv[pos], &end, 0);
+					if (end == nullptr || *end != 0 || benchCount < 0) {
+						Output("pioneer: invalid count: %s\n", argv[pos]);
+						break;
+					}
+					++pos;
+				}
+			}
+			// fallthrough
+		}
+		case MODE_REPLAY: {
+			// fallthrough protect
+			if (mode == MODE_REPLAY)
+			{
+				if (argc <= pos || strchr(argv[pos], '=')) {
+					Output("pioneer: replay requires a trace name\n");
+					break;
+				}
+				traceName = argv[pos];
+				++pos;
+			}
+			// fallthrough
+		}
 		case MODE_SKIPMENU: {
 			// fallthrough protect
 			if (mode == MODE_SKIPMENU)
@@ -171,7 +237,13 @@ start:
 				}
 			}
 
-			Pi::Init(options, mode == MODE_GALAXYDUMP);
+			if (mode == MODE_BENCH || mode == MODE_REPLAY) {
+				// headless unless told otherwise; insert() keeps any option given above
+				options.insert(std::make_pair("RendererName", "Dummy"));
+				options.insert(std::make_pair("DisableSound", "1"));
+			}
+
+			Pi::Init(options, mode == MODE_GALAXYDUMP || mode == MODE_BENCH || mode == MODE_REPLAY);
 
 			if (mode == MODE_GAME)
 				for (;;) {
@@ -191,6 +263,14 @@ start:
 				}
 				Pi::Quit();
 			}
+			else if (mode == MODE_BENCH) {
+				Benchmark::Run(benchScenario, benchTicks, benchCount);
+				Pi::Quit();
+			}
+			else if (mode == MODE_REPLAY) {
+				Benchmark::Replay(traceName);
+				Pi::Quit();
+			}
 			break;
 		}
 
@@ -202,6 +282,24 @@ start:
 			break;
 		}
 
+		case MODE_PACK: {
+			// always the data directory itself, never an existing pack of it
+			FileSystem::FileSourceFS data(FileSystem::GetDataDir());
+			const std::string packName = argc > 2 ? std::string(argv[2]) : FileSystem::GetDataPackPath();
+			FILE *file = fopen(packName.c_str(), "wb");
+			if (file == nullptr) {
+				Output("pioneer: could not open \"%s\" for writing: %s\n", packName.c_str(), strerror(errno));
+				return 1;
+			}
+			const bool ok = FileSystem::FileSourcePack::Write(data, file);
+			if (fclose(file) != 0 || !ok) {
+				Output("pioneer: writing to \"%s\" failed\n", packName.c_str());
+				remove(packName.c_str());
+				return 1;
+			}
+			break;
+		}
+
 		case MODE_VERSION: {
 			std::string version(PIONEER_VERSION);
 			if (strlen(PIONEER_EXTRAVERSION)) version += " (" PIONEER_EXTRAVERSION ")";
@@ -222,6 +320,9 @@ start:
 				"    -galaxydump  [-gd]    galaxy dumper\n"
 				"    -skipmenu    [-sm]    skip main menu\n"
 				"    -skipmenu=N  [-sm=N]  skip main menu and load planet 'N' where N: number\n"
+				"    -bench       [-b]     headless benchmark: -bench [scenario|savefile] [ticks] [count]\n"
+				"    -replay      [-rp]    replay a renderer trace: -replay trace [RendererName=Opengl]\n"
+				"    -pack        [-pk]    pack the data directory into one file: -pack [file]\n"
 				"    -version     [-v]     show version\n"
 				"    -help        [-h,-?]  this help\n"
 			);
@@ -7,6 +7,7 @@
 #include <cstdlib>
 
 #include "scenegraph/SceneGraph.h"
+#include "collider/BVHTree.h"
 
 #include "FileSystem.h"
 #include "GameConfig.h"
@@ -22,9 +23,14 @@
 #include "scenegraph/DumpVisitor.h"
 #include "scenegraph/FindNodeVisitor.h"
 #include "scenegraph/BinaryConverter.h"
+#include "scenegraph/Parser.h"
 #include "OS.h"
 #include "StringF.h"
+#include "StringRange.h"
 #include "ModManager.h"
+#include "json/json.h"
+#include <algorithm>
+#include <set>
 #include <sstream>
 
 std::unique_ptr<GameConfig> s_config;
@@ -34,7 +40,7 @@ std::unique_ptr<AsyncJobQueue> asyncJobQueue;
 static const std::string s_dummyPath("");
 
 // fwd decl'
-void RunCompiler(const std::string &modelName, const std::string &filepath, const bool bInPlace);
+bool RunCompiler(const std::string &modelName, const std::string &filepath, const bool bInPlace, const SceneGraph::ModelIndex *index = nullptr);
 
 // ********************************************************************************
 // Overloaded PureJob class to handle compiling each model
@@ -98,9 +104,10 @@ void SetupRenderer()
 		numThreads = std::max(Uint32(numCores), 1U); // this is a tool, we can use all of the cores for processing unlike Pioneer
 	asyncJobQueue.reset(new AsyncJobQueue(numThreads));
 	Output("started %d worker threads\n", numThreads);
+	BVHTree::SetBuildThreads(numThreads);
 }
 
-void RunCompiler(const std::string &modelName, const std::string &filepath, const bool bInPlace)
+bool RunCompiler(const std::string &modelName, const std::string &filepath, const bool bInPlace, const SceneGraph::ModelIndex *index)
 {
 	PROFILE_SCOPED()
 	Profiler::Timer timer;
@@ -111,7 +118,7 @@ void RunCompiler(const std::string &modelName, const std::string &filepath, cons
 	//and then save it into binary
 	std::unique_ptr<SceneGraph::Model> model;
 	try {
-		SceneGraph::Loader ld(s_renderer.get(), true, false);
+		SceneGraph::Loader ld(s_renderer.get(), true, false, index);
 		model.reset(ld.LoadModel(modelName));
 		//dump warnings
 		for (std::vector<std::string>::const_iterator it = ld.GetLogMessages().begin();
@@ -121,19 +128,164 @@ void RunCompiler(const std::string &modelName, const std::string &filepath, cons
 		}
 	} catch (...) {
 		//minimal error handling, this is not expected to happen since we got this far.
-		return;
+		return false;
 	}
 
+	bool saved = true;
 	try {
 		const std::string DataPath = FileSystem::NormalisePath(filepath.substr(0, filepath.size()-6));
-		SceneGraph::BinaryConverter bc(s_renderer.get());
+		SceneGraph::BinaryConverter bc(s_renderer.get(), index);
 		bc.Save(modelName, DataPath, model.get(), bInPlace);
 	} catch (const CouldNotOpenFileException&) {
+		saved = false;
 	} catch (const CouldNotWriteToFileException&) {
+		saved = false;
 	}
 
 	timer.Stop();
 	Output("Compiling \"%s\" took: %lf\n", modelName.c_str(), timer.millicycles());
+	return saved;
+}
+
+// ********************************************************************************
+// incremental builds
+// ********************************************************************************
+// hashes of every model's inputs as of its last successful compile, kept in
+// the user directory. the output goes to different places with and without
+// inplace, so each has its own
+static std::string ManifestName(const bool bInPlace)
+{
+	return bInPlace ? "modelcompiler-inplace.json" : "modelcompiler.json";
+}
+
+// hash of everything the .sgm would be built from: the .model, everything
+// beside it (patterns are found by looking there), the meshes, collision
+// meshes and textures it names, and the .sgm version. thread safe
+static std::string HashModelInputs(const std::string &modelPath)
+{
+	PROFILE_SCOPED()
+	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
+	const std::string curPath = modelPath.substr(0, modelPath.find_last_of('/'));
+
+	std::set<std::string> inputs;
+	inputs.insert(modelPath);
+	for (FileSystem::FileEnumerator files(fileSource, curPath); !files.Finished(); files.Next()) {
+		const FileSystem::FileInfo &info = files.Current();
+		if (info.IsFile() && !ends_with_ci(info.GetPath(), ".sgm"))
+			inputs.insert(info.GetPath());
+	}
+	try {
+		SceneGraph::ModelDefinition def;
+		SceneGraph::Parser p(fileSource, modelPath, curPath);
+		p.Parse(&def);
+		for (const SceneGraph::LodDefinition &lod : def.lodDefs)
+			inputs.insert(lod.meshNames.begin(), lod.meshNames.end());
+		inputs.insert(def.collisionDefs.begin(), def.collisionDefs.end());
+		for (const SceneGraph::MaterialDefinition &mat : def.matDefs) {
+			for (const std::string *tex : { &mat.tex_diff, &mat.tex_spec, &mat.tex_glow, &mat.tex_ambi, &mat.tex_norm })
+				if (!tex->empty()) inputs.insert(*tex);
+		}
+	} catch (const std::exception &) {
+		// it won't compile either, which the compile will report. the .model
+		// is hashed all the same, so fixing it makes it build again
+	}
+
+	const Uint32 version = SceneGraph::BinaryConverter::GetVersion();
+	Uint64 hash = hash_fnv1a_64(&version, sizeof(version));
+	for (const std::string &path : inputs) {	// sorted, so the order doesn't depend on the enumeration
+		hash = hash_fnv1a_64(path.c_str(), path.size() + 1, hash);
+		RefCountedPtr<FileSystem::FileData> data = fileSource.ReadFile(path);
+		if (data)
+			hash = hash_fnv1a_64(data->GetData(), data->GetSize(), hash);
+	}
+
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+	return buf;
+}
+
+// compiles only the models whose inputs have changed since they were last
+// compiled (or whose .sgm has gone), then reports how long each one took.
+// the inputs are hashed on all the worker threads; the compiles themselves
+// stay on this one, as the loader and the renderer aren't thread safe
+static void RunIncremental(const bool bInPlace)
+{
+	PROFILE_SCOPED()
+	Uint64 mark = SDL_GetPerformanceCounter();
+
+	// one walk of the data for finding every model, shared by every compile
+	const SceneGraph::ModelIndex index;
+	std::vector<std::pair<std::string, std::string>> models(index.GetModels().begin(), index.GetModels().end());
+	const double indexMs = LapMs(mark);
+
+	std::vector<std::string> hashes(models.size());
+	JobBatch::Run(asyncJobQueue.get(), models.size(), 4, [&](Uint32 begin, Uint32 end) {
+		for (Uint32 i = begin; i < end; i++)
+			hashes[i] = HashModelInputs(models[i].second);
+	});
+	const double hashMs = LapMs(mark);
+
+	Json::Value manifest(Json::objectValue);
+	if (RefCountedPtr<FileSystem::FileData> data = FileSystem::userFiles.ReadFile(ManifestName(bInPlace))) {
+		const StringRange text = data->AsStringRange();
+		Json::Reader reader;
+		if (!reader.parse(text.begin, text.end, manifest) || !manifest.isObject()) {
+			Output("modelcompiler: %s is unreadable, compiling everything\n", ManifestName(bInPlace).c_str());
+			manifest = Json::Value(Json::objectValue);
+		}
+	}
+
+	struct Timing {
+		std::string name;
+		double ms;
+		const char *result;
+	};
+	std::vector<Timing> timings;
+	timings.reserve(models.size());
+	Uint32 built = 0, failed = 0;
+	for (size_t i = 0; i < models.size(); i++) {
+		const std::string &name = models[i].first;
+		const std::string &path = models[i].second;
+		const std::string DataPath = FileSystem::NormalisePath(path.substr(0, path.size()-6));
+		const Json::Value last = manifest.get(name, Json::Value());
+		if (last.isString() && last.asString() == hashes[i] && SceneGraph::BinaryConverter::IsSaved(DataPath, bInPlace)) {
+			timings.push_back({ name, 0.0, "skipped" });
+			continue;
+		}
+
+		LapMs(mark);
+		const bool ok = RunCompiler(name, path, bInPlace, &index);
+		timings.push_back({ name, LapMs(mark), ok ? "built" : "FAILED" });
+		if (ok) {
+			manifest[name] = hashes[i];
+			built++;
+		} else {
+			manifest.removeMember(name);
+			failed++;
+		}
+	}
+
+	// models that have gone since the last run
+	for (const std::string &name : manifest.getMemberNames())
+		if (!index.FindModel(name))
+			manifest.removeMember(name);
+
+	Json::StyledWriter writer;
+	const std::string text = writer.write(manifest);
+	FILE *f = FileSystem::userFiles.OpenWriteStream(ManifestName(bInPlace));
+	if (!f || fwrite(text.data(), 1, text.size(), f) != text.size())
+		Output("modelcompiler: couldn't write %s\n", ManifestName(bInPlace).c_str());
+	if (f) fclose(f);
+
+	std::stable_sort(timings.begin(), timings.end(), [](const Timing &a, const Timing &b) { return a.ms > b.ms; });
+	double compileMs = 0.0;
+	Output("\n---\n%-32s %10s  %s\n", "model", "ms", "result");
+	for (const Timing &t : timings) {
+		Output("%-32s %10.1f  %s\n", t.name.c_str(), t.ms, t.result);
+		compileMs += t.ms;
+	}
+	Output("---\n%u models: %u built, %u failed, %u up to date\n", Uint32(models.size()), built, failed, Uint32(models.size()) - built - failed);
+	Output("index %.1fms, hashing %.1fms, compiling %.1fms\n", indexMs, hashMs, compileMs);
 }
 
 
@@ -143,6 +295,7 @@ void RunCompiler(const std::string &modelName, const std::string &filepath, cons
 enum RunMode {
 	MODE_MODELCOMPILER=0,
 	MODE_MODELBATCHEXPORT,
+	MODE_MODELINCREMENTAL,
 	MODE_VERSION,
 	MODE_USAGE,
 	MODE_USAGE_ERROR
@@ -175,6 +328,11 @@ int main(int argc, char** argv)
 			goto start;
 		}
 
+		if (modeopt == "incremental" || modeopt == "i") {
+			mode = MODE_MODELINCREMENTAL;
+			goto start;
+		}
+
 		if (modeopt == "version" || modeopt == "v") {
 			mode = MODE_VERSION;
 			goto start;
@@ -244,26 +402,14 @@ start:
 				isInPlace = (arg2 == "inplace" || arg2 == "true");
 			}
 
-			// find all of the models
-			std::vector<std::pair<std::string, std::string>> list_model;
-			FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-			for (FileSystem::FileEnumerator files(fileSource, "models", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
-			{
-				const FileSystem::FileInfo &info = files.Current();
-				const std::string &fpath = info.GetPath();
-
-				//check it's the expected type
-				if (info.IsFile()) {
-					if (ends_with_ci(fpath, ".model")) {	// store the path for ".model" files
-						list_model.push_back( std::make_pair(info.GetName().substr(0, info.GetName().size()-6), fpath) );
-					}
-				}
-			}
+			// find all of the models, once for every compile
+			const SceneGraph::ModelIndex index;
+			const std::map<std::string, std::string> &list_model = index.GetModels();
 
 			SetupRenderer();
 #if 1
 			for (auto &modelName : list_model) {
-				RunCompiler(modelName.first, modelName.second, isInPlace);
+				RunCompiler(modelName.first, modelName.second, isInPlace, &index);
 			}
 #else
 			std::deque<Job::Handle> handles;
@@ -284,6 +430,19 @@ start:
 			break;
 		}
 
+		case MODE_MODELINCREMENTAL: {
+			// determine if we're meant to be writing these in the source directory
+			bool isInPlace = false;
+			if (argc > 2) {
+				std::string arg2 = argv[2];
+				isInPlace = (arg2 == "inplace" || arg2 == "true");
+			}
+
+			SetupRenderer();
+			RunIncremental(isInPlace);
+			break;
+		}
+
 		case MODE_VERSION: {
 			std::string version(PIONEER_VERSION);
 			if (strlen(PIONEER_EXTRAVERSION)) version += " (" PIONEER_EXTRAVERSION ")";
@@ -303,6 +462,8 @@ start:
 				"    -compile inplace  [-c ... inplace]  model compiler\n"
 				"    -batch            [-b]              batch mode output into users home/Pioneer directory\n"
 				"    -batch inplace    [-b inplace]      batch mode output into the source folder\n"
+				"    -incremental      [-i]              batch mode, only models changed since the last run\n"
+				"    -incremental inplace [-i inplace]   incremental batch mode output into the source folder\n"
 				"    -version          [-v]              show version\n"
 				"    -help             [-h,-?]           this help\n"
 			);
@@ -9,6 +9,8 @@
 #include <cerrno>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <dirent.h>
 #include <unistd.h>
 
@@ -120,6 +122,38 @@ namespace FileSystem {
 		return ty;
 	}
 
+	// files at least this big are mapped rather than read in. only the pages
+	// that are looked at get loaded, and the kernel can drop them again rather
+	// than having to swap them out. the models, textures and music that are
+	// this big are mostly parsed once or streamed
+	static const off_t MAP_FILE_SIZE = 1024 * 1024;
+
+	class FileDataMapped : public FileData {
+	public:
+		FileDataMapped(const FileInfo &info, size_t size, void *map):
+			FileData(info, size, static_cast<char*>(map)) {
+			Advise(ACCESS_SEQUENTIAL);
+		}
+		virtual ~FileDataMapped() { munmap(m_data, m_size); }
+
+		virtual void Advise(Access access) const override {
+			madvise(m_data, m_size, access == ACCESS_RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+		}
+	};
+
+	// answers 0 if the file can't be mapped, so that it can be read instead
+	static FileData *map_file(const char *fullpath, const FileInfo &info, size_t size) {
+		const int fd = open(fullpath, O_RDONLY);
+		if (fd < 0)
+			return 0;
+		// the mapping holds its own reference to the file
+		void *map = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (map == MAP_FAILED)
+			return 0;
+		return new FileDataMapped(info, size, map);
+	}
+
 	static FileInfo::FileType stat_path(const char *fullpath, Time::DateTime &mtime) {
 		struct stat info;
 		if (stat(fullpath, &info) == 0) {
@@ -151,7 +185,16 @@ namespace FileSystem {
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
 		Time::DateTime mtime;
 
-		FileInfo::FileType ty = stat_path(fullpath.c_str(), mtime);
+		struct stat info;
+		if (stat(fullpath.c_str(), &info) != 0)
+			return RefCountedPtr<FileData>(0);
+		FileInfo::FileType ty = interpret_stat(info, mtime);
+
+		if (ty == FileInfo::FT_FILE && info.st_size >= MAP_FILE_SIZE) {
+			FileData *mapped = map_file(fullpath.c_str(), MakeFileInfo(path, ty, mtime), size_t(info.st_size));
+			if (mapped)
+				return RefCountedPtr<FileData>(mapped);
+		}
 
 		if (ty == FileInfo::FT_FILE) {
 
@@ -13,6 +13,7 @@
 #include <unistd.h>
 #endif
 #include <sys/utsname.h>
+#include <sys/resource.h>
 
 namespace OS {
 
@@ -96,6 +97,18 @@ int GetNumCores()
 #endif
 }
 
+size_t GetPeakResidentBytes()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return size_t(usage.ru_maxrss);
+#else
+	return size_t(usage.ru_maxrss) * 1024; // in kilobytes
+#endif
+}
+
 const std::string GetOSInfoString()
 {
 	int z;
@@ -13,6 +13,7 @@ typedef ChannelList::iterator ChannelIterator;
 Animation::Animation(const std::string &name, double duration)
 : m_duration(duration)
 , m_time(0.0)
+, m_dirty(true)
 , m_name(name)
 {
 }
@@ -20,6 +21,7 @@ Animation::Animation(const std::string &name, double duration)
 Animation::Animation(const Animation &anim)
 : m_duration(anim.m_duration)
 , m_time(0.0)
+, m_dirty(true)
 , m_name(anim.m_name)
 {
 	for(ChannelList::const_iterator chan = anim.m_channels.begin(); chan != anim.m_channels.end(); ++chan) {
@@ -37,23 +39,32 @@ void Animation::UpdateChannelTargets(Node *root)
 	}
 }
 
+//find the last key at or before time. the search starts from the key found
+//last time, since animations mostly move on by a little at a time
+template <typename Key>
+static unsigned int FindKey(const std::vector<Key> &keys, double time, unsigned int &cursor)
+{
+	unsigned int frame = std::min<unsigned int>(cursor, keys.size() - 1);
+	while (frame > 0 && time < keys[frame].time)
+		frame--;
+	while (frame + 1 < keys.size() && !(time < keys[frame+1].time))
+		frame++;
+	cursor = frame;
+	return frame;
+}
+
 void Animation::Interpolate()
 {
 	PROFILE_SCOPED()
 	const double mtime = m_time;
+	m_dirty = false;
 
 	//go through channels and calculate transforms
 	for(ChannelIterator chan = m_channels.begin(); chan != m_channels.end(); ++chan) {
 		matrix4x4f trans = chan->node->GetTransform();
 
 		if (!chan->rotationKeys.empty()) {
-			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
-			unsigned int frame = 0;
-			while (frame + 1 < chan->rotationKeys.size()) {
-				if (mtime < chan->rotationKeys[frame+1].time)
-					break;
-				frame++;
-			}
+			const unsigned int frame = FindKey(chan->rotationKeys, mtime, chan->rotationCursor);
 
 			const RotationKey &a = chan->rotationKeys[frame];
 			vector3f saved_position = trans.GetTranslate();
@@ -73,13 +84,7 @@ void Animation::Interpolate()
 		//continously scale the transform (would have to add originalTransform or
 		//something to MT)
 		if (!chan->scaleKeys.empty() && !chan->rotationKeys.empty()) {
-			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
-			unsigned int frame = 0;
-			while (frame + 1 < chan->scaleKeys.size()) {
-				if (mtime < chan->scaleKeys[frame+1].time)
-					break;
-				frame++;
-			}
+			const unsigned int frame = FindKey(chan->scaleKeys, mtime, chan->scaleCursor);
 
 			const ScaleKey &a = chan->scaleKeys[frame];
 			vector3f out;
@@ -96,13 +101,7 @@ void Animation::Interpolate()
 		}
 
 		if (!chan->positionKeys.empty()) {
-			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
-			unsigned int frame = 0;
-			while (frame + 1 < chan->positionKeys.size()) {
-				if (mtime < chan->positionKeys[frame+1].time)
-					break;
-				frame++;
-			}
+			const unsigned int frame = FindKey(chan->positionKeys, mtime, chan->positionCursor);
 
 			const PositionKey &a = chan->positionKeys[frame];
 			vector3f out;
@@ -129,7 +128,11 @@ double Animation::GetProgress()
 
 void Animation::SetProgress(double prog)
 {
-	m_time = Clamp(prog, 0.0, 1.0) * m_duration;
+	const double time = Clamp(prog, 0.0, 1.0) * m_duration;
+	if (time != m_time) {
+		m_time = time;
+		m_dirty = true;
+	}
 }
 
 }
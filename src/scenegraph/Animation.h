@@ -26,6 +26,8 @@ public:
 	double GetProgress();
 	void SetProgress(double); //0.0 -- 1.0, overrides m_time
 	void Interpolate(); //update transforms according to m_time;
+	//true if the time has changed since the last Interpolate
+	bool IsDirty() const { return m_dirty; }
 	const std::vector<AnimationChannel>& GetChannels() const { return m_channels; }
 
 private:
@@ -33,6 +35,7 @@ private:
 	friend class BinaryConverter;
 	double m_duration;
 	double m_time;
+	bool m_dirty;
 	std::string m_name;
 	std::vector<AnimationChannel> m_channels;
 };
@@ -19,7 +19,9 @@ using namespace SceneGraph;
 // 4: compressed SGM files and instancing support
 // 5: normal mapping
 // 6: 32-bit indicies
-const Uint32 SGM_VERSION = 6;
+// 7: collision mesh BVH trees
+// 8: 32 byte BVH nodes
+const Uint32 SGM_VERSION = 8;
 union SGM_STRING_VALUE{
 	char name[4];
 	Uint32 value;
@@ -53,9 +55,10 @@ public:
 	NodeDatabase db;
 };
 
-BinaryConverter::BinaryConverter(Graphics::Renderer *r)
+BinaryConverter::BinaryConverter(Graphics::Renderer *r, const ModelIndex *index)
 	: BaseLoader(r)
 	, m_patternsUsed(false)
+	, m_index(index)
 {
 	//register core loaders
 	RegisterLoader("Group", &Group::Load);
@@ -145,6 +148,20 @@ void BinaryConverter::Save(const std::string& filename, const std::string& savep
 	if (nwritten != 1) throw CouldNotWriteToFileException();
 }
 
+Uint32 BinaryConverter::GetVersion()
+{
+	return SGM_VERSION;
+}
+
+bool BinaryConverter::IsSaved(const std::string& savepath, const bool bInPlace)
+{
+	if (bInPlace) {
+		FileSystem::FileSourceFS dataFS(FileSystem::GetDataDir());
+		return dataFS.Lookup(savepath + SGM_EXTENSION).IsFile();
+	}
+	return FileSystem::userFiles.Lookup(FileSystem::JoinPathBelow(SAVE_TARGET_DIR, savepath + SGM_EXTENSION)).IsFile();
+}
+
 Model *BinaryConverter::Load(const std::string &filename)
 {
 	PROFILE_SCOPED()
@@ -363,38 +380,34 @@ ModelDefinition BinaryConverter::FindModelDefinition(const std::string &shortnam
 	PROFILE_SCOPED()
 	const std::string basepath = "models";
 
-	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-	for (FileSystem::FileEnumerator files(fileSource, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
-		const FileSystem::FileInfo &info = files.Current();
-		const std::string &fpath = info.GetPath();
+	std::unique_ptr<ModelIndex> ownIndex;
+	const ModelIndex *index = m_index;
+	if (!index || index->GetBasePath() != basepath) {
+		ownIndex.reset(new ModelIndex(basepath));
+		index = ownIndex.get();
+	}
 
-		//check it's the expected type
-		if (info.IsFile() && ends_with_ci(fpath, ".model")) {
-			//check it's the wanted name & load it
-			const std::string name = info.GetName();
+	const std::string *modelPath = index->FindModel(shortname);
+	if (!modelPath)
+		throw (LoadingError("File not found"));
 
-			if (shortname == name.substr(0, name.length()-6)) {
-				ModelDefinition modelDefinition;
-				try {
-					//curPath is used to find textures, patterns,
-					//possibly other data files for this model.
-					//Strip trailing slash
-					m_curPath = info.GetDir();
-					assert(!m_curPath.empty());
-					if (m_curPath[m_curPath.length()-1] == '/')
-						m_curPath = m_curPath.substr(0, m_curPath.length()-1);
-
-					Parser p(fileSource, fpath, m_curPath);
-					p.Parse(&modelDefinition);
-					return modelDefinition;
-				} catch (ParseError &err) {
-					Output("%s\n", err.what());
-					throw LoadingError(err.what());
-				}
-			}
-		}
+	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
+	const std::string &fpath = *modelPath;
+	ModelDefinition modelDefinition;
+	try {
+		//curPath is used to find textures, patterns,
+		//possibly other data files for this model.
+		//Strip trailing slash
+		m_curPath = fpath.substr(0, fpath.find_last_of('/'));
+		assert(!m_curPath.empty());
+
+		Parser p(fileSource, fpath, m_curPath);
+		p.Parse(&modelDefinition);
+		return modelDefinition;
+	} catch (ParseError &err) {
+		Output("%s\n", err.what());
+		throw LoadingError(err.what());
 	}
-	throw (LoadingError("File not found"));
 }
 
 Node* BinaryConverter::LoadNode(Serializer::Reader &rd)
@@ -21,15 +21,24 @@
 
 namespace SceneGraph
 {
+class ModelIndex;
+
 class BinaryConverter : public BaseLoader
 {
 public:
-	BinaryConverter(Graphics::Renderer*);
+	// index, if given, must outlive the converter and is used to find the
+	// .model when saving
+	BinaryConverter(Graphics::Renderer*, const ModelIndex *index = nullptr);
 	void Save(const std::string& filename, Model* m);
 	void Save(const std::string& filename, const std::string& savepath, Model* m, const bool bInPlace);
 	Model *Load(const std::string &filename);
 	Model *Load(const std::string &filename, const std::string &path);
 
+	// version of the .sgm format written by Save
+	static Uint32 GetVersion();
+	// whether Save(filename, savepath, m, bInPlace) has left a file there
+	static bool IsSaved(const std::string& savepath, const bool bInPlace);
+
 	//if you implement any new node types, you must also register a loader function
 	//before calling Load.
 	void RegisterLoader(const std::string &typeName, std::function<Node*(NodeDatabase&)>);
@@ -48,6 +57,7 @@ private:
 	static Label3D *LoadLabel3D(NodeDatabase&);
 
 	bool m_patternsUsed;
+	const ModelIndex *m_index;
 	std::map<std::string, std::function<Node*(NodeDatabase&)> > m_loaders;
 };
 }
@@ -0,0 +1,290 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "DrawList.h"
+#include "NodeVisitor.h"
+#include "CollisionGeometry.h"
+#include "Group.h"
+#include "LOD.h"
+#include "MatrixTransform.h"
+#include "StaticGeometry.h"
+
+namespace SceneGraph {
+
+class DrawListCompiler : public NodeVisitor {
+public:
+	DrawListCompiler(DrawList &list, unsigned int pass)
+	: m_list(list)
+	, m_pass(pass)
+	, m_slot(0)
+	, m_offset(matrix4x4f::Identity())
+	, m_hasOffset(false)
+	{
+	}
+
+	virtual void ApplyNode(Node &n) override
+	{
+		if (n.GetPassMask() & m_pass)
+			End(Add(DrawList::OP_NODE, n));
+	}
+
+	virtual void ApplyStaticGeometry(StaticGeometry &g) override
+	{
+		if (g.GetPassMask() & m_pass)
+			End(Add(DrawList::OP_GEOMETRY, g));
+	}
+
+	virtual void ApplyCollisionGeometry(CollisionGeometry &) override
+	{
+		//not drawn
+	}
+
+	virtual void ApplyGroup(Group &g) override
+	{
+		if (!(g.GetPassMask() & m_pass))
+			return;
+		const Uint32 op = Add(DrawList::OP_GROUP, g);
+		g.Traverse(*this);
+		End(op);
+	}
+
+	virtual void ApplyMatrixTransform(MatrixTransform &m) override
+	{
+		if (!(m.GetPassMask() & m_pass))
+			return;
+
+		const Uint32 slot = m_slot;
+		const matrix4x4f offset = m_offset;
+		const bool hasOffset = m_hasOffset;
+
+		Uint32 op;
+		if (m.IsAnimated()) {
+			DrawList::Slot s;
+			s.parent = m_slot;
+			s.offset = AddOffset();
+			m_list.m_slots.push_back(s);
+			m_slot = m_list.m_slots.size() - 1;
+			m_offset = matrix4x4f::Identity();
+			m_hasOffset = false;
+			op = Add(DrawList::OP_TRANSFORM, m);
+		} else {
+			op = Add(DrawList::OP_GROUP, m);
+			m_offset = m_offset * m.GetTransform();
+			m_hasOffset = true;
+		}
+
+		m.Traverse(*this);
+		End(op);
+
+		m_slot = slot;
+		m_offset = offset;
+		m_hasOffset = hasOffset;
+	}
+
+	virtual void ApplyLOD(LOD &l) override
+	{
+		if (!(l.GetPassMask() & m_pass) || !l.HasLevels())
+			return;
+
+		const Uint32 op = Add(DrawList::OP_LOD, l);
+		const Uint32 levels = m_list.m_levels.size();
+		m_list.m_ops[op].levels = levels;
+		m_list.m_levels.resize(levels + l.GetNumChildren() + 1);
+		for (unsigned int i = 0; i < l.GetNumChildren(); i++) {
+			m_list.m_levels[levels + i] = m_list.m_ops.size();
+			l.GetChildAt(i)->Accept(*this);
+		}
+		m_list.m_levels[levels + l.GetNumChildren()] = m_list.m_ops.size();
+		End(op);
+	}
+
+private:
+	Uint32 Add(DrawList::OpType type, Node &n)
+	{
+		DrawList::Op op;
+		op.type = type;
+		op.node = &n;
+		op.end = 0;
+		op.slot = m_slot;
+		op.levels = 0;
+		//an animated transform's own place is kept in its slot
+		op.offset = (type == DrawList::OP_TRANSFORM) ? -1 : AddOffset();
+		m_list.m_ops.push_back(op);
+		return m_list.m_ops.size() - 1;
+	}
+
+	void End(Uint32 op)
+	{
+		m_list.m_ops[op].end = m_list.m_ops.size();
+	}
+
+	Sint32 AddOffset()
+	{
+		if (!m_hasOffset)
+			return -1;
+		//nodes under the same static transform share it
+		if (!m_list.m_offsets.empty() && memcmp(&m_list.m_offsets.back(), &m_offset, sizeof(matrix4x4f)) == 0)
+			return m_list.m_offsets.size() - 1;
+		m_list.m_offsets.push_back(m_offset);
+		return m_list.m_offsets.size() - 1;
+	}
+
+	DrawList &m_list;
+	const unsigned int m_pass;
+	Uint32 m_slot;
+	matrix4x4f m_offset;
+	bool m_hasOffset;
+};
+
+void DrawList::Compile(Group *root, unsigned int pass)
+{
+	PROFILE_SCOPED()
+	Clear();
+
+	//slot 0 is the model itself
+	Slot model;
+	model.parent = 0;
+	model.offset = -1;
+	m_slots.push_back(model);
+
+	//the root is drawn whatever its mask, as Model does
+	DrawListCompiler compiler(*this, pass);
+	root->Traverse(compiler);
+
+	m_local.resize(m_slots.size(), matrix4x4f::Identity());
+}
+
+void DrawList::Clear()
+{
+	m_ops.clear();
+	m_slots.clear();
+	m_offsets.clear();
+	m_levels.clear();
+	m_local.clear();
+}
+
+matrix4x4f DrawList::GetLocal(Uint32 slot, Sint32 offset) const
+{
+	if (slot == 0)
+		return offset < 0 ? matrix4x4f::Identity() : m_offsets[offset];
+	return offset < 0 ? m_local[slot] : m_local[slot] * m_offsets[offset];
+}
+
+void DrawList::UpdateSlot(const Op &op)
+{
+	const Slot &s = m_slots[op.slot];
+	const matrix4x4f &m = static_cast<MatrixTransform*>(op.node)->GetTransform();
+	if (IsIdentity(s.parent, s.offset))
+		m_local[op.slot] = m;
+	else
+		m_local[op.slot] = GetLocal(s.parent, s.offset) * m;
+}
+
+void DrawList::Render(const matrix4x4f &trans, const RenderData *rd)
+{
+	PROFILE_SCOPED()
+	Run(0, m_ops.size(), trans, rd);
+}
+
+void DrawList::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
+{
+	PROFILE_SCOPED()
+	Run(0, m_ops.size(), trans, rd);
+}
+
+void DrawList::Run(Uint32 begin, Uint32 end, const matrix4x4f &trans, const RenderData *rd)
+{
+	Uint32 i = begin;
+	while (i < end) {
+		const Op &op = m_ops[i];
+		if (!(op.node->GetNodeMask() & rd->nodemask)) {
+			i = op.end;
+			continue;
+		}
+
+		switch (op.type) {
+		case OP_GROUP:
+			++i;
+			break;
+		case OP_TRANSFORM:
+			UpdateSlot(op);
+			++i;
+			break;
+		case OP_LOD: {
+			const LOD *lod = static_cast<const LOD*>(op.node);
+			const Uint32 level = IsIdentity(op.slot, op.offset) ?
+				lod->SelectLevel(trans, rd->boundingRadius) :
+				lod->SelectLevel(trans * GetLocal(op.slot, op.offset), rd->boundingRadius);
+			Run(m_levels[op.levels + level], m_levels[op.levels + level + 1], trans, rd);
+			i = op.end;
+			break;
+		}
+		case OP_GEOMETRY:
+			if (IsIdentity(op.slot, op.offset))
+				static_cast<StaticGeometry*>(op.node)->Render(trans, rd);
+			else
+				static_cast<StaticGeometry*>(op.node)->Render(trans * GetLocal(op.slot, op.offset), rd);
+			i = op.end;
+			break;
+		case OP_NODE:
+			if (IsIdentity(op.slot, op.offset))
+				op.node->Render(trans, rd);
+			else
+				op.node->Render(trans * GetLocal(op.slot, op.offset), rd);
+			i = op.end;
+			break;
+		}
+	}
+}
+
+void DrawList::Run(Uint32 begin, Uint32 end, const std::vector<matrix4x4f> &trans, const RenderData *rd)
+{
+	Uint32 i = begin;
+	while (i < end) {
+		const Op &op = m_ops[i];
+		if (!(op.node->GetNodeMask() & rd->nodemask)) {
+			i = op.end;
+			continue;
+		}
+
+		if (op.type == OP_GROUP) {
+			++i;
+			continue;
+		}
+		if (op.type == OP_TRANSFORM) {
+			UpdateSlot(op);
+			++i;
+			continue;
+		}
+
+		//the instances' transforms for the op
+		const std::vector<matrix4x4f> *instances = &trans;
+		if (!IsIdentity(op.slot, op.offset)) {
+			const matrix4x4f local = GetLocal(op.slot, op.offset);
+			m_instances.resize(trans.size());
+			for (size_t t = 0; t < trans.size(); t++)
+				m_instances[t] = trans[t] * local;
+			instances = &m_instances;
+		}
+
+		if (op.type == OP_LOD) {
+			//sort the instances by level, then draw each level once
+			const LOD *lod = static_cast<const LOD*>(op.node);
+			const Uint32 numLevels = lod->GetNumChildren();
+			std::vector<std::vector<matrix4x4f> > levels(numLevels);
+			for (size_t t = 0; t < trans.size(); t++)
+				levels[lod->SelectLevel((*instances)[t], rd->boundingRadius)].push_back(trans[t]);
+			for (Uint32 level = 0; level < numLevels; level++) {
+				if (!levels[level].empty())
+					Run(m_levels[op.levels + level], m_levels[op.levels + level + 1], levels[level], rd);
+			}
+		} else if (op.type == OP_GEOMETRY) {
+			static_cast<StaticGeometry*>(op.node)->Render(*instances, rd);
+		} else {
+			op.node->Render(*instances, rd);
+		}
+		i = op.end;
+	}
+}
+
+}
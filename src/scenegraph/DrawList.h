@@ -0,0 +1,87 @@
+// Copyright © 2008-2017 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _SCENEGRAPH_DRAWLIST_H
+#define _SCENEGRAPH_DRAWLIST_H
+/*
+ * A model's node graph flattened, for one render pass, into a list that can
+ * be drawn with a loop instead of a walk through virtual Render calls.
+ *
+ * Static MatrixTransforms are baked into the transforms of the nodes below
+ * them, so only animated ones are multiplied out each frame. Groups leave an
+ * entry behind so that node masks can still switch parts of the model off,
+ * and each LOD keeps a range of the list per level.
+ *
+ * A list points into the graph it was compiled from, so it has to be
+ * compiled again whenever the graph changes (see Node::GetGraphVersion,
+ * which is kept on the root of the graph).
+ */
+#include "libs.h"
+#include "Node.h"
+
+namespace SceneGraph {
+
+class Group;
+
+class DrawList
+{
+public:
+	DrawList() { }
+
+	//pass is NODE_SOLID or NODE_TRANSPARENT
+	void Compile(Group *root, unsigned int pass);
+	void Clear();
+	bool IsEmpty() const { return m_ops.empty(); }
+
+	//same as root->Render(trans, rd) for the pass the list was compiled for
+	void Render(const matrix4x4f &trans, const RenderData *rd);
+	void Render(const std::vector<matrix4x4f> &trans, const RenderData *rd);
+
+private:
+	friend class DrawListCompiler;
+	DrawList(const DrawList&);
+
+	enum OpType {
+		OP_GROUP,		//a group, or a static transform
+		OP_TRANSFORM,	//an animated transform
+		OP_LOD,
+		OP_GEOMETRY,
+		OP_NODE			//any other node, drawn through its own Render
+	};
+
+	struct Op {
+		OpType type;
+		Node *node;
+		Uint32 end;		//the op after this one's children
+		Uint32 slot;	//the animated transform the op is under, 0 for none
+		Sint32 offset;	//baked static transform since the slot, or -1 for none
+		Uint32 levels;	//for LODs, where their ranges start in m_levels
+	};
+
+	//an animated transform, relative to the one above it
+	struct Slot {
+		Uint32 parent;
+		Sint32 offset;
+	};
+
+	void Run(Uint32 begin, Uint32 end, const matrix4x4f &trans, const RenderData *rd);
+	void Run(Uint32 begin, Uint32 end, const std::vector<matrix4x4f> &trans, const RenderData *rd);
+	//where an op is, in model space
+	bool IsIdentity(Uint32 slot, Sint32 offset) const { return slot == 0 && offset < 0; }
+	matrix4x4f GetLocal(Uint32 slot, Sint32 offset) const;
+	void UpdateSlot(const Op &op);
+
+	std::vector<Op> m_ops;
+	std::vector<Slot> m_slots;
+	std::vector<matrix4x4f> m_offsets;
+	std::vector<Uint32> m_levels;	//each LOD's level starts, then its end
+
+	//model space transforms of the slots, as of the last Render
+	std::vector<matrix4x4f> m_local;
+	//instance transforms for the op being drawn
+	std::vector<matrix4x4f> m_instances;
+};
+
+}
+
+#endif
@@ -17,6 +17,8 @@ Group::~Group()
 {
 	for(std::vector<Node*>::iterator itr = m_children.begin(), itEnd = m_children.end(); itr != itEnd; ++itr)
 	{
+		if ((*itr)->m_parent == this)
+			(*itr)->m_parent = nullptr;
 		(*itr)->DecRefCount();
 	}
 }
@@ -53,7 +55,9 @@ Group *Group::Load(NodeDatabase &db)
 void Group::AddChild(Node *child)
 {
 	child->IncRefCount();
+	child->m_parent = this;
 	m_children.push_back(child);
+	GraphChanged();
 }
 
 bool Group::RemoveChild(Node *node)
@@ -65,7 +69,10 @@ bool Group::RemoveChild(Node *node)
 	{
 		if((*itr) == node) {
 			itr = m_children.erase(itr);
+			if (node->m_parent == this)
+				node->m_parent = nullptr;
 			node->DecRefCount();
+			GraphChanged();
 			return true;
 		}
 	}
@@ -76,8 +83,11 @@ bool Group::RemoveChildAt(unsigned int idx)
 {
 	if (m_children.empty() || idx > m_children.size() - 1) return false;
 	Node *node = m_children.at(idx);
+	if (node->m_parent == this)
+		node->m_parent = nullptr;
 	node->DecRefCount();
 	m_children.erase(m_children.begin() + idx);
+	GraphChanged();
 	return true;
 }
 
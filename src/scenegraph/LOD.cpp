@@ -40,20 +40,25 @@ void LOD::AddLevel(float pixelSize, Node *nod)
 	AddChild(nod);
 }
 
-void LOD::Render(const matrix4x4f &trans, const RenderData *rd)
+unsigned int LOD::SelectLevel(const matrix4x4f &trans, float boundingRadius) const
 {
-	PROFILE_SCOPED()
 	//figure out approximate pixel size of object's bounding radius
 	//on screen and pick a child to render
 	const vector3f cameraPos(-trans[12], -trans[13], -trans[14]);
 	//fov is vertical, so using screen height
-	const float pixrad = Graphics::GetScreenHeight() * rd->boundingRadius / (cameraPos.Length() * Graphics::GetFovFactor());
-	if (m_pixelSizes.empty()) return;
+	const float pixrad = Graphics::GetScreenHeight() * boundingRadius / (cameraPos.Length() * Graphics::GetFovFactor());
 	unsigned int lod = m_children.size() - 1;
 	for (unsigned int i=m_pixelSizes.size(); i > 0; i--) {
 		if (pixrad < m_pixelSizes[i-1]) lod = i-1;
 	}
-	m_children[lod]->Render(trans, rd);
+	return lod;
+}
+
+void LOD::Render(const matrix4x4f &trans, const RenderData *rd)
+{
+	PROFILE_SCOPED()
+	if (m_pixelSizes.empty()) return;
+	m_children[SelectLevel(trans, rd->boundingRadius)]->Render(trans, rd);
 }
 
 void LOD::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
@@ -78,21 +83,7 @@ void LOD::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
 
 		// seperate out the transformations
 		for (auto mt : trans)
-		{
-			//figure out approximate pixel size of object's bounding radius
-			//on screen and pick a child to render
-			const vector3f cameraPos(-mt[12], -mt[13], -mt[14]);
-			//fov is vertical, so using screen height
-			const float pixrad = Graphics::GetScreenHeight() * rd->boundingRadius / (cameraPos.Length() * Graphics::GetFovFactor());
-			unsigned int lod = m_children.size() - 1;
-			for (unsigned int i = m_pixelSizes.size(); i > 0; i--) {
-				if (pixrad < m_pixelSizes[i - 1]) {
-					lod = i - 1;
-				}
-			}
-
-			transform[lod].push_back(mt);
-		}
+			transform[SelectLevel(mt, rd->boundingRadius)].push_back(mt);
 
 		// now render each of the buffers for each of the lods
 		for (Uint32 inst = 0; inst < transform.size(); inst++) {
@@ -20,6 +20,9 @@ public:
 	virtual void Render(const matrix4x4f &trans, const RenderData *rd) override;
 	virtual void Render(const std::vector<matrix4x4f> &trans, const RenderData *rd) override;
 	void AddLevel(float pixelRadius, Node *child);
+	bool HasLevels() const { return !m_pixelSizes.empty(); }
+	//the child to draw for a model of the given radius seen through trans
+	unsigned int SelectLevel(const matrix4x4f &trans, float boundingRadius) const;
 	virtual void Save(NodeDatabase&) override;
 	static LOD* Load(NodeDatabase&);
 
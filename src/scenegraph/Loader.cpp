@@ -114,11 +114,39 @@ namespace {
 } // anonymous namespace
 
 namespace SceneGraph {
-Loader::Loader(Graphics::Renderer *r, bool logWarnings, bool loadSGMfiles)
+ModelIndex::ModelIndex(const std::string &basepath)
+: m_basePath(basepath)
+{
+	PROFILE_SCOPED()
+	for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
+	{
+		const FileSystem::FileInfo &info = files.Current();
+		const std::string &fpath = info.GetPath();
+
+		//check it's the expected type
+		if (info.IsFile()) {
+			const std::string &name = info.GetName();
+			if (ends_with_ci(fpath, ".model")) {	// the first .model with a name wins
+				m_models.insert(std::make_pair(name.substr(0, name.size()-6), fpath));
+			} else if (ends_with_ci(fpath, ".sgm")) {	// only the shortname for ".sgm" files.
+				m_sgms.insert(name.substr(0, name.size()-4));
+			}
+		}
+	}
+}
+
+const std::string *ModelIndex::FindModel(const std::string &name) const
+{
+	auto it = m_models.find(name);
+	return it != m_models.end() ? &it->second : nullptr;
+}
+
+Loader::Loader(Graphics::Renderer *r, bool logWarnings, bool loadSGMfiles, const ModelIndex *index)
 : BaseLoader(r)
 , m_doLog(logWarnings)
 , m_loadSGMs(loadSGMfiles)
 , m_mostDetailedLod(false)
+, m_index(index)
 {
 }
 
@@ -134,68 +162,50 @@ Model *Loader::LoadModel(const std::string &shortname, const std::string &basepa
 	PROFILE_SCOPED()
 	m_logMessages.clear();
 
-	std::vector<std::string> list_model;
-	std::vector<std::string> list_sgm;
-	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-	for (FileSystem::FileEnumerator files(fileSource, basepath, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
-	{
-		const FileSystem::FileInfo &info = files.Current();
-		const std::string &fpath = info.GetPath();
-
-		//check it's the expected type
-		if (info.IsFile()) {
-			if (ends_with_ci(fpath, ".model")) {	// store the path for ".model" files
-				list_model.push_back(fpath);
-			} else if (m_loadSGMs & ends_with_ci(fpath, ".sgm")) {// store only the shortname for ".sgm" files.
-				list_sgm.push_back(info.GetName().substr(0, info.GetName().size()-4));
-			}
-		}
+	std::unique_ptr<ModelIndex> ownIndex;
+	const ModelIndex *index = m_index;
+	if (!index || index->GetBasePath() != basepath) {
+		ownIndex.reset(new ModelIndex(basepath));
+		index = ownIndex.get();
 	}
 
-	if (m_loadSGMs) {
-		for (auto &sgmname : list_sgm) {
-			if (sgmname == shortname) {
-				//binary loader expects extension-less name. Might want to change this.
-				SceneGraph::BinaryConverter bc(m_renderer);
-				m_model = bc.Load(shortname);
-				if (m_model)
-					return m_model;
-				else
-					break; // we'll have to load the non-sgm file
-			}
-		}
+	if (m_loadSGMs && index->HasSGM(shortname)) {
+		//binary loader expects extension-less name. Might want to change this.
+		SceneGraph::BinaryConverter bc(m_renderer);
+		m_model = bc.Load(shortname);
+		if (m_model)
+			return m_model;
+		// otherwise we'll have to load the non-sgm file
 	}
 
-	for (auto &fpath : list_model) {
-		RefCountedPtr<FileSystem::FileData> filedata = FileSystem::gameDataFiles.ReadFile(fpath);
+	if (const std::string *modelPath = index->FindModel(shortname)) {
+		const std::string &fpath = *modelPath;
+		FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
+		RefCountedPtr<FileSystem::FileData> filedata = fileSource.ReadFile(fpath);
 		if (!filedata) {
 			Output("LoadModel: %s: could not read file\n", fpath.c_str());
 			return nullptr;
 		}
 
-		//check it's the wanted name & load it
 		const FileSystem::FileInfo& info = filedata->GetInfo();
-		const std::string name = info.GetName();
-		if (name.substr(0, name.length()-6) == shortname) {
-			ModelDefinition modelDefinition;
-			try {
-				//curPath is used to find textures, patterns,
-				//possibly other data files for this model.
-				//Strip trailing slash
-				m_curPath = info.GetDir();
-				assert(!m_curPath.empty());
-				if (m_curPath[m_curPath.length()-1] == '/')
-					m_curPath = m_curPath.substr(0, m_curPath.length()-1);
-
-				Parser p(fileSource, fpath, m_curPath);
-				p.Parse(&modelDefinition);
-			} catch (ParseError &err) {
-				Output("%s\n", err.what());
-				throw LoadingError(err.what());
-			}
-			modelDefinition.name = shortname;
-			return CreateModel(modelDefinition);
-		}
+		ModelDefinition modelDefinition;
+		try {
+			//curPath is used to find textures, patterns,
+			//possibly other data files for this model.
+			//Strip trailing slash
+			m_curPath = info.GetDir();
+			assert(!m_curPath.empty());
+			if (m_curPath[m_curPath.length()-1] == '/')
+				m_curPath = m_curPath.substr(0, m_curPath.length()-1);
+
+			Parser p(fileSource, fpath, m_curPath);
+			p.Parse(&modelDefinition);
+		} catch (ParseError &err) {
+			Output("%s\n", err.what());
+			throw LoadingError(err.what());
+		}
+		modelDefinition.name = shortname;
+		return CreateModel(modelDefinition);
 	}
 	throw (LoadingError("File not found"));
 }
@@ -10,6 +10,8 @@
 #include "CollisionGeometry.h"
 #include "graphics/Material.h"
 #include <assimp/types.h>
+#include <map>
+#include <set>
 
 struct aiNode;
 struct aiMesh;
@@ -18,9 +20,34 @@ struct aiNodeAnim;
 
 namespace SceneGraph {
 
+// Every .model and .sgm below a directory, found with a single enumeration so
+// that loading many models doesn't walk the data tree once per model. It's
+// never changed after it's built, so any number of loaders (or threads) can
+// share one.
+class ModelIndex {
+public:
+	explicit ModelIndex(const std::string &basepath = "models");
+
+	const std::string &GetBasePath() const { return m_basePath; }
+
+	// path of the .model for a name (without path or .model suffix), or null
+	const std::string *FindModel(const std::string &name) const;
+	bool HasSGM(const std::string &name) const { return m_sgms.count(name) != 0; }
+
+	// name -> .model path, for every model
+	const std::map<std::string, std::string> &GetModels() const { return m_models; }
+
+private:
+	std::string m_basePath;
+	std::map<std::string, std::string> m_models;
+	std::set<std::string> m_sgms;
+};
+
 class Loader : public BaseLoader {
 public:
-	Loader(Graphics::Renderer *r, bool logWarnings = false, bool loadSGMfiles = true);
+	// index, if given, must outlive the loader; without one each LoadModel
+	// makes its own
+	Loader(Graphics::Renderer *r, bool logWarnings = false, bool loadSGMfiles = true, const ModelIndex *index = nullptr);
 
 	//find & attempt to load a model, based on filename (without path or .model suffix)
 	Model *LoadModel(const std::string &name);
@@ -32,6 +59,7 @@ protected:
 	bool m_doLog;
 	bool m_loadSGMs;
 	bool m_mostDetailedLod;
+	const ModelIndex *m_index;
 	std::vector<std::string> m_logMessages;
 	std::string m_curMeshDef; //for logging
 
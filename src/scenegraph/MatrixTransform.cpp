@@ -11,12 +11,14 @@ namespace SceneGraph {
 MatrixTransform::MatrixTransform(Graphics::Renderer *r, const matrix4x4f &m)
 : Group(r)
 , m_transform(m)
+, m_animated(false)
 {
 }
 
 MatrixTransform::MatrixTransform(const MatrixTransform &mt, NodeCopyCache *cache)
 : Group(mt, cache)
 , m_transform(mt.m_transform)
+, m_animated(mt.m_animated)
 {
 }
 
@@ -30,6 +32,16 @@ void MatrixTransform::Accept(NodeVisitor &nv)
 	nv.ApplyMatrixTransform(*this);
 }
 
+void MatrixTransform::SetTransform(const matrix4x4f &m)
+{
+	//restoring a saved game sets every transform, most to what they were
+	if (!m_animated && memcmp(&m, &m_transform, sizeof(matrix4x4f)) != 0) {
+		m_animated = true;
+		GraphChanged();
+	}
+	m_transform = m;
+}
+
 void MatrixTransform::Render(const matrix4x4f &trans, const RenderData *rd)
 {
 	PROFILE_SCOPED();
@@ -27,13 +27,18 @@ public:
 	virtual void Render(const std::vector<matrix4x4f> &trans, const RenderData *rd) override;
 
 	const matrix4x4f &GetTransform() const { return m_transform; }
-	void SetTransform(const matrix4x4f &m) { m_transform = m; }
+	void SetTransform(const matrix4x4f &m);
+
+	//true once the transform has been changed since loading (usually by an
+	//animation). Static transforms can be baked into a DrawList
+	bool IsAnimated() const { return m_animated; }
 
 protected:
 	virtual ~MatrixTransform() { }
 
 private:
 	matrix4x4f m_transform;
+	bool m_animated;
 };
 }
 #endif
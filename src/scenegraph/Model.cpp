@@ -29,6 +29,7 @@ Model::Model(Graphics::Renderer *r, const std::string &name)
 , m_name(name)
 , m_curPatternIndex(0)
 , m_curPattern(0)
+, m_drawListVersion(0)
 , m_debugFlags(0)
 {
 	m_root.Reset(new Group(m_renderer));
@@ -45,6 +46,7 @@ Model::Model(const Model &model)
 , m_name(model.m_name)
 , m_curPatternIndex(model.m_curPatternIndex)
 , m_curPattern(model.m_curPattern)
+, m_drawListVersion(0)
 , m_debugFlags(0)
 {
 	//selective copying of node structure
@@ -124,13 +126,26 @@ void Model::Render(const matrix4x4f &trans, const RenderData *rd)
 	if (m_debugFlags & DEBUG_WIREFRAME)
 		m_renderer->SetWireFrameMode(true);
 
+	UpdateDrawLists();
+
 	if (params.nodemask & MASK_IGNORE) {
-		m_root->Render(trans, &params);
+		//submodels set up their own pattern and decal textures, which may
+		//be shared with other instances, so they can't wait for the sort
+		params.drawSorter = nullptr;
+		RenderNodes(trans, &params);
 	} else {
+		//the order opaque geometry is drawn in doesn't matter, so collect
+		//it and draw it grouped by shader and textures
 		params.nodemask = NODE_SOLID;
-		m_root->Render(trans, &params);
+		params.drawSorter = &m_drawSorter;
+		m_solidDrawList.Render(trans, &params);
+		if (!m_drawSorter.IsEmpty()) {
+			m_drawSorter.Flush(m_renderer);
+			m_renderer->SetTransform(trans);
+		}
 		params.nodemask = NODE_TRANSPARENT;
-		m_root->Render(trans, &params);
+		params.drawSorter = nullptr;
+		m_transparentDrawList.Render(trans, &params);
 	}
 
 	if (!m_debugFlags)
@@ -190,16 +205,53 @@ void Model::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
 	if (m_debugFlags & DEBUG_WIREFRAME)
 		m_renderer->SetWireFrameMode(true);
 
+	UpdateDrawLists();
+
 	if (params.nodemask & MASK_IGNORE) {
-		m_root->Render(trans, &params);
+		RenderNodes(trans, &params);
 	} else {
 		params.nodemask = NODE_SOLID;
-		m_root->Render(trans, &params);
+		m_solidDrawList.Render(trans, &params);
 		params.nodemask = NODE_TRANSPARENT;
-		m_root->Render(trans, &params);
+		m_transparentDrawList.Render(trans, &params);
 	}
 }
 
+void Model::UpdateDrawLists()
+{
+	if (m_drawListVersion == m_root->GetGraphVersion())
+		return;
+	m_solidDrawList.Compile(m_root.Get(), NODE_SOLID);
+	m_transparentDrawList.Compile(m_root.Get(), NODE_TRANSPARENT);
+	m_drawListVersion = m_root->GetGraphVersion();
+}
+
+DrawList *Model::GetDrawList(unsigned int nodemask)
+{
+	switch (nodemask & (NODE_SOLID | NODE_TRANSPARENT)) {
+		case NODE_SOLID: return &m_solidDrawList;
+		case NODE_TRANSPARENT: return &m_transparentDrawList;
+		default: return nullptr;
+	}
+}
+
+//a submodel is drawn with the pass of the model it's attached to
+void Model::RenderNodes(const matrix4x4f &trans, const RenderData *rd)
+{
+	if (DrawList *list = GetDrawList(rd->nodemask))
+		list->Render(trans, rd);
+	else
+		m_root->Render(trans, rd);
+}
+
+void Model::RenderNodes(const std::vector<matrix4x4f> &trans, const RenderData *rd)
+{
+	if (DrawList *list = GetDrawList(rd->nodemask))
+		list->Render(trans, rd);
+	else
+		m_root->Render(trans, rd);
+}
+
 void Model::CreateAabbVB()
 {
 	PROFILE_SCOPED()
@@ -456,11 +508,17 @@ Animation *Model::FindAnimation(const std::string &name) const
 	return 0;
 }
 
-void Model::UpdateAnimations()
+bool Model::UpdateAnimations()
 {
 	// XXX WIP. Assuming animations are controlled manually by SetProgress.
-	for (AnimationContainer::iterator anim = m_animations.begin(); anim != m_animations.end(); ++anim)
-		(*anim)->Interpolate();
+	bool changed = false;
+	for (AnimationContainer::iterator anim = m_animations.begin(); anim != m_animations.end(); ++anim) {
+		if ((*anim)->IsDirty()) {
+			(*anim)->Interpolate();
+			changed = true;
+		}
+	}
+	return changed;
 }
 
 void Model::SetThrust(const vector3f &lin, const vector3f &ang)
@@ -55,19 +55,23 @@
  *  - 3D labels (well, 2D) on models
  *  - spaceship thrusters
  *
+ * Rendering doesn't walk the graph itself but a DrawList per pass compiled
+ * from it, which has the unanimated transforms baked in.
+ *
  * Things to optimize:
  *  - model cache
- *  - removing unnecessary nodes from the scene graph: pre-translate unanimated meshes etc.
  */
 #include "libs.h"
 #include "Animation.h"
 #include "ColorMap.h"
+#include "DrawList.h"
 #include "Group.h"
 #include "Label3D.h"
 #include "Pattern.h"
 #include "CollMesh.h"
 #include "graphics/Material.h"
 #include "graphics/Drawables.h"
+#include "graphics/DrawSorter.h"
 #include "Serializer.h"
 #include "DeleteEmitter.h"
 #include "json/json.h"
@@ -146,7 +150,9 @@ public:
 
 	Animation *FindAnimation(const std::string&) const; //0 if not found
 	const std::vector<Animation *> GetAnimations() const { return m_animations; }
-	void UpdateAnimations();
+	//interpolates the animations whose progress has changed, and answers
+	//whether any did
+	bool UpdateAnimations();
 
 	Graphics::Renderer *GetRenderer() const { return m_renderer; }
 
@@ -189,6 +195,7 @@ private:
 	std::vector<Animation *> m_animations;
 	TagContainer m_tags; //named attachment points
 	RenderData m_renderData;
+	Graphics::DrawSorter m_drawSorter;
 
 	//per-instance flavour data
 	unsigned int m_curPatternIndex;
@@ -200,6 +207,15 @@ private:
 	void DrawAabb();
 	void DrawCollisionMesh();
 	void DrawAxisIndicators(std::vector<Graphics::Drawables::Line3D> &lines);
+
+	// draw lists
+	void UpdateDrawLists();
+	void RenderNodes(const matrix4x4f &trans, const RenderData *rd);
+	void RenderNodes(const std::vector<matrix4x4f> &trans, const RenderData *rd);
+	DrawList *GetDrawList(unsigned int nodemask);
+	DrawList m_solidDrawList;
+	DrawList m_transparentDrawList;
+	Uint32 m_drawListVersion;
 	void AddAxisIndicators(const std::vector<MatrixTransform*> &mts, std::vector<Graphics::Drawables::Line3D> &lines);
 
 	Uint32 m_debugFlags;
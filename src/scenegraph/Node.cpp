@@ -11,24 +11,33 @@ namespace SceneGraph {
 Node::Node(Graphics::Renderer *r)
 : m_name("")
 , m_nodeMask(NODE_SOLID)
+, m_passMask(NODE_SOLID)
 , m_nodeFlags(0)
 , m_renderer(r)
+, m_parent(nullptr)
+, m_graphVersion(1)
 {
 }
 
 Node::Node(Graphics::Renderer *r, unsigned int nodemask)
 : m_name("")
 , m_nodeMask(nodemask)
+, m_passMask(nodemask)
 , m_nodeFlags(0)
 , m_renderer(r)
+, m_parent(nullptr)
+, m_graphVersion(1)
 {
 }
 
 Node::Node(const Node &node, NodeCopyCache *cache)
 : m_name(node.m_name)
 , m_nodeMask(node.m_nodeMask)
+, m_passMask(node.m_passMask)
 , m_nodeFlags(node.m_nodeFlags)
 , m_renderer(node.m_renderer)
+, m_parent(nullptr)
+, m_graphVersion(1)
 {
 }
 
@@ -36,6 +45,23 @@ Node::~Node()
 {
 }
 
+void Node::SetNodeMask(unsigned int m)
+{
+	if (m & ~m_passMask) {
+		m_passMask |= m;
+		GraphChanged();
+	}
+	m_nodeMask = m;
+}
+
+void Node::GraphChanged()
+{
+	Node *root = this;
+	while (root->m_parent)
+		root = root->m_parent;
+	++root->m_graphVersion;
+}
+
 void Node::Accept(NodeVisitor &v)
 {
 	v.ApplyNode(*this);
@@ -12,7 +12,7 @@
 #include "graphics/Material.h"
 #include "graphics/RenderState.h"
 
-namespace Graphics { class Renderer; }
+namespace Graphics { class Renderer; class DrawSorter; }
 
 namespace SceneGraph
 {
@@ -46,11 +46,16 @@ struct RenderData
 	float boundingRadius;	//updated by model and passed to submodels
 	unsigned int nodemask;
 
+	//when set, opaque geometry is handed to this to be drawn in
+	//state order, instead of being drawn immediately
+	Graphics::DrawSorter *drawSorter;
+
 	RenderData()
 	: linthrust()
 	, angthrust()
 	, boundingRadius(0.f)
 	, nodemask(NODE_SOLID) //draw solids
+	, drawSorter(nullptr)
 	{
 	}
 };
@@ -87,20 +92,41 @@ public:
 	virtual Node* FindNode(const std::string &);
 
 	unsigned int GetNodeMask() const { return m_nodeMask; }
-	void SetNodeMask(unsigned int m) { m_nodeMask = m; }
+	void SetNodeMask(unsigned int m);
+	//every mask bit the node has ever had, so switching a node off and on
+	//again doesn't count as a change to the graph
+	unsigned int GetPassMask() const { return m_passMask; }
 
 	unsigned int GetNodeFlags() const { return m_nodeFlags; }
 	void SetNodeFlags(unsigned int m) { m_nodeFlags = m; }
 
 	Graphics::Renderer *GetRenderer() const { return m_renderer; }
 
+	//the group this node was last added to. geometry, thrusters and
+	//submodels are shared between copies of a model, and only know about
+	//the copy made last; none of them change shape after loading
+	Node *GetParent() const { return m_parent; }
+
+	//changes whenever the graph below this node changes shape, so that
+	//anything compiled from a graph (see DrawList) knows to compile it
+	//again. only kept up to date on the root of a graph
+	Uint32 GetGraphVersion() const { return m_graphVersion; }
+
 protected:
+	friend class Group;
 	//can only to be deleted using DecRefCount
 	virtual ~Node();
+	//bumps the version of the root of the graph this node is in
+	void GraphChanged();
 	std::string m_name;
 	unsigned int m_nodeMask;
+	unsigned int m_passMask;
 	unsigned int m_nodeFlags;
 	Graphics::Renderer *m_renderer;
+
+private:
+	Node *m_parent;
+	Uint32 m_graphVersion;
 };
 
 }
@@ -8,6 +8,7 @@
 #include "graphics/Graphics.h"
 #include "graphics/Renderer.h"
 #include "graphics/Material.h"
+#include "graphics/DrawSorter.h"
 
 namespace SceneGraph {
 
@@ -45,6 +46,12 @@ void StaticGeometry::Render(const matrix4x4f &trans, const RenderData *rd)
 {
 	PROFILE_SCOPED()
 	SDL_assert(m_renderState);
+	if (rd && rd->drawSorter && m_blendMode == Graphics::BLEND_SOLID) {
+		for (auto& it : m_meshes)
+			rd->drawSorter->Add(trans, it.vertexBuffer.Get(), it.indexBuffer.Get(), m_renderState, it.material.Get());
+		return;
+	}
+
 	Graphics::Renderer *r = GetRenderer();
 	r->SetTransform(trans);
 	for (auto& it : m_meshes)
@@ -29,8 +29,8 @@ public:
 	virtual Node *Clone(NodeCopyCache *cache = 0) override;
 	virtual const char *GetTypeName() const override { return "StaticGeometry"; }
 	virtual void Accept(NodeVisitor &nv) override;
-	virtual void Render(const matrix4x4f &trans, const RenderData *rd) override;
-	virtual void Render(const std::vector<matrix4x4f> &trans, const RenderData *rd) override;
+	virtual void Render(const matrix4x4f &trans, const RenderData *rd) override final;
+	virtual void Render(const std::vector<matrix4x4f> &trans, const RenderData *rd) override final;
 
 	virtual void Save(NodeDatabase&) override;
 	static StaticGeometry *Load(NodeDatabase&);
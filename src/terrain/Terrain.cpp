@@ -6,6 +6,8 @@
 #include "Pi.h"
 #include "FileSystem.h"
 #include "FloatComparison.h"
+#include <map>
+#include <mutex>
 
 // static instancer. selects the best height and color classes for the body
 Terrain *Terrain::InstanceTerrain(const SystemBody *body)
@@ -360,92 +362,162 @@ static size_t bufread_or_die(void *ptr, size_t size, size_t nmemb, ByteRange &bu
 	return read_count;
 }
 
-// XXX this sucks, but there isn't a reliable cross-platform way to get them
-#ifndef INT16_MIN
-# define INT16_MIN   (-32767-1)
-#endif
-#ifndef INT16_MAX
-# define INT16_MAX   (32767)
-#endif
-#ifndef UINT16_MAX
-# define UINT16_MAX  (65535)
-#endif
+// A heightmap file, loaded once and then shared by every terrain that uses
+// it. The samples are used where they are in the file, which is mapped if
+// it's big enough, rather than copied out and widened.
+class Terrain::HeightMap : public RefCounted {
+public:
+	static RefCountedPtr<HeightMap> Get(const std::string &filename, unsigned int fractal);
+
+	int sizeX, sizeY;
+	double heightScaling, minh;
+	// type 0 heightmaps are signed, type 1 unsigned
+	const Sint16 *signedSamples;
+	const Uint16 *unsignedSamples;
+
+private:
+	HeightMap(const std::string &filename, unsigned int fractal);
+
+	RefCountedPtr<FileSystem::FileData> m_file;
+	// only used if the samples in the file aren't aligned
+	std::unique_ptr<Uint16[]> m_copy;
+
+	typedef std::map<std::pair<std::string, unsigned int>, RefCountedPtr<HeightMap> > Cache;
+	static std::mutex s_cacheLock;
+	static Cache s_cache;
+};
+
+std::mutex Terrain::HeightMap::s_cacheLock;
+Terrain::HeightMap::Cache Terrain::HeightMap::s_cache;
+
+// heightmaps are few and small in this form, so they're kept for good once
+// loaded, so that going back to a system doesn't load them again
+RefCountedPtr<Terrain::HeightMap> Terrain::HeightMap::Get(const std::string &filename, unsigned int fractal)
+{
+	std::lock_guard<std::mutex> lock(s_cacheLock);
+	RefCountedPtr<HeightMap> &map = s_cache[std::make_pair(filename, fractal)];
+	if (!map)
+		map.Reset(new HeightMap(filename, fractal));
+	return map;
+}
 
-Terrain::Terrain(const SystemBody *body) : m_seed(body->GetSeed()), m_rand(body->GetSeed()), m_heightScaling(0), m_minh(0), m_minBody(body) {
+Terrain::HeightMap::HeightMap(const std::string &filename, unsigned int fractal) :
+	sizeX(0), sizeY(0), heightScaling(0), minh(0), signedSamples(0), unsignedSamples(0)
+{
+	m_file = FileSystem::gameDataFiles.ReadFile(filename);
+	if (!m_file) {
+		Output("Error: could not open file '%s'\n", filename.c_str());
+		abort();
+	}
 
-	// load the heightmap
-	if (!body->GetHeightMapFilename().empty()) {
-		RefCountedPtr<FileSystem::FileData> fdata = FileSystem::gameDataFiles.ReadFile(body->GetHeightMapFilename());
-		if (!fdata) {
-			Output("Error: could not open file '%s'\n", body->GetHeightMapFilename().c_str());
-			abort();
+	ByteRange databuf = m_file->AsByteRange();
+
+	Uint16 v;
+	switch (fractal) {
+		case 0: {
+			bufread_or_die(&v, 2, 1, databuf); sizeX = v;
+			bufread_or_die(&v, 2, 1, databuf); sizeY = v;
+			break;
 		}
 
-		ByteRange databuf = fdata->AsByteRange();
-
-		Sint16 minHMap = INT16_MAX, maxHMap = INT16_MIN;
-		Uint16 minHMapScld = UINT16_MAX, maxHMapScld = 0;
-
-		// XXX unify heightmap types
-		switch (body->GetHeightMapFractal()) {
-			case 0: {
-				Uint16 v;
-				bufread_or_die(&v, 2, 1, databuf); m_heightMapSizeX = v;
-				bufread_or_die(&v, 2, 1, databuf); m_heightMapSizeY = v;
-				const Uint32 heightmapPixelArea = (m_heightMapSizeX * m_heightMapSizeY);
-
-				std::unique_ptr<Sint16[]> heightMap(new Sint16[heightmapPixelArea]);
-				bufread_or_die(heightMap.get(), sizeof(Sint16), heightmapPixelArea, databuf);
-				m_heightMap.reset(new double[heightmapPixelArea]);
-				double *pHeightMap = m_heightMap.get();
-				for(Uint32 i=0; i<heightmapPixelArea; i++) {
-					const Sint16 val = heightMap.get()[i];
-					minHMap = std::min(minHMap, val);
-					maxHMap = std::max(maxHMap, val);
-					// store then increment pointer
-					(*pHeightMap) = val;
-					++pHeightMap;
-				}
-				assert(pHeightMap == &m_heightMap[heightmapPixelArea]);
-				//Output("minHMap = (%hd), maxHMap = (%hd)\n", minHMap, maxHMap);
-				break;
-			}
+		case 1: {
+			// XXX x and y reversed from above *sigh*
+			bufread_or_die(&v, 2, 1, databuf); sizeY = v;
+			bufread_or_die(&v, 2, 1, databuf); sizeX = v;
+
+			// read height scaling and min height which are doubles
+			double te;
+			bufread_or_die(&te, 8, 1, databuf);
+			heightScaling = te;
+			bufread_or_die(&te, 8, 1, databuf);
+			minh = te;
+			break;
+		}
 
-			case 1: {
-				Uint16 v;
-				// XXX x and y reversed from above *sigh*
-				bufread_or_die(&v, 2, 1, databuf); m_heightMapSizeY = v;
-				bufread_or_die(&v, 2, 1, databuf); m_heightMapSizeX = v;
-				const Uint32 heightmapPixelArea = (m_heightMapSizeX * m_heightMapSizeY);
-
-				// read height scaling and min height which are doubles
-				double te;
-				bufread_or_die(&te, 8, 1, databuf);
-				m_heightScaling = te;
-				bufread_or_die(&te, 8, 1, databuf);
-				m_minh = te;
-
-				std::unique_ptr<Uint16[]> heightMapScaled(new Uint16[heightmapPixelArea]);
-				bufread_or_die(heightMapScaled.get(), sizeof(Uint16), heightmapPixelArea, databuf);
-				m_heightMap.reset(new double[heightmapPixelArea]);
-				double *pHeightMap = m_heightMap.get();
-				for(Uint32 i=0; i<heightmapPixelArea; i++) {
-					const Uint16 val = heightMapScaled[i];
-					minHMapScld = std::min(minHMapScld, val);
-					maxHMapScld = std::max(maxHMapScld, val);
-					// store then increment pointer
-					(*pHeightMap) = val;
-					++pHeightMap;
-				}
-				assert(pHeightMap == &m_heightMap[heightmapPixelArea]);
-				//Output("minHMapScld = (%hu), maxHMapScld = (%hu)\n", minHMapScld, maxHMapScld);
-				break;
-			}
+		default:
+			assert(0);
+	}
 
-			default:
-				assert(0);
-		}
+	const size_t heightmapPixelArea = size_t(sizeX) * size_t(sizeY);
+	if (databuf.Size() < heightmapPixelArea * sizeof(Uint16)) {
+		Output("Error: failed to read file (truncated)\n");
+		abort();
+	}
+
+	const char *samples = databuf.begin;
+	if (reinterpret_cast<uintptr_t>(samples) % alignof(Uint16) != 0) {
+		m_copy.reset(new Uint16[heightmapPixelArea]);
+		memcpy(m_copy.get(), samples, heightmapPixelArea * sizeof(Uint16));
+		samples = reinterpret_cast<const char*>(m_copy.get());
+	} else {
+		// sampled wherever terrain is being generated, not front to back
+		m_file->Advise(FileSystem::FileData::ACCESS_RANDOM);
+	}
+	if (fractal == 0)
+		signedSamples = reinterpret_cast<const Sint16*>(samples);
+	else
+		unsignedSamples = reinterpret_cast<const Uint16*>(samples);
+}
+
+// the cubic through p0..p3, at t between p1 and p2
+static inline double cubic(double p0, double p1, double p2, double p3, double t)
+{
+	const double d0 = p0 - p1;
+	const double d2 = p2 - p1;
+	const double d3 = p3 - p1;
+	const double a1 = -(1/3.0)*d0 + d2 - (1/6.0)*d3;
+	const double a2 = 0.5*d0 + 0.5*d2;
+	const double a3 = -(1/6.0)*d0 - 0.5*d2 + (1/6.0)*d3;
+	return p1 + a1*t + a2*t*t + a3*t*t*t;
+}
+
+template <typename T>
+static double bicubic(const T *samples, int sizeX, int sizeY, double px, double py)
+{
+	const int ix = Clamp(int(floor(px)), 0, sizeX-1);
+	const int iy = Clamp(int(floor(py)), 0, sizeY-1);
+	const double dx = px-ix;
+	const double dy = py-iy;
+
+	// the 4x4 samples around (px,py), clamped to the edges
+	int cols[4];
+	const T *rows[4];
+	for (int k=0; k<4; k++) {
+		cols[k] = Clamp(ix+k-1, 0, sizeX-1);
+		rows[k] = samples + Clamp(iy+k-1, 0, sizeY-1)*sizeX;
+	}
+
+	// along each row, then across the rows. the rows don't depend on each
+	// other, so the compiler can do them side by side
+	double c[4];
+	for (int j=0; j<4; j++)
+		c[j] = cubic(rows[j][cols[0]], rows[j][cols[1]], rows[j][cols[2]], rows[j][cols[3]], dx);
+	return cubic(c[0], c[1], c[2], c[3], dy);
+}
+
+double Terrain::GetHeightMapValue(const vector3d &p) const
+{
+	double latitude = -asin(p.y);
+	if (p.y < -1.0) latitude = -0.5*M_PI;
+	if (p.y > 1.0) latitude = 0.5*M_PI;
+	const double longitude = atan2(p.x, p.z);
+	const double px = (((m_heightMapSizeX-1) * (longitude + M_PI)) / (2*M_PI));
+	const double py = ((m_heightMapSizeY-1)*(latitude + 0.5*M_PI)) / M_PI;
+
+	if (m_heightMap->signedSamples)
+		return bicubic(m_heightMap->signedSamples, m_heightMapSizeX, m_heightMapSizeY, px, py);
+	return bicubic(m_heightMap->unsignedSamples, m_heightMapSizeX, m_heightMapSizeY, px, py);
+}
 
+Terrain::Terrain(const SystemBody *body) : m_seed(body->GetSeed()), m_rand(body->GetSeed()), m_heightScaling(0), m_minh(0), m_minBody(body) {
+
+	// load the heightmap, or find it already loaded
+	if (!body->GetHeightMapFilename().empty()) {
+		m_heightMap = HeightMap::Get(body->GetHeightMapFilename(), body->GetHeightMapFractal());
+		m_heightMapSizeX = m_heightMap->sizeX;
+		m_heightMapSizeY = m_heightMap->sizeY;
+		m_heightScaling = m_heightMap->heightScaling;
+		m_minh = m_heightMap->minh;
 	}
 
 	switch (Pi::detail.textures) {
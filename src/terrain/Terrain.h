@@ -77,9 +77,14 @@ protected:
 
 	// heightmap stuff
 	// XXX unify heightmap types
-	std::unique_ptr<double[]> m_heightMap;
+	class HeightMap;
+	RefCountedPtr<HeightMap> m_heightMap;
 	double m_heightScaling, m_minh;
 
+	// bicubic interpolation of the heightmap at p's latitude and longitude,
+	// in the heightmap's own units
+	double GetHeightMapValue(const vector3d &p) const;
+
 	int m_heightMapSizeX;
 	int m_heightMapSizeY;
 
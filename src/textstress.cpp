@@ -22,7 +22,7 @@ int main(int argc, char **argv)
 		exit(-1);
 	}
 
-	Graphics::Settings videoSettings;
+	Graphics::Settings videoSettings = {};
 	videoSettings.rendererType = Graphics::RENDERER_OPENGL;
 	videoSettings.width = WIDTH;
 	videoSettings.height = HEIGHT;
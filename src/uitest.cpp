@@ -122,7 +122,7 @@ int main(int argc, char **argv)
 
 	Graphics::RendererOGL::RegisterRenderer();
 
-	Graphics::Settings videoSettings;
+	Graphics::Settings videoSettings = {};
 	videoSettings.rendererType = Graphics::RENDERER_OPENGL;
 	videoSettings.width = WIDTH;
 	videoSettings.height = HEIGHT;
@@ -695,6 +695,16 @@ std::string DecimalToDegMinSec(float dec)
 	return str;
 }
 
+Uint64 hash_fnv1a_64(const void *data, size_t size, Uint64 hash)
+{
+	const unsigned char *p = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 static const int HEXDUMP_CHUNK = 16;
 void hexdump(const unsigned char *buf, int len)
 {
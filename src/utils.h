@@ -257,6 +257,21 @@ static inline Uint32 ceil_pow2(Uint32 v)
 	return v;
 }
 
+// answers the milliseconds since mark (an SDL_GetPerformanceCounter() value),
+// and moves mark on to now. for timing the phases of a frame or a benchmark
+inline double LapMs(Uint64 &mark)
+{
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const double ms = double(now - mark) * 1000.0 / double(SDL_GetPerformanceFrequency());
+	mark = now;
+	return ms;
+}
+
+// 64 bit FNV-1a of size bytes of data. to hash several pieces as one,
+// pass each piece the hash of the ones before it
+static const Uint64 FNV1A_64_INIT = 14695981039346656037ULL;
+Uint64 hash_fnv1a_64(const void *data, size_t size, Uint64 hash = FNV1A_64_INIT);
+
 void hexdump(const unsigned char *buf, int bufsz);
 
 #endif /* _UTILS_H */
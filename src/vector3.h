@@ -24,7 +24,7 @@ public:
 	// Constructor definitions are outside class declaration to enforce that
 	// only float and double versions are possible.
 	vector3();
-	vector3(const vector3<T> &v);
+	vector3(const vector3<T> &v) = default;
 	vector3(const vector2f &v, T t);
 	explicit vector3(const T  vals[3]);
 	explicit vector3(T val);
@@ -143,11 +143,9 @@ public:
 // These are here in this manner to enforce that only float and double versions are possible.
 template<> inline vector3<float >::vector3() {}
 template<> inline vector3<double>::vector3() {}
-template<> inline vector3<float >::vector3(const vector3<float > &v): x(v.x), y(v.y), z(v.z) {}
 template<> inline vector3<float >::vector3(const vector2f &v, float t): x(v.x), y(v.y), z(t) {}
 template<> inline vector3<float >::vector3(const vector3<double> &v): x(float(v.x)), y(float(v.y)), z(float(v.z)) {}
 template<> inline vector3<double>::vector3(const vector3<float > &v): x(v.x), y(v.y), z(v.z) {}
-template<> inline vector3<double>::vector3(const vector3<double> &v): x(v.x), y(v.y), z(v.z) {}
 template<> inline vector3<double>::vector3(const vector2f &v, double t): x(v.x), y(v.y), z(t) {}
 template<> inline vector3<float >::vector3(float  val): x(val), y(val), z(val) {}
 template<> inline vector3<double>::vector3(double val): x(val), y(val), z(val) {}
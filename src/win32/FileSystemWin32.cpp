@@ -141,6 +141,29 @@ namespace FileSystem {
 		return MakeFileInfo(path, ty, modtime);
 	}
 
+	// files at least this big are mapped rather than read in, as on posix
+	static const size_t MAP_FILE_SIZE = 1024 * 1024;
+
+	class FileDataMapped : public FileData {
+	public:
+		FileDataMapped(const FileInfo &info, size_t size, void *view):
+			FileData(info, size, static_cast<char*>(view)) {}
+		virtual ~FileDataMapped() { UnmapViewOfFile(m_data); }
+	};
+
+	// answers 0 if the file can't be mapped, so that it can be read instead
+	static FileData *map_file(HANDLE filehandle, const FileInfo &info, size_t size) {
+		HANDLE mapping = CreateFileMappingW(filehandle, 0, PAGE_READONLY, 0, 0, 0);
+		if (!mapping)
+			return 0;
+		// the view holds its own reference to the mapping
+		void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (!view)
+			return 0;
+		return new FileDataMapped(info, size, view);
+	}
+
 	RefCountedPtr<FileData> FileSourceFS::ReadFile(const std::string &path)
 	{
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
@@ -159,6 +182,14 @@ namespace FileSystem {
 			}
 			size_t size = size_t(large_size.QuadPart);
 
+			if (size >= MAP_FILE_SIZE) {
+				FileData *mapped = map_file(filehandle, MakeFileInfo(path, FileInfo::FT_FILE, modtime), size);
+				if (mapped) {
+					CloseHandle(filehandle);
+					return RefCountedPtr<FileData>(mapped);
+				}
+			}
+
 			char *data = static_cast<char*>(std::malloc(size));
 			if (!data) {
 				// XXX handling memory allocation failure gracefully is too hard right now
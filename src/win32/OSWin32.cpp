@@ -121,6 +121,12 @@ int GetNumCores()
 	return sysinfo.dwNumberOfProcessors;
 }
 
+size_t GetPeakResidentBytes()
+{
+	// GetProcessMemoryInfo would need psapi, which the MinGW build doesn't link
+	return 0;
+}
+
 // get hardware information
 const std::string GetHardwareInfo()
 {